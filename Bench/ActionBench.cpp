@@ -0,0 +1,152 @@
+//! @file ActionBench.cpp
+//! @brief Edit kernels of "A", "P", "R", "D" and "C" over generated PATH values of 10 to 32K chars
+//! @author kenjiuno
+//! @date Oct 18 2026
+//!
+//! Prints, per action and value length:
+//! @li ns/op: time of one edit.
+//! @li allocs/op and bytes/op: GlobalAlloc calls and bytes, once the arena holds its blocks as in a loaded plugin.
+//! @li touched/op: bytes of the value read, plus bytes handed out and zero filled by the arena.
+//!
+//! Pass --quick to run a few iterations only, as ctest does.
+
+#include <windows.h>
+
+#include "Win32Host.h"
+#include "../Utils/PathEdit.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace Utils;
+
+namespace
+{
+	//! buffers of edits, as g_arena of the plugin
+	Arena g_benchArena;
+
+	//! Generate a value of at most chars, at least one entry. Every 8th entry repeats an earlier one in upper case,
+	//! and every 16th entry is empty, so that "D" and "C" have work.
+	Host::String MakePath(size_t chars)
+	{
+		Host::String value;
+		for (unsigned index = 0; ; index++)
+		{
+			TCHAR entry[64];
+			if (index % 16 == 15)
+			{
+				entry[0] = 0;
+			}
+			else if (index % 8 == 7)
+			{
+				wsprintf(entry, _T("C:\\PROGRAM FILES\\VENDOR%u\\TOOL\\BIN"), index / 2);
+			}
+			else
+			{
+				wsprintf(entry, (index % 2 == 0) ? _T("C:\\Program Files\\Vendor%u\\Tool\\bin") : _T("%%SystemRoot%%\\App%u"), index);
+			}
+			const size_t grown = value.size() + ((index == 0) ? 0 : 1) + lstrlen(entry);
+			if (index != 0 && grown > chars)
+			{
+				return value;
+			}
+			if (index != 0)
+			{
+				value += _T(';');
+			}
+			value += entry;
+			if (index == 0 && grown > chars)
+			{
+				value.resize(chars);
+				return value;
+			}
+		}
+	}
+
+	//! Pick the entry in the middle of value, as the path to add or remove.
+	Host::String MiddleEntry(const Host::String &value)
+	{
+		size_t start = value.size() / 2;
+		while (start != 0 && value[start - 1] != _T(';'))
+		{
+			start--;
+		}
+		const size_t end = value.find(_T(';'), start);
+		return value.substr(start, (end == Host::String::npos) ? Host::String::npos : end - start);
+	}
+
+	//! Run one action over value, and print a line of results.
+	template <class Action>
+	void Run(const char *action, const Host::String &value, const Host::String &yourPath, size_t iterations)
+	{
+		const StrSpan valueSpan = { value.c_str(), value.size() };
+		const StrSpan yourSpan = { yourPath.c_str(), yourPath.size() };
+		ExactMatch matcher;
+		bool success = true;
+
+		// the first edit obtains the arena blocks, as the first call of a loaded plugin does
+		{
+			ArenaScope scope(&g_benchArena);
+			GrowString NewPathStr;
+			success &= EditPath<Action>(valueSpan, yourSpan, NewPathStr, matcher);
+		}
+
+		const Host::Win32Counters win32 = Host::g_win32;
+		const size_t bytesUsed = g_benchArena.bytesUsed;
+		const size_t bytesZeroed = g_benchArena.bytesZeroed;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t iteration = 0; iteration < iterations; iteration++)
+		{
+			ArenaScope scope(&g_benchArena);
+			GrowString NewPathStr;
+			success &= EditPath<Action>(valueSpan, yourSpan, NewPathStr, matcher);
+		}
+		const auto stop = std::chrono::steady_clock::now();
+
+		const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+		const size_t touched = value.size() * sizeof(TCHAR) * iterations
+			+ (g_benchArena.bytesUsed - bytesUsed)
+			+ (g_benchArena.bytesZeroed - bytesZeroed);
+		printf("%-2s %6u %12.1f %10.2f %12.1f %12.1f%s\n",
+			action,
+			static_cast<unsigned>(value.size()),
+			ns / iterations,
+			static_cast<double>(Host::g_win32.globalAllocs - win32.globalAllocs) / iterations,
+			static_cast<double>(Host::g_win32.bytesAllocated - win32.bytesAllocated) / iterations,
+			static_cast<double>(touched) / iterations,
+			success ? "" : " FAILED"
+		);
+		if (!success)
+		{
+			exit(1);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	const size_t lengths[] = { 10, 100, 1000, 4000, 16000, 32767 };
+
+	printf("%s build, %u bytes per char\n", (sizeof(TCHAR) == 1) ? "ANSI" : "Unicode", static_cast<unsigned>(sizeof(TCHAR)));
+	printf("%-2s %6s %12s %10s %12s %12s\n", "", "chars", "ns/op", "allocs/op", "bytes/op", "touched/op");
+
+	for (size_t length : lengths)
+	{
+		const Host::String value = MakePath(length);
+		const Host::String yourPath = MiddleEntry(value);
+		// about 64M chars scanned per action
+		const size_t iterations = quick ? 3 : (64u * 1024 * 1024) / (value.size() + 64);
+
+		Run<AppendAction>("A", value, yourPath, iterations);
+		Run<PrependAction>("P", value, yourPath, iterations);
+		Run<RemoveAction>("R", value, yourPath, iterations);
+		Run<DedupeAction>("D", value, yourPath, iterations);
+		Run<CompactAction>("C", value, yourPath, iterations);
+	}
+
+	g_benchArena.Release();
+	return 0;
+}
@@ -0,0 +1,151 @@
+//! @file DedupeBench.cpp
+//! @brief "D" over a PATH value of 2,000 entries: PathIndex against pairwise comparison
+//! @author kenjiuno
+//! @date Oct 18 2026
+//!
+//! Prints, per share of repeated entries:
+//! @li hashed ns/op: EditPath of DedupeAction, finding repeats by PathIndex.
+//! @li pairwise ns/op: each entry compared with all kept entries by EqualsIgnoreCase, as a loop without index would do.
+//! @li speedup: pairwise over hashed.
+//! @li compares/op: EqualsIgnoreCase calls of the pairwise loop.
+//!
+//! Pass --quick to run a few iterations only, as ctest does.
+
+#include <windows.h>
+
+#include "Win32Host.h"
+#include "../Utils/PathEdit.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Utils;
+
+namespace
+{
+	//! buffers of edits, as g_arena of the plugin
+	Arena g_benchArena;
+
+	//! Generate entries, of which every repeatEvery-th one repeats an earlier one in upper case. 0 for no repeats.
+	Host::String MakePath(size_t entries, unsigned repeatEvery)
+	{
+		Host::String value;
+		for (unsigned index = 0; index < entries; index++)
+		{
+			TCHAR entry[64];
+			if (repeatEvery != 0 && index % repeatEvery == repeatEvery - 1)
+			{
+				wsprintf(entry, _T("C:\\PROGRAM FILES\\VENDOR%u\\TOOL\\BIN"), index / 2);
+			}
+			else
+			{
+				wsprintf(entry, _T("C:\\Program Files\\Vendor%u\\Tool\\bin"), index);
+			}
+			if (index != 0)
+			{
+				value += _T(';');
+			}
+			value += entry;
+		}
+		return value;
+	}
+
+	//! Dedupe by comparing each entry with every kept one.
+	/*!
+		@param compares incremented per EqualsIgnoreCase call.
+	 */
+	bool DedupePairwise(const StrSpan &value, FixedLenStr &NewPathStr, size_t &compares)
+	{
+		StrBuilder NewPath(NewPathStr);
+		std::vector<StrSpan> kept;
+		bool success = true;
+
+		StrTokenizer tokens(value, _T(';'));
+		StrSpan onePath;
+		while (tokens.Next(onePath))
+		{
+			bool repeated = false;
+			for (const StrSpan &keptPath : kept)
+			{
+				compares++;
+				if (keptPath.EqualsIgnoreCase(onePath))
+				{
+					repeated = true;
+					break;
+				}
+			}
+			if (!repeated)
+			{
+				kept.push_back(onePath);
+				success &= NewPath.AppendSeparated(_T(';'), onePath);
+			}
+		}
+		return success;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	const size_t entries = 2000;
+	const unsigned repeats[] = { 0, 8, 4, 2 };
+	const size_t iterations = quick ? 2 : 200;
+
+	printf("%s build, %u bytes per char, %u entries\n", (sizeof(TCHAR) == 1) ? "ANSI" : "Unicode", static_cast<unsigned>(sizeof(TCHAR)), static_cast<unsigned>(entries));
+	printf("%-8s %7s %12s %12s %8s %12s\n", "repeats", "chars", "hashed", "pairwise", "speedup", "compares/op");
+
+	for (unsigned repeatEvery : repeats)
+	{
+		const Host::String value = MakePath(entries, repeatEvery);
+		const StrSpan valueSpan = { value.c_str(), value.size() };
+		const StrSpan none = { _T(""), 0 };
+		ExactMatch matcher;
+		bool success = true;
+
+		auto start = std::chrono::steady_clock::now();
+		Host::String hashedResult;
+		for (size_t iteration = 0; iteration < iterations; iteration++)
+		{
+			ArenaScope scope(&g_benchArena);
+			GrowString NewPathStr;
+			success &= EditPath<DedupeAction>(valueSpan, none, NewPathStr, matcher);
+			if (iteration == 0)
+			{
+				hashedResult = static_cast<LPCTSTR>(NewPathStr);
+			}
+		}
+		const double hashed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+		size_t compares = 0;
+		start = std::chrono::steady_clock::now();
+		for (size_t iteration = 0; iteration < iterations; iteration++)
+		{
+			ArenaScope scope(&g_benchArena);
+			GrowString NewPathStr;
+			success &= DedupePairwise(valueSpan, NewPathStr, compares);
+			success &= NewPathStr.Span().Equals(StrSpan::Of(hashedResult.c_str()));
+		}
+		const double pairwise = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+		char label[16];
+		sprintf(label, (repeatEvery == 0) ? "none" : "1/%u", repeatEvery);
+		printf("%-8s %7u %12.0f %12.0f %8.1f %12u%s\n",
+			label,
+			static_cast<unsigned>(value.size()),
+			hashed,
+			pairwise,
+			pairwise / hashed,
+			static_cast<unsigned>(compares / iterations),
+			success ? "" : " FAILED"
+		);
+		if (!success)
+		{
+			return 1;
+		}
+	}
+
+	g_benchArena.Release();
+	return 0;
+}
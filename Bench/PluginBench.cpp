@@ -0,0 +1,117 @@
+//! @file PluginBench.cpp
+//! @brief EnvVarUpdate called in a loop through the NSIS stack, as an installer script does
+//! @author kenjiuno
+//! @date Oct 18 2026
+//!
+//! Each call appends or removes an entry of a HKCU value of 100 to 4000 chars, and the result is popped.
+//! Prints, per NSIS_MAX_STRLEN, value length and SetOption "Result":
+//! @li ns/call: time of one call, including the pushes and pops of the installer.
+//! @li entries/call and stack/call: stack entries pushed, and their bytes: g_stringsize chars each.
+//! @li allocs/call: GlobalAlloc calls: of stack entries, and of the plugin, as the value cached by each write.
+//!
+//! Pass --quick to run a few iterations only, as ctest does.
+
+#include "NsisHost.h"
+#include "Win32Host.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	//! Generate a value of about chars.
+	Host::String MakePath(size_t chars)
+	{
+		Host::String value;
+		for (unsigned index = 0; value.size() < chars; index++)
+		{
+			TCHAR entry[64];
+			wsprintf(entry, _T("C:\\Program Files\\Vendor%u\\Tool\\bin;"), index);
+			value += entry;
+		}
+		value.resize(chars);
+		return value;
+	}
+
+	//! Run EnvVarUpdate over value, and print a line of results.
+	void Run(int stringSize, size_t chars, LPCTSTR result, size_t iterations)
+	{
+		Host::RegistryClear();
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("BenchPath"), REG_EXPAND_SZ, MakePath(chars));
+
+		Host::Installer installer(stringSize);
+		installer.Call(SetOption, { _T("Result"), result });
+		const bool popResult = lstrcmp(result, _T("None")) != 0;
+
+		// the first call loads the plugin state and obtains the arena blocks
+		installer.Call(EnvVarUpdate, { _T("BenchPath"), _T("A"), _T("HKCU"), _T("C:\\Bench") });
+		installer.Call(EnvVarUpdate, { _T("BenchPath"), _T("R"), _T("HKCU"), _T("C:\\Bench") });
+		while (installer.Depth() != 0)
+		{
+			installer.Pop();
+		}
+
+		const Host::Win32Counters win32 = Host::g_win32;
+		const Host::PluginApiCounters pluginApi = Host::g_pluginApi;
+		Host::String text;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t iteration = 0; iteration < iterations; iteration++)
+		{
+			installer.Call(EnvVarUpdate, { _T("BenchPath"), (iteration % 2 == 0) ? _T("A") : _T("R"), _T("HKCU"), _T("C:\\Bench") });
+			if (popResult)
+			{
+				installer.Pop(text);
+			}
+		}
+		const auto stop = std::chrono::steady_clock::now();
+
+		const Host::Win32Counters win32After = Host::g_win32;
+		const Host::PluginApiCounters pluginApiAfter = Host::g_pluginApi;
+		const bool success = !installer.IfErrors() && installer.Depth() == 0;
+		installer.Call(SetOption, { _T("Result"), _T("Value") });
+
+		const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+		printf("%5d %6u %-6s %12.1f %12.2f %12.1f %12.2f%s\n",
+			stringSize,
+			static_cast<unsigned>(chars),
+			static_cast<const char *>(popResult ? "Value" : "None"),
+			ns / iterations,
+			static_cast<double>(pluginApiAfter.entryAllocs - pluginApi.entryAllocs) / iterations,
+			static_cast<double>(pluginApiAfter.entryBytes - pluginApi.entryBytes) / iterations,
+			static_cast<double>(win32After.globalAllocs - win32.globalAllocs) / iterations,
+			success ? "" : " FAILED"
+		);
+		if (!success)
+		{
+			exit(1);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	const int stringSizes[] = { 1024, 8192 };
+	const size_t lengths[] = { 100, 1000, 4000 };
+
+	printf("%s build, %u bytes per char\n", (sizeof(TCHAR) == 1) ? "ANSI" : "Unicode", static_cast<unsigned>(sizeof(TCHAR)));
+	printf("%5s %6s %-6s %12s %12s %12s %12s\n", "strsz", "chars", "result", "ns/call", "entries/call", "stack/call", "allocs/call");
+
+	for (int stringSize : stringSizes)
+	{
+		for (size_t length : lengths)
+		{
+			// longer values are truncated by NSIS_MAX_STRLEN
+			if (length >= static_cast<size_t>(stringSize))
+			{
+				continue;
+			}
+			const size_t iterations = quick ? 3 : (16u * 1024 * 1024) / (length + 256);
+			Run(stringSize, length, _T("Value"), iterations);
+			Run(stringSize, length, _T("None"), iterations);
+		}
+	}
+	return 0;
+}
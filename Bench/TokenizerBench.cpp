@@ -0,0 +1,120 @@
+//! @file TokenizerBench.cpp
+//! @brief StrTokenizer and StrBuilder splitting and rebuilding PATH values of 1K to 32K chars
+//! @author kenjiuno
+//! @date Oct 18 2026
+//!
+//! Prints, per value length:
+//! @li ns/op: time to split the value, and rebuild it entry by entry.
+//! @li ns/char: ns/op per char of the value. Flat over lengths as the pass is linear.
+//! @li ratio: ns/char relative to the shortest value.
+//!
+//! Pass --quick to run a few iterations only, as ctest does.
+
+#include <windows.h>
+
+#include "Win32Host.h"
+#include "../Utils/StrBuilder.h"
+#include "../Utils/GrowString.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace Utils;
+
+namespace
+{
+	//! buffers of rebuilt values, as g_arena of the plugin
+	Arena g_benchArena;
+
+	//! Generate a value of chars, of entries about 30 chars long, not ending with a delimiter.
+	Host::String MakePath(size_t chars)
+	{
+		Host::String value;
+		for (unsigned index = 0; value.size() < chars; index++)
+		{
+			TCHAR entry[64];
+			wsprintf(entry, _T("C:\\Program Files\\Vendor%u\\bin;"), index);
+			value += entry;
+		}
+		value.resize(chars);
+		// a trailing delimiter yields no last empty token: keep the value rebuildable as is
+		if (value.back() == _T(';'))
+		{
+			value.back() = _T('x');
+		}
+		return value;
+	}
+
+	//! Split value, and rebuild it. Returns number of entries.
+	size_t Rebuild(const StrSpan &value, FixedLenStr &rebuilt)
+	{
+		StrTokenizer tokenizer(value, _T(';'));
+		StrBuilder builder(rebuilt);
+		size_t entries = 0;
+		StrSpan token;
+		while (tokenizer.Next(token))
+		{
+			const StrSpan delim = { _T(";"), 1 };
+			if (entries != 0)
+			{
+				builder.Append(delim);
+			}
+			builder.Append(token);
+			entries++;
+		}
+		return entries;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+	const size_t lengths[] = { 1024, 2048, 4096, 8192, 16384, 32767 };
+
+	printf("%s build, %u bytes per char\n", (sizeof(TCHAR) == 1) ? "ANSI" : "Unicode", static_cast<unsigned>(sizeof(TCHAR)));
+	printf("%6s %8s %12s %10s %8s\n", "chars", "entries", "ns/op", "ns/char", "ratio");
+
+	double firstNsPerChar = 0;
+	for (size_t length : lengths)
+	{
+		const Host::String value = MakePath(length);
+		const StrSpan valueSpan = { value.c_str(), value.size() };
+		// about 64M chars scanned per length
+		const size_t iterations = quick ? 3 : (64u * 1024 * 1024) / value.size();
+
+		size_t entries = 0;
+		bool success = true;
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t iteration = 0; iteration < iterations; iteration++)
+		{
+			ArenaScope scope(&g_benchArena);
+			GrowString rebuilt;
+			entries = Rebuild(valueSpan, rebuilt);
+			success &= rebuilt.Span().Equals(valueSpan);
+		}
+		const auto stop = std::chrono::steady_clock::now();
+
+		const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+		const double nsPerChar = ns / value.size();
+		if (firstNsPerChar == 0)
+		{
+			firstNsPerChar = nsPerChar;
+		}
+		printf("%6u %8u %12.1f %10.3f %8.2f%s\n",
+			static_cast<unsigned>(value.size()),
+			static_cast<unsigned>(entries),
+			ns,
+			nsPerChar,
+			nsPerChar / firstNsPerChar,
+			success ? "" : " FAILED"
+		);
+		if (!success)
+		{
+			return 1;
+		}
+	}
+
+	g_benchArena.Release();
+	return 0;
+}
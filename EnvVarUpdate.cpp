@@ -7,161 +7,486 @@
 #include <nsis/pluginapi.h> // nsis plugin
 
 #include "Utils/NsisString.h"
-#include "Utils/LongString.h"
+#include "Utils/ShortString.h"
+#include "Utils/GrowString.h"
+#include "Utils/PathEdit.h"
+#include "Utils/Arena.h"
+#include "Utils/EditQueue.h"
+#include "Utils/EditGroup.h"
+#include "Utils/RegistryStore.h"
+#include "Utils/Broadcast.h"
+#include "Utils/RegTransaction.h"
+#include "Utils/OfflineHive.h"
+#include "Utils/RegFile.h"
 
 using namespace Utils;
 
+extern "C" HINSTANCE g_hInstance;
+
 HWND g_hwndParent;
 
-//! getter prototype
-typedef bool(*GetRegValue)(LPCTSTR EnvVarName, FixedLenStr &ResultVar);
+//! string buffers of plugin calls, kept until NSPIM_UNLOAD
+Arena g_arena;
+
+//! WM_SETTINGCHANGE deferred until NSPIM_GUIUNLOAD or NSPIM_UNLOAD, if enabled by SetOption
+EnvBroadcast g_broadcast;
+
+//! edits queued between TransactionBegin and TransactionCommit
+EditList g_transactionEdits;
+
+//! true between TransactionBegin and TransactionCommit or TransactionAbort
+bool g_transactionActive;
+
+//! true to commit transactions by KTM, set by SetOption "Transaction" "KTM"
+bool g_useKtm;
+
+//! how entries are matched, set by SetOption "Normalize"
+NormalizeMode g_normalizeMode;
+
+//! offline hive edited instead of HKCU, between OfflineHiveOpen and OfflineHiveClose
+OfflineHive g_hkcuHive;
+
+//! offline hive edited instead of HKLM, between OfflineHiveOpen and OfflineHiveClose
+OfflineHive g_hklmHive;
 
-//! getter error fallback
-bool GetNullRegValue(LPCTSTR EnvVarName, FixedLenStr &ResultVar)
+//! .reg file edited instead of HKCU, between RegFileOpen and RegFileClose
+RegFile g_hkcuRegFile;
+
+//! .reg file edited instead of HKLM, between RegFileOpen and RegFileClose
+RegFile g_hklmRegFile;
+
+//! What EnvVarUpdate pushes, set by SetOption "Result".
+enum ResultMode
 {
-	return false;
-}
+	//! new value
+	ResultValue,
+	//! "changed", "unchanged" or "error", same as GetLastStatus
+	ResultStatus,
+	//! length of new value in chars
+	ResultLength,
+	//! nothing
+	ResultNone,
+};
+
+//! what EnvVarUpdate pushes
+ResultMode g_resultMode;
+
+//! results pushed truncated to NSIS string size
+size_t g_truncations;
+
+//! true to write the result of EnvVarUpdate to g_resultVar instead of pushing, set by SetOption "ResultVar"
+bool g_resultToVar;
+
+//! user variable index, INST_0 to INST_R9
+int g_resultVar;
 
-//! generic getter
-bool GetRegValueFrom(HKEY baseKey, LPCTSTR keyName, LPCTSTR valueName, FixedLenStr &ResultVar)
+//! Push result of EnvVarUpdate, or write it to the user variable chosen by SetOption "ResultVar".
+/*!
+	@remarks The variable is written in place with a bounded copy: setuservariable copies without limit.
+ */
+void DeliverResult(LPCTSTR text)
 {
-	HKEY keyHandle;
-	LSTATUS error = RegOpenKeyEx(
-		baseKey,
-		keyName,
-		0,
-		KEY_READ,
-		&keyHandle
-	);
-	if (error == ERROR_SUCCESS)
-	{
-		DWORD typeReturned;
-		DWORD bytesWritten = ResultVar.BufferBytesLength();
-		ResultVar.Clear();
-		error = RegQueryValueEx(
-			keyHandle,
-			valueName,
-			NULL,
-			&typeReturned,
-			reinterpret_cast<LPBYTE>(static_cast<LPTSTR>(ResultVar)),
-			&bytesWritten
-		);
-		if (error == ERROR_SUCCESS || error == ERROR_FILE_NOT_FOUND)
+	if (g_resultToVar)
+	{
+		LPTSTR variable = getuservariable(g_resultVar);
+		if (variable != nullptr)
 		{
-			RegCloseKey(keyHandle);
-			return true;
+			lstrcpyn(variable, text, g_stringsize);
 		}
+		return;
+	}
+	PushString(text);
+}
 
-		RegCloseKey(keyHandle);
+//! Parse user variable name "0" to "9", or "R0" to "R9", with or without '$'.
+/*!
+	@return false if not a user variable name.
+ */
+bool ParseUserVariable(LPCTSTR name, int &index)
+{
+	if (name[0] == _T('$'))
+	{
+		name++;
 	}
-	return false;
+	int base = INST_0;
+	if (name[0] == _T('R') || name[0] == _T('r'))
+	{
+		base = INST_R0;
+		name++;
+	}
+	if (name[0] < _T('0') || name[0] > _T('9') || name[1] != 0)
+	{
+		return false;
+	}
+	index = base + (name[0] - _T('0'));
+	return true;
 }
 
-//! getter for current user
-bool GetHKCURegValue(LPCTSTR EnvVarName, FixedLenStr &ResultVar)
+//! Discard queued edits of transaction.
+void AbortTransaction()
 {
-	return GetRegValueFrom(
-		HKEY_CURRENT_USER, 
-		_T("Environment"), 
-		EnvVarName, 
-		ResultVar
-	);
+	EditQueue edits;
+	edits.TakeFrom(g_transactionEdits);
+	g_transactionActive = false;
+}
+
+//! Result of the last EnvVarUpdate, EnvVarUpdateBatch or TransactionCommit call.
+enum EditStatus
+{
+	//! failed, and the error flag is set
+	StatusError,
+	//! written
+	StatusChanged,
+	//! the result equals the read value, and nothing is written
+	StatusUnchanged,
+};
+
+//! reported by GetLastStatus
+EditStatus g_lastStatus;
+
+//! Text of status, pushed by GetLastStatus.
+LPCTSTR StatusText(EditStatus status)
+{
+	switch (status)
+	{
+	case StatusChanged:
+		return _T("changed");
+	case StatusUnchanged:
+		return _T("unchanged");
+	default:
+		return _T("error");
+	}
+}
+
+//! entries and bytes removed by the last EnvVarUpdate, EnvVarUpdateBatch or TransactionCommit call, reported by GetCounter
+EditCounters g_lastRemoved;
+
+//! Set g_lastRemoved to what the kernels removed since before, once g_lastStatus of the call is set.
+/*!
+	@remarks A call writing nothing removes nothing, even if its edits were computed.
+ */
+void SetLastRemoved(const EditCounters &before)
+{
+	const bool changed = g_lastStatus == StatusChanged;
+	g_lastRemoved.entriesRemoved = changed ? g_editCounters.entriesRemoved - before.entriesRemoved : 0;
+	g_lastRemoved.bytesRemoved = changed ? g_editCounters.bytesRemoved - before.bytesRemoved : 0;
+	g_lastRemoved.entriesScanned = g_editCounters.entriesScanned - before.entriesScanned;
 }
 
-//! getter for local machine
-bool GetHKLMRegValue(LPCTSTR EnvVarName, FixedLenStr &ResultVar)
+//! true once the plugin callback is registered: this DLL stays loaded between calls
+bool g_callbackRegistered;
+
+//! file to append stats to at unload, or empty
+TCHAR g_statsLogPath[MAX_PATH];
+
+//! Write stats as "name=value" pairs separated by space.
+/*!
+	@param text buffer of 1024 chars at least.
+ */
+void FormatStats(LPTSTR text)
 {
-	return GetRegValueFrom(
-		HKEY_LOCAL_MACHINE, 
-		_T("SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment"), 
-		EnvVarName, 
-		ResultVar
+	wsprintf(text,
+		_T("reads=%u get_us=%u transforms=%u transform_us=%u writes=%u set_us=%u bytes_read=%u bytes_written=%u entries=%u allocations=%u bytes_used=%u"),
+		static_cast<UINT>(g_storeCounters.reads),
+		static_cast<UINT>(g_stats.getTime / 10),
+		static_cast<UINT>(g_stats.transforms),
+		static_cast<UINT>(g_stats.transformTime / 10),
+		static_cast<UINT>(g_storeCounters.writes),
+		static_cast<UINT>(g_stats.setTime / 10),
+		static_cast<UINT>(g_storeCounters.bytesRead),
+		static_cast<UINT>(g_storeCounters.bytesWritten),
+		static_cast<UINT>(g_editCounters.entriesScanned),
+		static_cast<UINT>(g_arena.allocations),
+		static_cast<UINT>(g_arena.bytesUsed)
 	);
 }
 
-//! setter prototype
-typedef bool(*SetRegValue)(LPCTSTR EnvVarName, const FixedLenStr &NewValue);
+//! Append a line of stats to g_statsLogPath, if set.
+void WriteStatsLog()
+{
+	if (g_statsLogPath[0] == 0)
+	{
+		return;
+	}
+	HANDLE file = CreateFile(g_statsLogPath, FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	TCHAR line[1024];
+	FormatStats(line);
+	// stats are ASCII: write as bytes in both builds
+	char bytes[1024 + 2];
+	DWORD length = 0;
+	while (line[length] != 0)
+	{
+		bytes[length] = static_cast<char>(line[length]);
+		length++;
+	}
+	bytes[length++] = '\r';
+	bytes[length++] = '\n';
+	DWORD bytesWritten;
+	WriteFile(file, bytes, length, &bytesWritten, NULL);
+	CloseHandle(file);
+}
+
+//! NSIS plugin callback
+UINT_PTR PluginCallback(enum NSPIM msg)
+{
+	if (msg == NSPIM_GUIUNLOAD || msg == NSPIM_UNLOAD)
+	{
+		// windows are still alive at NSPIM_GUIUNLOAD. NSPIM_UNLOAD sends nothing then.
+		g_broadcast.Flush();
+	}
+	if (msg == NSPIM_UNLOAD)
+	{
+		WriteStatsLog();
+		AbortTransaction();
+		// not closed by OfflineHiveClose or RegFileClose: discard
+		g_hkcuHive.Close(false);
+		g_hklmHive.Close(false);
+		g_hkcuRegFile.Close(false);
+		g_hklmRegFile.Close(false);
+		ReleaseRegistryKeys();
+		g_arena.Release();
+		// as loaded again, if the DLL is not unloaded after this
+		g_callbackRegistered = false;
+	}
+	return 0;
+}
+
+//! Common setup of exported functions.
+void PluginInit(extra_parameters *extra)
+{
+	if (!g_callbackRegistered && extra->exec_flags->plugin_api_version >= NSISPIAPIVER_1_0)
+	{
+		g_callbackRegistered = extra->RegisterPluginCallback(g_hInstance, PluginCallback) >= 0;
+	}
+}
+
+//! Common cleanup of exported functions.
+void PluginExit()
+{
+	if (!g_callbackRegistered)
+	{
+		// no NSPIM_UNLOAD is coming. this DLL may be unloaded just after this call.
+		g_broadcast.Flush();
+		g_hkcuHive.Close(false);
+		g_hklmHive.Close(false);
+		g_hkcuRegFile.Close(false);
+		g_hklmRegFile.Close(false);
+		ReleaseRegistryKeys();
+		g_arena.Release();
+	}
+}
+
+//! Select offline hive by RegLoc ("HKCU" or "HKLM"), or nullptr.
+OfflineHive *SelectOfflineHive(LPCTSTR RegLoc)
+{
+	if (lstrcmpi(RegLoc, _T("HKCU")) == 0)
+	{
+		return &g_hkcuHive;
+	}
+	else if (lstrcmpi(RegLoc, _T("HKLM")) == 0)
+	{
+		return &g_hklmHive;
+	}
+	return nullptr;
+}
+
+//! Select .reg file by RegLoc ("HKCU" or "HKLM"), or nullptr.
+RegFile *SelectRegFile(LPCTSTR RegLoc)
+{
+	if (lstrcmpi(RegLoc, _T("HKCU")) == 0)
+	{
+		return &g_hkcuRegFile;
+	}
+	else if (lstrcmpi(RegLoc, _T("HKLM")) == 0)
+	{
+		return &g_hklmRegFile;
+	}
+	return nullptr;
+}
 
-//! setter error fallback
-bool SetNullRegValue(LPCTSTR EnvVarName, const FixedLenStr &NewValue)
+//! Select store by RegLoc ("HKCU" or "HKLM"). An open .reg file, then an open offline hive, is selected instead of the registry.
+bool SelectRegLoc(LPCTSTR RegLoc, EnvStore &store)
 {
+	store = EnvStore();
+
+	if (lstrcmpi(RegLoc, _T("HKCU")) == 0)
+	{
+		store = g_hkcuRegFile.IsOpen() ? RegFileStore(&g_hkcuRegFile) : g_hkcuHive.IsOpen() ? OfflineHiveStore(&g_hkcuHive) : HKCURegistryStore();
+		return true;
+	}
+	else if (lstrcmpi(RegLoc, _T("HKLM")) == 0)
+	{
+		store = g_hklmRegFile.IsOpen() ? RegFileStore(&g_hklmRegFile) : g_hklmHive.IsOpen() ? OfflineHiveStore(&g_hklmHive) : HKLMRegistryStore();
+		return true;
+	}
 	return false;
 }
 
-//! setter for current user
-bool SetHKCURegValue(LPCTSTR EnvVarName, const FixedLenStr &NewValue)
-{
-	HKEY keyHandle;
-	DWORD disposition;
-	LSTATUS error = RegCreateKeyEx(
-		HKEY_CURRENT_USER,
-		_T("Environment"),
-		0,
-		NULL,
-		REG_OPTION_NON_VOLATILE,
-		KEY_WRITE,
-		NULL,
-		&keyHandle,
-		&disposition
-	);
-	if (error == ERROR_SUCCESS)
-	{
-		error = RegSetValueEx(
-			keyHandle,
-			EnvVarName,
-			0,
-			REG_EXPAND_SZ,
-			reinterpret_cast<const BYTE *>(static_cast<LPCTSTR>(NewValue)),
-			NewValue.StringBytesLength()
-		);
-
-		if (error == ERROR_SUCCESS)
+//! Store writes to the registry of this system, which running programs see after a broadcast.
+bool IsLiveStore(const EnvStore &store)
+{
+	return !IsOfflineStore(store) && !IsRegFileStore(store);
+}
+
+//! Run FindPath with the matcher chosen by normalizer.mode.
+size_t FindPathMatching(const StrSpan &value, const StrSpan &yourPath, PathNormalizer &normalizer, size_t &count)
+{
+	PhaseTimer timer(g_stats.transformTime);
+	g_stats.transforms++;
+
+	if (normalizer.mode == NormalizeNone)
+	{
+		ExactMatch exact;
+		return FindPath(value, yourPath, exact, count);
+	}
+	return FindPath(value, yourPath, normalizer, count);
+}
+
+//! Write computed value to store, unless unchanged.
+/*!
+	@param written incremented when the value is written.
+ */
+bool WriteEditGroup(EnvStore &store, PendingValue &pending, size_t &written)
+{
+	if (!pending.IsChanged())
+	{
+		return true;
+	}
+	if (!store.Set(pending.first->EnvVarName, *pending.current, ChooseValueType(pending.ValueType, *pending.current)))
+	{
+		return false;
+	}
+	pending.written = true;
+	written++;
+	return true;
+}
+
+//! Broadcast at unload if any group is written to the registry of this system.
+/*!
+	@remarks Called once the writes are final: after a commit, and never after a failure.
+ */
+void MarkEditGroupsDirty(PendingValue *last)
+{
+	for (PendingValue *pending = last; pending != nullptr; pending = pending->prev)
+	{
+		if (pending->written && IsLiveStore(pending->store))
+		{
+			g_broadcast.MarkDirty();
+		}
+	}
+}
+
+//! Write the read values back to written groups.
+/*!
+	@param transacted true if registry writes were made in a transaction rolled back: only other stores are restored.
+ */
+void RestoreEditGroups(PendingValue *last, bool transacted)
+{
+	for (PendingValue *pending = last; pending != nullptr; pending = pending->prev)
+	{
+		if (pending->written && !(transacted && IsLiveStore(pending->store)))
 		{
-			RegCloseKey(keyHandle);
-			return true;
+			pending->store.Set(pending->first->EnvVarName, pending->ReadValue, pending->ValueType);
 		}
+	}
+}
+
+//! Apply all edits of one (EnvVarName, RegLoc) group with a single read and a single write.
+/*!
+	@param first the first not yet done entry of the group.
+	@param written incremented when the value is written.
+	@return false if any edit of the group fails. Nothing is written then.
+	@remarks Nothing is written either if the edits result in the read value.
+ */
+bool ApplyEditGroup(EditEntry *first, size_t &written, PathNormalizer &normalizer)
+{
+	ArenaScope scope;
 
-		RegCloseKey(keyHandle);
+	PendingValue pending;
+	if (ComputeEditGroup(first, pending, normalizer, SelectRegLoc) && WriteEditGroup(pending.store, pending, written))
+	{
+		MarkEditGroupsDirty(&pending);
+		return true;
 	}
 	return false;
 }
 
-//! setter for local machine
-bool SetHKLMRegValue(LPCTSTR EnvVarName, const FixedLenStr &NewValue)
-{
-	HKEY keyHandle;
-	DWORD disposition;
-	LSTATUS error = RegCreateKeyEx(
-		HKEY_LOCAL_MACHINE,
-		_T("SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment"),
-		0,
-		NULL,
-		REG_OPTION_NON_VOLATILE,
-		KEY_WRITE,
-		NULL,
-		&keyHandle,
-		&disposition
-	);
-	if (error == ERROR_SUCCESS)
-	{
-		error = RegSetValueEx(
-			keyHandle,
-			EnvVarName,
-			0,
-			REG_EXPAND_SZ,
-			reinterpret_cast<const BYTE *>(static_cast<LPCTSTR>(NewValue)),
-			NewValue.StringBytesLength()
-		);
-
-		if (error == ERROR_SUCCESS)
+//! Write all computed groups, or none of them.
+/*!
+	@param last the last computed group, linked by prev.
+	@remarks
+	With g_useKtm, registry values are written in one KTM transaction.
+	An offline hive or a .reg file is not in the transaction: it is written directly, and restored as below on failure.
+	Otherwise values are written one by one, and written ones are restored to the read values on failure.
+ */
+bool WriteEditGroups(PendingValue *last, size_t &written)
+{
+	bool success = true;
+	size_t attemptWritten = 0;
+
+	if (g_useKtm)
+	{
+		RegTransaction transaction;
+		if (!transaction.Begin())
+		{
+			return false;
+		}
+		for (PendingValue *pending = last; success && pending != nullptr; pending = pending->prev)
+		{
+			EnvStore store = transaction.Store(pending->store);
+			success = WriteEditGroup(store, *pending, attemptWritten);
+		}
+		success = success && transaction.Commit();
+		if (!success)
+		{
+			transaction.Rollback();
+			RestoreEditGroups(last, true);
+			return false;
+		}
+	}
+	else
+	{
+		for (PendingValue *pending = last; success && pending != nullptr; pending = pending->prev)
+		{
+			success = WriteEditGroup(pending->store, *pending, attemptWritten);
+		}
+		if (!success)
 		{
-			RegCloseKey(keyHandle);
-			return true;
+			RestoreEditGroups(last, false);
+			return false;
 		}
+	}
+
+	written += attemptWritten;
+	MarkEditGroupsDirty(last);
+	return true;
+}
 
-		RegCloseKey(keyHandle);
+//! Compute all groups from entry, and then write all of them at once.
+/*!
+	@param computed groups computed so far, linked by prev.
+	@remarks Recurses once per group, so that computed values stay alive on the stack until all are written.
+ */
+bool CommitEditGroups(EditEntry *entry, PendingValue *computed, size_t &written, PathNormalizer &normalizer)
+{
+	while (entry != nullptr && entry->done)
+	{
+		entry = entry->next;
 	}
-	return false;
+	if (entry == nullptr)
+	{
+		return WriteEditGroups(computed, written);
+	}
+
+	ArenaScope scope;
+
+	PendingValue pending;
+	pending.prev = computed;
+	return ComputeEditGroup(entry, pending, normalizer, SelectRegLoc) && CommitEditGroups(entry->next, &pending, written, normalizer);
 }
 
 // To work with Unicode version of NSIS, please use TCHAR-type
@@ -178,6 +503,7 @@ extern "C" void __declspec(dllexport) EnvVarUpdate(
 {
 	EXDLL_INIT();
 	g_hwndParent = hwndParent;
+	PluginInit(extra);
 
 
 	// note if you want parameters from the stack, pop them off in order.
@@ -189,13 +515,17 @@ extern "C" void __declspec(dllexport) EnvVarUpdate(
 
 	// do your stuff here
 	{
-		NsisString ResultVar;
+		ArenaScope scope(&g_arena);
+
 		NsisString EnvVarName;
-		NsisString Action;
-		NsisString RegLoc;
+		ShortString Action;
+		ShortString RegLoc;
 		NsisString PathString;
 
+		GrowString NewPathStr;
+		bool computed = false;
 		bool success = false;
+		const EditCounters before = g_editCounters;
 
 		if (true
 			&& EnvVarName.Pop()
@@ -204,96 +534,847 @@ extern "C" void __declspec(dllexport) EnvVarUpdate(
 			&& PathString.Pop()
 			)
 		{
-			bool Append = Action.CompareToIgnoreCase(_T("A")) == 0;
-			bool Prepend = Action.CompareToIgnoreCase(_T("P")) == 0;
-			bool Remove = Action.CompareToIgnoreCase(_T("R")) == 0;
+			EnvStore store;
+			SelectRegLoc(RegLoc, store);
 
-			bool HKLM = RegLoc.CompareToIgnoreCase(_T("HKLM")) == 0;
-			bool HKCU = RegLoc.CompareToIgnoreCase(_T("HKCU")) == 0;
-
-			GetRegValue getter = GetNullRegValue;
-			SetRegValue setter = SetNullRegValue;
-
-			if (HKCU)
-			{
-				getter = GetHKCURegValue;
-				setter = SetHKCURegValue;
-			}
-			else if (HKLM)
+			GrowString PathFromReg;
+			DWORD ValueType = REG_NONE;
+			if (store.Get(EnvVarName, PathFromReg, ValueType))
 			{
-				getter = GetHKLMRegValue;
-				setter = SetHKLMRegValue;
-			}
+				PathNormalizer normalizer(g_normalizeMode);
+				success = computed = ApplyAction(Action, PathFromReg, PathString, NewPathStr, normalizer);
 
-			LongString PathFromReg;
-			LongString NewPathStr;
-			if (getter(EnvVarName, PathFromReg))
-			{
-				if (Append)
-				{
-					size_t offset = 0;
-					LongString onePath;
-					success = true;
-					// filter out your path from registry
-					while (PathFromReg.GetToken(_T(';'), offset, onePath))
-					{
-						if (onePath.CompareToIgnoreCase(PathString) != 0)
-						{
-							success &= NewPathStr.AppendStringIfNotEmpty(_T(";"));
-							success &= NewPathStr.AppendString(onePath);
-						}
-					}
-					// now append your path
-					success &= NewPathStr.AppendStringIfNotEmpty(_T(";"));
-					success &= NewPathStr.AppendString(PathString);
-				}
-				else if (Prepend)
+				if (success)
 				{
-					size_t offset = 0;
-					LongString onePath;
-					success = true;
-					// at first prepend your path
-					success &= NewPathStr.AppendString(PathString);
-					// filter out your path from registry
-					while (PathFromReg.GetToken(_T(';'), offset, onePath))
+					if (NewPathStr.Span().Equals(PathFromReg.Span()))
 					{
-						if (onePath.CompareToIgnoreCase(PathString) != 0)
-						{
-							success &= NewPathStr.AppendStringIfNotEmpty(_T(";"));
-							success &= NewPathStr.AppendString(onePath);
-						}
+						g_lastStatus = StatusUnchanged;
 					}
-				}
-				else if (Remove)
-				{
-					size_t offset = 0;
-					LongString onePath;
-					success = true;
-					// omit your path
-					while (PathFromReg.GetToken(_T(';'), offset, onePath))
+					else
 					{
-						if (onePath.CompareToIgnoreCase(PathString) != 0)
+						success = store.Set(EnvVarName, NewPathStr, ChooseValueType(ValueType, NewPathStr));
+						g_lastStatus = StatusChanged;
+						if (success && IsLiveStore(store))
 						{
-							success &= NewPathStr.AppendStringIfNotEmpty(_T(";"));
-							success &= NewPathStr.AppendString(onePath);
+							g_broadcast.MarkDirty();
 						}
 					}
 				}
+			}
+		}
 
-				if (success)
-				{
-					ResultVar.AssignString(NewPathStr);
+		if (!success)
+		{
+			g_lastStatus = StatusError;
+			extra->exec_flags->exec_error++;
+		}
 
-					success = setter(EnvVarName, NewPathStr);
-				}
+		SetLastRemoved(before);
+
+		if (!computed)
+		{
+			NewPathStr.Clear();
+		}
+
+		switch (g_resultMode)
+		{
+		case ResultValue:
+			// delivered from the built buffer. At most g_stringsize chars are copied.
+			if (NewPathStr.StringCharCount() >= g_stringsize)
+			{
+				g_truncations++;
+			}
+			DeliverResult(NewPathStr);
+			break;
+		case ResultStatus:
+			DeliverResult(StatusText(g_lastStatus));
+			break;
+		case ResultLength:
+			{
+				TCHAR length[16];
+				wsprintf(length, _T("%u"), static_cast<UINT>(NewPathStr.StringCharCount()));
+				DeliverResult(length);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Apply many edits, reading and writing each (EnvVarName, RegLoc) value once.
+/*!
+	@remarks Pops (EnvVarName, Action, RegLoc, PathString) tuples until "/END".
+	Without "/END", nothing is applied: the popped strings are pushed back, and the error flag is set.
+	Pushes the number of values written.
+ */
+extern "C" void __declspec(dllexport) EnvVarUpdateBatch(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		EditQueue edits;
+		PathNormalizer normalizer(g_normalizeMode);
+		size_t written = 0;
+		const EditCounters before = g_editCounters;
+
+		bool success = edits.PopUntil(_T("/END"));
+
+		for (EditEntry *entry = edits.first; entry != nullptr; entry = entry->next)
+		{
+			if (!entry->done)
+			{
+				success &= ApplyEditGroup(entry, written, normalizer);
 			}
 		}
 
+		g_lastStatus = !success ? StatusError : (written != 0) ? StatusChanged : StatusUnchanged;
+		SetLastRemoved(before);
+
 		if (!success)
 		{
 			extra->exec_flags->exec_error++;
 		}
 
-		ResultVar.Push();
+		PushInt(written);
+	}
+
+	PluginExit();
+}
+
+//! Pop (EnvVarName, RegLoc, PathString), and find PathString in the value.
+/*!
+	@remarks The value is only read: keys are opened with KEY_READ, so that users can query HKLM.
+	A missing value has no entries. Sets the error flag on failure.
+	@param count receives the number of matching entries.
+	@return index of the first matching entry, or PathNotFound.
+ */
+size_t QueryPath(extra_parameters *extra, size_t &count)
+{
+	ArenaScope scope(&g_arena);
+
+	NsisString EnvVarName;
+	ShortString RegLoc;
+	NsisString PathString;
+
+	size_t first = PathNotFound;
+	count = 0;
+
+	bool success = false;
+
+	if (true
+		&& EnvVarName.Pop()
+		&& RegLoc.Pop()
+		&& PathString.Pop()
+		)
+	{
+		EnvStore store;
+		GrowString PathFromReg;
+		DWORD ValueType = REG_NONE;
+		if (SelectRegLoc(RegLoc, store) && store.Get(EnvVarName, PathFromReg, ValueType))
+		{
+			PathNormalizer normalizer(g_normalizeMode);
+			first = FindPathMatching(PathFromReg.Span(), StrSpan::Of(PathString), normalizer, count);
+			success = true;
+		}
+	}
+
+	if (!success)
+	{
+		extra->exec_flags->exec_error++;
 	}
+	return first;
+}
+
+//! Push 1 if PathString is in the value, or 0.
+/*!
+	@remarks Pops "EnvVarName", "RegLoc" and "PathString". Nothing is written.
+ */
+extern "C" void __declspec(dllexport) Contains(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	size_t count;
+	QueryPath(extra, count);
+	PushInt((count != 0) ? 1 : 0);
+
+	PluginExit();
+}
+
+//! Push index of the first entry matching PathString, from 0, or -1.
+/*!
+	@remarks Pops "EnvVarName", "RegLoc" and "PathString". Nothing is written.
+ */
+extern "C" void __declspec(dllexport) IndexOf(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	size_t count;
+	const size_t first = QueryPath(extra, count);
+	PushInt((first != PathNotFound) ? static_cast<int>(first) : -1);
+
+	PluginExit();
+}
+
+//! Push the number of entries matching PathString.
+/*!
+	@remarks Pops "EnvVarName", "RegLoc" and "PathString". Nothing is written.
+ */
+extern "C" void __declspec(dllexport) Count(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	size_t count;
+	QueryPath(extra, count);
+	PushInt(static_cast<int>(count));
+
+	PluginExit();
+}
+
+//! Start a transaction. Queued edits of a previous transaction are discarded.
+extern "C" void __declspec(dllexport) TransactionBegin(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	AbortTransaction();
+	g_transactionActive = true;
+
+	PluginExit();
+}
+
+//! Queue one (EnvVarName, Action, RegLoc, PathString) edit to the transaction.
+/*!
+	@remarks Nothing is read or written until TransactionCommit.
+ */
+extern "C" void __declspec(dllexport) TransactionAdd(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		EditQueue edit;
+		if (edit.Pop() && g_transactionActive)
+		{
+			edit.MoveTo(g_transactionEdits);
+		}
+		else
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Apply all queued edits, writing all of them or none.
+/*!
+	@remarks
+	All new values are computed in memory first, and nothing is written if any edit fails.
+	Pushes the number of values written.
+ */
+extern "C" void __declspec(dllexport) TransactionCommit(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		EditQueue edits;
+		edits.TakeFrom(g_transactionEdits);
+		PathNormalizer normalizer(g_normalizeMode);
+		size_t written = 0;
+		const EditCounters before = g_editCounters;
+
+		bool success = g_transactionActive && CommitEditGroups(edits.first, nullptr, written, normalizer);
+		g_transactionActive = false;
+
+		g_lastStatus = !success ? StatusError : (written != 0) ? StatusChanged : StatusUnchanged;
+		SetLastRemoved(before);
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+
+		PushInt(written);
+	}
+
+	PluginExit();
+}
+
+//! Discard queued edits of the transaction.
+extern "C" void __declspec(dllexport) TransactionAbort(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	AbortTransaction();
+
+	PluginExit();
+}
+
+//! Edit a hive file of an offline image instead of the registry, until OfflineHiveClose.
+/*!
+	@remarks Pops "RegLoc" and "HiveFile": "HKCU" with NTUSER.DAT, or "HKLM" with SYSTEM.
+	The hive file is read and written by OfflineHive itself. Needs NSIS 3 plugin callbacks.
+	Sets the error flag on failure, such as a hive having unapplied log entries.
+ */
+extern "C" void __declspec(dllexport) OfflineHiveOpen(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		ShortString RegLoc;
+		NsisString HiveFile;
+
+		bool success = false;
+
+		if (true
+			&& RegLoc.Pop()
+			&& HiveFile.Pop()
+			)
+		{
+			OfflineHive *hive = SelectOfflineHive(RegLoc);
+			success = hive != nullptr && hive->Open(HiveFile, hive == &g_hklmHive);
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Write the offline hive back to its file if edited, and edit the registry again.
+/*!
+	@remarks Pops "RegLoc". Sets the error flag if the hive is not saved: the file is not changed then.
+ */
+extern "C" void __declspec(dllexport) OfflineHiveClose(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ShortString RegLoc;
+
+		bool success = false;
+
+		if (RegLoc.Pop())
+		{
+			OfflineHive *hive = SelectOfflineHive(RegLoc);
+			success = hive != nullptr && hive->IsOpen() && hive->Close(true);
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Edit a .reg file exported by regedit instead of the registry, until RegFileClose.
+/*!
+	@remarks Pops "RegLoc" and "RegFile": "HKCU" edits [HKEY_CURRENT_USER\Environment], and "HKLM" edits
+	[HKEY_LOCAL_MACHINE\SYSTEM\CurrentControlSet\Control\Session Manager\Environment] of the file.
+	Needs NSIS 3 plugin callbacks. Sets the error flag on failure.
+ */
+extern "C" void __declspec(dllexport) RegFileOpen(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		ShortString RegLoc;
+		NsisString FilePath;
+
+		bool success = false;
+
+		if (true
+			&& RegLoc.Pop()
+			&& FilePath.Pop()
+			)
+		{
+			RegFile *file = SelectRegFile(RegLoc);
+			success = file != nullptr && file->Open(FilePath, file == &g_hklmRegFile);
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Write the .reg file back if edited, and edit the registry again.
+/*!
+	@remarks Pops "RegLoc". Sets the error flag if the file is not saved: the file is not changed then.
+ */
+extern "C" void __declspec(dllexport) RegFileClose(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ShortString RegLoc;
+
+		bool success = false;
+
+		if (RegLoc.Pop())
+		{
+			RegFile *file = SelectRegFile(RegLoc);
+			success = file != nullptr && file->IsOpen() && file->Close(true);
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Push result of the last EnvVarUpdate, EnvVarUpdateBatch or TransactionCommit call: "changed", "unchanged" or "error".
+extern "C" void __declspec(dllexport) GetLastStatus(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+
+	PushString(StatusText(g_lastStatus));
+}
+
+//! Push stats as a line of "name=value" pairs separated by space.
+/*!
+	@remarks Times are in microseconds, and are measured only while "Stats" option is "On".
+ */
+extern "C" void __declspec(dllexport) GetStats(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		GrowString Result(1024);
+		if (Result.msgbuf != nullptr)
+		{
+			FormatStats(Result);
+		}
+		Result.Push();
+	}
+
+	PluginExit();
+}
+
+//! Set plugin option.
+/*!
+	@remarks Pops "Name" and "Value". Unknown name or value sets the error flag.
+	@li "Broadcast" "Unload": send one WM_SETTINGCHANGE at unload if anything is written.
+	@li "Broadcast" "None": send nothing (default). The script broadcasts by itself.
+	@li "BroadcastTimeout" "ms": timeout per window, 0 for 5000.
+	@li "Normalize" "None": match entries as is, ignoring case (default).
+	@li "Normalize" "Path": also ignore slash direction and trailing separators.
+	@li "Normalize" "Expand": also expand %VAR% of this process before matching.
+	@li "Transaction" "KTM": TransactionCommit writes registry values in one Kernel Transaction Manager transaction.
+	An offline hive or a .reg file is written directly, and restored on failure.
+	@li "Transaction" "Restore": TransactionCommit restores written values on failure (default).
+	@li "Result" "Value": EnvVarUpdate pushes the new value (default), truncated to NSIS string size.
+	@li "Result" "Status": EnvVarUpdate pushes "changed", "unchanged" or "error".
+	@li "Result" "Length": EnvVarUpdate pushes length of the new value.
+	@li "Result" "None": EnvVarUpdate pushes nothing.
+	@li "ResultVar" "R0": EnvVarUpdate writes its result to $R0 instead of pushing. "0" to "9" and "R0" to "R9" are accepted, with or without '$'.
+	@li "ResultVar" "Stack": EnvVarUpdate pushes its result (default).
+	@li "Stats" "On": measure time of reads, edits and writes. "Off" stops (default).
+	@li "StatsLog" "path": append GetStats line to the file at unload, or "" for none.
+ */
+extern "C" void __declspec(dllexport) SetOption(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		ShortString Name;
+		NsisString Value;
+
+		bool success = false;
+
+		if (true
+			&& Name.Pop()
+			&& Value.Pop()
+			)
+		{
+			if (Name.CompareToIgnoreCase(_T("Broadcast")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("Unload")) == 0)
+				{
+					g_broadcast.deferred = true;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("None")) == 0)
+				{
+					g_broadcast.deferred = false;
+					g_broadcast.dirty = false;
+					success = true;
+				}
+			}
+			else if (Name.CompareToIgnoreCase(_T("BroadcastTimeout")) == 0)
+			{
+				g_broadcast.timeoutMs = myatou(Value);
+				success = true;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Normalize")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("None")) == 0)
+				{
+					g_normalizeMode = NormalizeNone;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Path")) == 0)
+				{
+					g_normalizeMode = NormalizePath;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Expand")) == 0)
+				{
+					g_normalizeMode = NormalizeExpand;
+					success = true;
+				}
+			}
+			else if (Name.CompareToIgnoreCase(_T("Result")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("Value")) == 0)
+				{
+					g_resultMode = ResultValue;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Status")) == 0)
+				{
+					g_resultMode = ResultStatus;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Length")) == 0)
+				{
+					g_resultMode = ResultLength;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("None")) == 0)
+				{
+					g_resultMode = ResultNone;
+					success = true;
+				}
+			}
+			else if (Name.CompareToIgnoreCase(_T("ResultVar")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("Stack")) == 0)
+				{
+					g_resultToVar = false;
+					success = true;
+				}
+				else if (ParseUserVariable(Value, g_resultVar))
+				{
+					g_resultToVar = true;
+					success = true;
+				}
+			}
+			else if (Name.CompareToIgnoreCase(_T("Stats")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("On")) == 0)
+				{
+					g_stats.enabled = true;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Off")) == 0)
+				{
+					g_stats.enabled = false;
+					success = true;
+				}
+			}
+			else if (Name.CompareToIgnoreCase(_T("StatsLog")) == 0)
+			{
+				lstrcpyn(g_statsLogPath, Value, MAX_PATH);
+				success = true;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Transaction")) == 0)
+			{
+				if (Value.CompareToIgnoreCase(_T("KTM")) == 0)
+				{
+					g_useKtm = true;
+					success = true;
+				}
+				else if (Value.CompareToIgnoreCase(_T("Restore")) == 0)
+				{
+					g_useKtm = false;
+					success = true;
+				}
+			}
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+	}
+
+	PluginExit();
+}
+
+//! Push a counter: "Broadcasts", "Reads", "Writes", "BytesRead", "BytesWritten", "KeyOpens", "CacheHits", "CacheMisses", "EntriesRemoved", "BytesRemoved", "LastEntriesRemoved", "LastBytesRemoved", "Truncations", "Pushes", "Pops", "StackBytes", "Allocations", "BytesAllocated" or "BytesUsed".
+/*!
+	@remarks Unknown name pushes 0, and sets the error flag.
+ */
+extern "C" void __declspec(dllexport) GetCounter(
+	HWND hwndParent,
+	int string_size,
+	LPTSTR variables,
+	stack_t **stacktop,
+	extra_parameters *extra,
+	...
+)
+{
+	EXDLL_INIT();
+	g_hwndParent = hwndParent;
+	PluginInit(extra);
+
+	{
+		ArenaScope scope(&g_arena);
+
+		ShortString Name;
+
+		size_t value = 0;
+		bool success = Name.Pop();
+
+		if (success)
+		{
+			if (Name.CompareToIgnoreCase(_T("Broadcasts")) == 0)
+			{
+				value = g_broadcast.sent;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Reads")) == 0)
+			{
+				value = g_storeCounters.reads;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Writes")) == 0)
+			{
+				value = g_storeCounters.writes;
+			}
+			else if (Name.CompareToIgnoreCase(_T("BytesRead")) == 0)
+			{
+				value = g_storeCounters.bytesRead;
+			}
+			else if (Name.CompareToIgnoreCase(_T("BytesWritten")) == 0)
+			{
+				value = g_storeCounters.bytesWritten;
+			}
+			else if (Name.CompareToIgnoreCase(_T("KeyOpens")) == 0)
+			{
+				value = g_storeCounters.keyOpens;
+			}
+			else if (Name.CompareToIgnoreCase(_T("CacheHits")) == 0)
+			{
+				value = g_storeCounters.cacheHits;
+			}
+			else if (Name.CompareToIgnoreCase(_T("CacheMisses")) == 0)
+			{
+				value = g_storeCounters.cacheMisses;
+			}
+			else if (Name.CompareToIgnoreCase(_T("EntriesRemoved")) == 0)
+			{
+				value = g_editCounters.entriesRemoved;
+			}
+			else if (Name.CompareToIgnoreCase(_T("BytesRemoved")) == 0)
+			{
+				value = g_editCounters.bytesRemoved;
+			}
+			else if (Name.CompareToIgnoreCase(_T("LastEntriesRemoved")) == 0)
+			{
+				value = g_lastRemoved.entriesRemoved;
+			}
+			else if (Name.CompareToIgnoreCase(_T("LastBytesRemoved")) == 0)
+			{
+				value = g_lastRemoved.bytesRemoved;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Truncations")) == 0)
+			{
+				value = g_truncations;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Pushes")) == 0)
+			{
+				value = g_stackCounters.pushes;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Pops")) == 0)
+			{
+				value = g_stackCounters.pops;
+			}
+			else if (Name.CompareToIgnoreCase(_T("StackBytes")) == 0)
+			{
+				value = g_stackCounters.bytesPushed;
+			}
+			else if (Name.CompareToIgnoreCase(_T("Allocations")) == 0)
+			{
+				value = g_arena.allocations;
+			}
+			else if (Name.CompareToIgnoreCase(_T("BytesAllocated")) == 0)
+			{
+				value = g_arena.bytesAllocated;
+			}
+			else if (Name.CompareToIgnoreCase(_T("BytesUsed")) == 0)
+			{
+				value = g_arena.bytesUsed;
+			}
+			else
+			{
+				success = false;
+			}
+		}
+
+		if (!success)
+		{
+			extra->exec_flags->exec_error++;
+		}
+
+		PushInt(value);
+	}
+
+	PluginExit();
 }
@@ -0,0 +1,41 @@
+//! @file Check.h
+//! @brief CHECK of host tests
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include <windows.h>
+
+#include <cstdio>
+
+//! Report a failed condition, and go on.
+#define CHECK(condition) Host::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace Host
+{
+	//! Number of failed checks.
+	inline int &Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	//! Count and print a failed check.
+	inline bool Check(bool passed, const char *condition, const char *file, int line)
+	{
+		if (!passed)
+		{
+			printf("%s(%d): CHECK failed: %s\n", file, line, condition);
+			Failures()++;
+		}
+		return passed;
+	}
+
+	//! Print summary. Returns exit code of test.
+	inline int Summary(const char *name)
+	{
+		printf("%s: %s build, %d failed\n", name, (sizeof(TCHAR) == 1) ? "ANSI" : "Unicode", Failures());
+		return (Failures() == 0) ? 0 : 1;
+	}
+}
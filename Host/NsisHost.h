@@ -0,0 +1,148 @@
+//! @file NsisHost.h
+//! @brief Fake NSIS exehead: stack, user variables, exec_flags and plugin callbacks, to call plugin exports on a host
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include <windows.h>
+#include <nsis/pluginapi.h>
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+//! Exported function of a plugin DLL
+typedef void (*PluginFunction)(HWND hwndParent, int string_size, LPTSTR variables, stack_t **stacktop, extra_parameters *extra, ...);
+
+//! Declare exported function of EnvVarUpdate.cpp
+#define ENVVARUPDATE_EXPORT(name) extern "C" void name(HWND hwndParent, int string_size, LPTSTR variables, stack_t **stacktop, extra_parameters *extra, ...)
+
+ENVVARUPDATE_EXPORT(EnvVarUpdate);
+ENVVARUPDATE_EXPORT(EnvVarUpdateBatch);
+ENVVARUPDATE_EXPORT(Contains);
+ENVVARUPDATE_EXPORT(IndexOf);
+ENVVARUPDATE_EXPORT(Count);
+ENVVARUPDATE_EXPORT(TransactionBegin);
+ENVVARUPDATE_EXPORT(TransactionAdd);
+ENVVARUPDATE_EXPORT(TransactionCommit);
+ENVVARUPDATE_EXPORT(TransactionAbort);
+ENVVARUPDATE_EXPORT(OfflineHiveOpen);
+ENVVARUPDATE_EXPORT(OfflineHiveClose);
+ENVVARUPDATE_EXPORT(RegFileOpen);
+ENVVARUPDATE_EXPORT(RegFileClose);
+ENVVARUPDATE_EXPORT(GetLastStatus);
+ENVVARUPDATE_EXPORT(GetStats);
+ENVVARUPDATE_EXPORT(SetOption);
+ENVVARUPDATE_EXPORT(GetCounter);
+
+namespace Host
+{
+	//! Calls of the pluginapi.h functions in PluginApi.cpp
+	struct PluginApiCounters
+	{
+		//! pushstring and pushintptr calls
+		size_t pushes;
+
+		//! popstring and popstringn calls returning a string
+		size_t pops;
+
+		//! popstring and popstringn calls on empty stack
+		size_t underflows;
+
+		//! stack entries allocated by pushes, g_stringsize chars each
+		size_t entryAllocs;
+
+		//! bytes of stack entries allocated by pushes
+		size_t entryBytes;
+
+		//! stack entries freed by pops
+		size_t entryFrees;
+
+		//! getuservariable and setuservariable calls
+		size_t variableAccesses;
+	};
+
+	//! counters since start, or since the test cleared them
+	extern PluginApiCounters g_pluginApi;
+
+	//! Installer calling plugin exports, as the NSIS exehead does.
+	/*!
+		@remarks
+		One installer at a time. Its dtor sends NSPIM_UNLOAD to the registered callback, as NSIS does when it unloads the DLL.
+		Strings are pushed and popped through pushstring and popstring of PluginApi.cpp.
+	 */
+	class Installer
+	{
+	public:
+		//! ctor
+		/*!
+			@param stringSize NSIS_MAX_STRLEN of the installer: 1024 by default, or 8192 with the large strings build.
+		 */
+		explicit Installer(int stringSize = 1024);
+
+		//! dtor. Sends NSPIM_UNLOAD, and frees the stack.
+		~Installer();
+
+		//! Push a string, as Push does.
+		void Push(LPCTSTR text);
+
+		//! Pop a string, as Pop does.
+		/*!
+			@return false on empty stack.
+		 */
+		bool Pop(std::basic_string<TCHAR> &text);
+
+		//! Pop a string, or "<empty>" on empty stack.
+		std::basic_string<TCHAR> Pop();
+
+		//! Number of strings on the stack.
+		size_t Depth() const;
+
+		//! Call a plugin export with arguments pushed in reverse order, so that the export pops args[0] first.
+		void Call(PluginFunction function, std::initializer_list<LPCTSTR> args = {});
+
+		//! Value of $0 to $9, $R0 to $R9 and others: INST_0 and so on.
+		std::basic_string<TCHAR> Variable(int index) const;
+
+		//! Set value of a user variable.
+		void SetVariable(int index, LPCTSTR text);
+
+		//! IfErrors: true if the error flag is set, and clears it.
+		bool IfErrors();
+
+		//! Send NSPIM_GUIUNLOAD or NSPIM_UNLOAD to the registered callback.
+		/*!
+			@return false if no callback is registered.
+		 */
+		bool Notify(NSPIM message);
+
+		//! flags seen by exports through extra->exec_flags
+		exec_flags_t flags;
+
+		//! true if the callback is registered by an export
+		bool HasCallback() const;
+
+	private:
+		//! RegisterPluginCallback of extra_parameters
+		static int NSISCALL RegisterPluginCallback(HMODULE module, NSISPLUGINCALLBACK callback);
+
+		//! installer being run
+		static Installer *current;
+
+		//! NSIS_MAX_STRLEN
+		int stringSize;
+
+		//! top of stack
+		stack_t *top;
+
+		//! user variables, stringSize chars each
+		std::vector<TCHAR> variables;
+
+		//! passed to exports
+		extra_parameters extra;
+
+		//! registered callback, or nullptr
+		NSISPLUGINCALLBACK callback;
+	};
+}
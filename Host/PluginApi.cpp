@@ -0,0 +1,248 @@
+//! @file PluginApi.cpp
+//! @brief Stack and variables of nsis/pluginapi.h, as the NSIS exehead does them, for host tests and benchmarks
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "NsisHost.h"
+
+namespace Host
+{
+	PluginApiCounters g_pluginApi;
+}
+
+using namespace Host;
+
+extern "C"
+{
+	HINSTANCE g_hInstance;
+
+	unsigned int g_stringsize;
+	stack_t **g_stacktop;
+	LPTSTR g_variables;
+
+	void NSISCALL pushstring(LPCTSTR str)
+	{
+		if (g_stacktop == nullptr)
+		{
+			return;
+		}
+		// as the exehead does: a whole g_stringsize entry for any text
+		const size_t bytes = sizeof(stack_t) + g_stringsize * sizeof(TCHAR);
+		stack_t *th = (stack_t *)GlobalAlloc(GPTR, bytes);
+		g_pluginApi.pushes++;
+		g_pluginApi.entryAllocs++;
+		g_pluginApi.entryBytes += bytes;
+		lstrcpyn(th->text, str, g_stringsize);
+		th->next = *g_stacktop;
+		*g_stacktop = th;
+	}
+
+	int NSISCALL popstringn(LPTSTR str, int maxlen)
+	{
+		if (g_stacktop == nullptr || *g_stacktop == nullptr)
+		{
+			g_pluginApi.underflows++;
+			return 1;
+		}
+		g_pluginApi.pops++;
+		g_pluginApi.entryFrees++;
+		stack_t *th = *g_stacktop;
+		if (str != nullptr)
+		{
+			lstrcpyn(str, th->text, (maxlen != 0) ? maxlen : g_stringsize);
+		}
+		*g_stacktop = th->next;
+		GlobalFree((HGLOBAL)th);
+		return 0;
+	}
+
+	int NSISCALL popstring(LPTSTR str)
+	{
+		return popstringn(str, 0);
+	}
+
+	INT_PTR NSISCALL nsishelper_str_to_ptr(LPCTSTR s)
+	{
+		INT_PTR v = 0;
+		const bool negative = *s == _T('-');
+		if (negative)
+		{
+			s++;
+		}
+		for (; *s >= _T('0') && *s <= _T('9'); s++)
+		{
+			v = v * 10 + (*s - _T('0'));
+		}
+		return negative ? -v : v;
+	}
+
+	unsigned int NSISCALL myatou(LPCTSTR s)
+	{
+		unsigned int v = 0;
+		for (; *s >= _T('0') && *s <= _T('9'); s++)
+		{
+			v = v * 10 + (*s - _T('0'));
+		}
+		return v;
+	}
+
+	void NSISCALL pushintptr(INT_PTR value)
+	{
+		TCHAR buffer[32];
+		wsprintf(buffer, _T("%ld"), static_cast<long>(value));
+		pushstring(buffer);
+	}
+
+	INT_PTR NSISCALL popintptr()
+	{
+		TCHAR buffer[32];
+		if (popstringn(buffer, 32) != 0)
+		{
+			return 0;
+		}
+		return nsishelper_str_to_ptr(buffer);
+	}
+
+	LPTSTR NSISCALL getuservariable(const int varnum)
+	{
+		g_pluginApi.variableAccesses++;
+		if (varnum < 0 || varnum >= __INST_LAST)
+		{
+			return nullptr;
+		}
+		return g_variables + varnum * g_stringsize;
+	}
+
+	void NSISCALL setuservariable(const int varnum, LPCTSTR var)
+	{
+		g_pluginApi.variableAccesses++;
+		if (var != nullptr && varnum >= 0 && varnum < __INST_LAST)
+		{
+			lstrcpyn(g_variables + varnum * g_stringsize, var, g_stringsize);
+		}
+	}
+}
+
+namespace Host
+{
+	Installer *Installer::current = nullptr;
+
+	Installer::Installer(int stringSize) : stringSize(stringSize), top(nullptr), variables(__INST_LAST * stringSize), callback(nullptr)
+	{
+		memset(&flags, 0, sizeof(flags));
+		flags.plugin_api_version = NSISPIAPIVER_CURR;
+		memset(&extra, 0, sizeof(extra));
+		extra.exec_flags = &flags;
+		extra.RegisterPluginCallback = RegisterPluginCallback;
+		current = this;
+	}
+
+	Installer::~Installer()
+	{
+		Notify(NSPIM_UNLOAD);
+		g_stringsize = stringSize;
+		g_stacktop = &top;
+		while (popstring(nullptr) == 0)
+		{
+		}
+		g_stacktop = nullptr;
+		current = nullptr;
+	}
+
+	void Installer::Push(LPCTSTR text)
+	{
+		g_stringsize = stringSize;
+		g_stacktop = &top;
+		pushstring(text);
+	}
+
+	bool Installer::Pop(std::basic_string<TCHAR> &text)
+	{
+		std::vector<TCHAR> buffer(stringSize);
+		g_stringsize = stringSize;
+		g_stacktop = &top;
+		if (popstring(buffer.data()) != 0)
+		{
+			return false;
+		}
+		text = buffer.data();
+		return true;
+	}
+
+	std::basic_string<TCHAR> Installer::Pop()
+	{
+		std::basic_string<TCHAR> text;
+		return Pop(text) ? text : _T("<empty>");
+	}
+
+	size_t Installer::Depth() const
+	{
+		size_t depth = 0;
+		for (const stack_t *entry = top; entry != nullptr; entry = entry->next)
+		{
+			depth++;
+		}
+		return depth;
+	}
+
+	void Installer::Call(PluginFunction function, std::initializer_list<LPCTSTR> args)
+	{
+		for (auto arg = args.end(); arg != args.begin(); )
+		{
+			Push(*--arg);
+		}
+		current = this;
+		function(nullptr, stringSize, variables.data(), &top, &extra);
+	}
+
+	std::basic_string<TCHAR> Installer::Variable(int index) const
+	{
+		return &variables[index * stringSize];
+	}
+
+	void Installer::SetVariable(int index, LPCTSTR text)
+	{
+		lstrcpyn(&variables[index * stringSize], text, stringSize);
+	}
+
+	bool Installer::IfErrors()
+	{
+		const bool error = flags.exec_error != 0;
+		flags.exec_error = 0;
+		return error;
+	}
+
+	bool Installer::Notify(NSPIM message)
+	{
+		if (callback == nullptr)
+		{
+			return false;
+		}
+		NSISPLUGINCALLBACK notified = callback;
+		if (message == NSPIM_UNLOAD)
+		{
+			callback = nullptr;
+		}
+		notified(message);
+		return true;
+	}
+
+	bool Installer::HasCallback() const
+	{
+		return callback != nullptr;
+	}
+
+	int NSISCALL Installer::RegisterPluginCallback(HMODULE, NSISPLUGINCALLBACK callback)
+	{
+		if (current == nullptr)
+		{
+			return -1;
+		}
+		if (current->callback == callback)
+		{
+			return 1;
+		}
+		current->callback = callback;
+		return 0;
+	}
+}
@@ -0,0 +1,961 @@
+//! @file Win32.cpp
+//! @brief Win32 emulation over the C++ standard library, for host tests and benchmarks
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Win32Host.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <cwctype>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <sys/stat.h>
+#include <time.h>
+
+namespace Host
+{
+	Win32Counters g_win32;
+
+	//! A registry value: type, and data as stored by RegSetValueEx
+	struct RegValue
+	{
+		DWORD type;
+		std::vector<BYTE> data;
+	};
+
+	//! Value names in upper case, as the registry ignores case.
+	typedef std::map<String, RegValue> RegValues;
+
+	//! HKCU and HKLM environment keys
+	std::map<HKEY, RegValues> g_registry;
+
+	//! writes of the KTM transaction, until CommitTransaction. A value without data is deleted.
+	std::map<HKEY, std::map<String, RegValue *>> g_staged;
+
+	//! last write time of each key, incremented by each write
+	std::map<HKEY, DWORD> g_writeTimes;
+
+	//! value replaced after its size is queried, by RegistryGrowOnQuery
+	HKEY g_growRoot;
+	String g_growName;
+	String g_grownValue;
+
+	//! value name whose writes fail
+	String g_failWrite;
+
+	//! true if keys may not be opened for write, as HKLM for a standard user
+	bool g_readOnly;
+
+	//! true if ktmw32.dll loads
+	bool g_ktmAvailable;
+
+	//! true if CommitTransaction succeeds
+	bool g_ktmCommitSucceeds = true;
+
+	//! CommitTransaction and RollbackTransaction calls
+	size_t g_ktmCommits, g_ktmRollbacks;
+
+	//! process environment, names in upper case
+	std::map<String, String> g_environment;
+
+	//! directories added by DirectoryPut, in upper case
+	std::set<String> g_directories;
+
+	//! last error of this thread
+	thread_local DWORD g_lastError;
+
+	//! GlobalAlloc may be called from worker threads.
+	std::mutex g_allocLock;
+
+	//! Marks handles of keys opened in the KTM transaction.
+	const ULONG_PTR TransactedKey = 0x100;
+
+	//! handle of the KTM transaction
+	HANDLE const TransactionHandle = reinterpret_cast<HANDLE>(static_cast<ULONG_PTR>(0x7001));
+
+	//! handles of fake advapi32.dll and ktmw32.dll
+	HMODULE const Advapi32Module = reinterpret_cast<HMODULE>(static_cast<ULONG_PTR>(0x7002));
+	HMODULE const Ktmw32Module = reinterpret_cast<HMODULE>(static_cast<ULONG_PTR>(0x7003));
+
+	//! Open file behind a HANDLE.
+	struct FileHandle
+	{
+		FILE *stream;
+	};
+
+	template <class Char>
+	Char FoldChar(Char c)
+	{
+		return (c >= 'a' && c <= 'z') ? static_cast<Char>(c - 'a' + 'A') : c;
+	}
+
+	template <>
+	wchar_t FoldChar<wchar_t>(wchar_t c)
+	{
+		return static_cast<wchar_t>(towupper(c));
+	}
+
+	String Upper(LPCTSTR text)
+	{
+		String upper(text);
+		for (TCHAR &c : upper)
+		{
+			c = FoldChar(c);
+		}
+		return upper;
+	}
+
+	template <class Char>
+	std::string Narrow(const Char *text)
+	{
+		std::string narrow;
+		for (; *text != 0; text++)
+		{
+			narrow += static_cast<char>(*text);
+		}
+		return narrow;
+	}
+
+	HKEY RootOf(HKEY key)
+	{
+		return reinterpret_cast<HKEY>(reinterpret_cast<ULONG_PTR>(key) & ~TransactedKey);
+	}
+
+	bool IsTransacted(HKEY key)
+	{
+		return (reinterpret_cast<ULONG_PTR>(key) & TransactedKey) != 0;
+	}
+
+	void Touch(HKEY root)
+	{
+		g_writeTimes[root]++;
+	}
+
+	//! Forget writes of the KTM transaction.
+	void DiscardStaged()
+	{
+		for (auto &key : g_staged)
+		{
+			for (auto &value : key.second)
+			{
+				delete value.second;
+			}
+		}
+		g_staged.clear();
+	}
+
+	void RegistryClear()
+	{
+		g_registry.clear();
+		DiscardStaged();
+		g_writeTimes.clear();
+		g_growName.clear();
+	}
+
+	void RegistryPut(HKEY root, LPCTSTR name, DWORD type, const String &value)
+	{
+		RegValue &stored = g_registry[root][Upper(name)];
+		stored.type = type;
+		const BYTE *bytes = reinterpret_cast<const BYTE *>(value.c_str());
+		stored.data.assign(bytes, bytes + (value.size() + 1) * sizeof(TCHAR));
+		Touch(root);
+	}
+
+	bool RegistryGet(HKEY root, LPCTSTR name, DWORD &type, String &value)
+	{
+		auto values = g_registry.find(root);
+		if (values == g_registry.end())
+		{
+			return false;
+		}
+		auto found = values->second.find(Upper(name));
+		if (found == values->second.end())
+		{
+			return false;
+		}
+		type = found->second.type;
+		const TCHAR *text = reinterpret_cast<const TCHAR *>(found->second.data.data());
+		size_t count = found->second.data.size() / sizeof(TCHAR);
+		while (count != 0 && text[count - 1] == 0)
+		{
+			count--;
+		}
+		value.assign(text, count);
+		return true;
+	}
+
+	void RegistryGrowOnQuery(HKEY root, LPCTSTR name, const String &grown)
+	{
+		g_growRoot = root;
+		g_growName = Upper(name);
+		g_grownValue = grown;
+	}
+
+	void RegistryFailWrite(LPCTSTR name)
+	{
+		g_failWrite = (name == nullptr) ? String() : Upper(name);
+	}
+
+	void RegistryReadOnly(bool readOnly)
+	{
+		g_readOnly = readOnly;
+	}
+
+	void KtmSetup(bool available, bool commitSucceeds)
+	{
+		g_ktmAvailable = available;
+		g_ktmCommitSucceeds = commitSucceeds;
+		g_ktmCommits = 0;
+		g_ktmRollbacks = 0;
+	}
+
+	void KtmCounts(size_t &commits, size_t &rollbacks)
+	{
+		commits = g_ktmCommits;
+		rollbacks = g_ktmRollbacks;
+	}
+
+	void EnvironmentPut(LPCTSTR name, LPCTSTR value)
+	{
+		if (value == nullptr)
+		{
+			g_environment.erase(Upper(name));
+		}
+		else
+		{
+			g_environment[Upper(name)] = value;
+		}
+	}
+
+	void DirectoryPut(LPCTSTR path)
+	{
+		g_directories.insert(Upper(path));
+	}
+
+	void DirectoryClear()
+	{
+		g_directories.clear();
+	}
+
+	//! Find a value, staged writes first for a transacted key.
+	const RegValue *FindValue(HKEY key, LPCTSTR name)
+	{
+		const HKEY root = RootOf(key);
+		const String upper = Upper((name == nullptr) ? _T("") : name);
+		if (IsTransacted(key))
+		{
+			auto staged = g_staged[root].find(upper);
+			if (staged != g_staged[root].end())
+			{
+				return staged->second->data.empty() ? nullptr : staged->second;
+			}
+		}
+		auto found = g_registry[root].find(upper);
+		return (found == g_registry[root].end()) ? nullptr : &found->second;
+	}
+
+	//! Write or delete (data == nullptr) a value, or stage it for a transacted key.
+	LSTATUS WriteValue(HKEY key, LPCTSTR name, DWORD type, const BYTE *data, DWORD size)
+	{
+		const HKEY root = RootOf(key);
+		const String upper = Upper((name == nullptr) ? _T("") : name);
+		g_win32.regWrites++;
+		if (!g_failWrite.empty() && g_failWrite == upper)
+		{
+			return ERROR_ACCESS_DENIED;
+		}
+		if (IsTransacted(key))
+		{
+			RegValue *&staged = g_staged[root][upper];
+			if (staged == nullptr)
+			{
+				staged = new RegValue();
+			}
+			staged->type = type;
+			staged->data.assign(data, data + ((data == nullptr) ? 0 : size));
+			return ERROR_SUCCESS;
+		}
+		if (data == nullptr)
+		{
+			if (g_registry[root].erase(upper) == 0)
+			{
+				return ERROR_FILE_NOT_FOUND;
+			}
+		}
+		else
+		{
+			RegValue &stored = g_registry[root][upper];
+			stored.type = type;
+			stored.data.assign(data, data + size);
+		}
+		Touch(root);
+		return ERROR_SUCCESS;
+	}
+
+	LSTATUS WINAPI FakeRegCreateKeyTransacted(HKEY hKey, LPCTSTR, DWORD, LPTSTR, DWORD, REGSAM, LPSECURITY_ATTRIBUTES, PHKEY phkResult, LPDWORD, HANDLE hTransaction, PVOID)
+	{
+		if (hTransaction != TransactionHandle)
+		{
+			return ERROR_ACCESS_DENIED;
+		}
+		g_win32.regOpens++;
+		*phkResult = reinterpret_cast<HKEY>(reinterpret_cast<ULONG_PTR>(hKey) | TransactedKey);
+		return ERROR_SUCCESS;
+	}
+
+	HANDLE WINAPI FakeCreateTransaction(LPSECURITY_ATTRIBUTES, LPGUID, DWORD, DWORD, DWORD, DWORD, LPWSTR)
+	{
+		return TransactionHandle;
+	}
+
+	BOOL WINAPI FakeCommitTransaction(HANDLE)
+	{
+		g_ktmCommits++;
+		if (!g_ktmCommitSucceeds)
+		{
+			return FALSE;
+		}
+		for (auto &key : g_staged)
+		{
+			for (auto &value : key.second)
+			{
+				if (value.second->data.empty())
+				{
+					g_registry[key.first].erase(value.first);
+				}
+				else
+				{
+					g_registry[key.first][value.first] = *value.second;
+				}
+			}
+			Touch(key.first);
+		}
+		DiscardStaged();
+		return TRUE;
+	}
+
+	BOOL WINAPI FakeRollbackTransaction(HANDLE)
+	{
+		g_ktmRollbacks++;
+		DiscardStaged();
+		return TRUE;
+	}
+
+	//! Look up a variable of this process.
+	bool FindVariable(const String &name, String &value)
+	{
+		auto found = g_environment.find(Upper(name.c_str()));
+		if (found == g_environment.end())
+		{
+			return false;
+		}
+		value = found->second;
+		return true;
+	}
+
+	HANDLE OpenFile(const std::string &path, DWORD access, DWORD disposition)
+	{
+		const char *mode = "rb";
+		if ((access & FILE_APPEND_DATA) != 0)
+		{
+			mode = "ab";
+		}
+		else if ((access & GENERIC_WRITE) != 0)
+		{
+			mode = (disposition == CREATE_ALWAYS) ? "wb" : "r+b";
+		}
+		FILE *stream = fopen(path.c_str(), mode);
+		if (stream == nullptr && disposition == OPEN_ALWAYS)
+		{
+			stream = fopen(path.c_str(), "w+b");
+		}
+		if (stream == nullptr)
+		{
+			g_lastError = (errno == ENOENT) ? ERROR_FILE_NOT_FOUND : ERROR_ACCESS_DENIED;
+			return INVALID_HANDLE_VALUE;
+		}
+		FileHandle *file = new FileHandle();
+		file->stream = stream;
+		return file;
+	}
+
+	FILE *StreamOf(HANDLE handle)
+	{
+		return static_cast<FileHandle *>(handle)->stream;
+	}
+
+	template <class Char>
+	int Compare(const Char *a, int countA, const Char *b, int countB, bool ignoreCase)
+	{
+		const size_t lenA = (countA < 0) ? std::char_traits<Char>::length(a) : static_cast<size_t>(countA);
+		const size_t lenB = (countB < 0) ? std::char_traits<Char>::length(b) : static_cast<size_t>(countB);
+		for (size_t index = 0; index < lenA && index < lenB; index++)
+		{
+			const Char x = ignoreCase ? FoldChar(a[index]) : a[index];
+			const Char y = ignoreCase ? FoldChar(b[index]) : b[index];
+			if (x != y)
+			{
+				return (static_cast<unsigned>(x) < static_cast<unsigned>(y)) ? -1 : 1;
+			}
+		}
+		return (lenA < lenB) ? -1 : (lenA > lenB) ? 1 : 0;
+	}
+
+	template <class Char>
+	Char *Copy(Char *dest, const Char *src, int maxLength)
+	{
+		int index = 0;
+		for (; index + 1 < maxLength && src[index] != 0; index++)
+		{
+			dest[index] = src[index];
+		}
+		if (maxLength > 0)
+		{
+			dest[index] = 0;
+		}
+		return dest;
+	}
+}
+
+using namespace Host;
+
+extern "C"
+{
+	//! Allocation header, keeping the size for GlobalFree.
+	struct AllocHeader
+	{
+		size_t size;
+		size_t padding;
+	};
+
+	HGLOBAL GlobalAlloc(UINT uFlags, size_t dwBytes)
+	{
+		AllocHeader *header = static_cast<AllocHeader *>(malloc(sizeof(AllocHeader) + dwBytes));
+		if (header == nullptr)
+		{
+			return nullptr;
+		}
+		header->size = dwBytes;
+		{
+			std::lock_guard<std::mutex> lock(g_allocLock);
+			g_win32.globalAllocs++;
+			g_win32.bytesAllocated += dwBytes;
+			g_win32.bytesLive += dwBytes;
+		}
+		// garbage unless asked, as GlobalAlloc does not promise zeroes
+		memset(header + 1, ((uFlags & GMEM_ZEROINIT) != 0) ? 0 : 0xCD, dwBytes);
+		return header + 1;
+	}
+
+	HGLOBAL GlobalFree(HGLOBAL hMem)
+	{
+		if (hMem != nullptr)
+		{
+			AllocHeader *header = static_cast<AllocHeader *>(hMem) - 1;
+			{
+				std::lock_guard<std::mutex> lock(g_allocLock);
+				g_win32.globalFrees++;
+				g_win32.bytesLive -= header->size;
+			}
+			free(header);
+		}
+		return nullptr;
+	}
+
+	int lstrlenA(LPCSTR lpString)
+	{
+		return (lpString == nullptr) ? 0 : static_cast<int>(strlen(lpString));
+	}
+
+	int lstrlenW(LPCWSTR lpString)
+	{
+		return (lpString == nullptr) ? 0 : static_cast<int>(wcslen(lpString));
+	}
+
+	LPSTR lstrcpyA(LPSTR lpString1, LPCSTR lpString2)
+	{
+		return strcpy(lpString1, lpString2);
+	}
+
+	LPWSTR lstrcpyW(LPWSTR lpString1, LPCWSTR lpString2)
+	{
+		return wcscpy(lpString1, lpString2);
+	}
+
+	LPSTR lstrcpynA(LPSTR lpString1, LPCSTR lpString2, int iMaxLength)
+	{
+		return Copy(lpString1, lpString2, iMaxLength);
+	}
+
+	LPWSTR lstrcpynW(LPWSTR lpString1, LPCWSTR lpString2, int iMaxLength)
+	{
+		return Copy(lpString1, lpString2, iMaxLength);
+	}
+
+	LPSTR lstrcatA(LPSTR lpString1, LPCSTR lpString2)
+	{
+		return strcat(lpString1, lpString2);
+	}
+
+	LPWSTR lstrcatW(LPWSTR lpString1, LPCWSTR lpString2)
+	{
+		return wcscat(lpString1, lpString2);
+	}
+
+	int lstrcmpA(LPCSTR lpString1, LPCSTR lpString2)
+	{
+		return Compare(lpString1, -1, lpString2, -1, false);
+	}
+
+	int lstrcmpW(LPCWSTR lpString1, LPCWSTR lpString2)
+	{
+		return Compare(lpString1, -1, lpString2, -1, false);
+	}
+
+	int lstrcmpiA(LPCSTR lpString1, LPCSTR lpString2)
+	{
+		return Compare(lpString1, -1, lpString2, -1, true);
+	}
+
+	int lstrcmpiW(LPCWSTR lpString1, LPCWSTR lpString2)
+	{
+		return Compare(lpString1, -1, lpString2, -1, true);
+	}
+
+	int wsprintfA(LPSTR buffer, LPCSTR format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+		// wsprintf output is limited to 1024 chars
+		const int count = vsnprintf(buffer, 1024, format, args);
+		va_end(args);
+		return count;
+	}
+
+	int wsprintfW(LPWSTR buffer, LPCWSTR format, ...)
+	{
+		// %s of wsprintfW is a wide string, as %ls of swprintf
+		std::wstring hostFormat;
+		for (LPCWSTR scan = format; *scan != 0; scan++)
+		{
+			hostFormat += *scan;
+			if (*scan == L'%' && scan[1] == L's')
+			{
+				hostFormat += L'l';
+			}
+			else if (*scan == L'%' && scan[1] == L'%')
+			{
+				hostFormat += *++scan;
+			}
+		}
+		va_list args;
+		va_start(args, format);
+		const int count = vswprintf(buffer, 1024, hostFormat.c_str(), args);
+		va_end(args);
+		return count;
+	}
+
+	LPSTR CharUpperA(LPSTR lpsz)
+	{
+		const ULONG_PTR value = reinterpret_cast<ULONG_PTR>(lpsz);
+		if (value < 0x10000)
+		{
+			return reinterpret_cast<LPSTR>(static_cast<ULONG_PTR>(static_cast<BYTE>(FoldChar(static_cast<char>(value)))));
+		}
+		for (LPSTR scan = lpsz; *scan != 0; scan++)
+		{
+			*scan = FoldChar(*scan);
+		}
+		return lpsz;
+	}
+
+	LPWSTR CharUpperW(LPWSTR lpsz)
+	{
+		const ULONG_PTR value = reinterpret_cast<ULONG_PTR>(lpsz);
+		if (value < 0x10000)
+		{
+			return reinterpret_cast<LPWSTR>(static_cast<ULONG_PTR>(FoldChar(static_cast<wchar_t>(value))));
+		}
+		for (LPWSTR scan = lpsz; *scan != 0; scan++)
+		{
+			*scan = FoldChar(*scan);
+		}
+		return lpsz;
+	}
+
+	BOOL IsDBCSLeadByte(BYTE)
+	{
+		// the host code page is single byte
+		return FALSE;
+	}
+
+	int CompareStringA(DWORD, DWORD dwCmpFlags, LPCSTR lpString1, int cchCount1, LPCSTR lpString2, int cchCount2)
+	{
+		return 2 + Compare(lpString1, cchCount1, lpString2, cchCount2, (dwCmpFlags & NORM_IGNORECASE) != 0);
+	}
+
+	int CompareStringW(DWORD, DWORD dwCmpFlags, LPCWSTR lpString1, int cchCount1, LPCWSTR lpString2, int cchCount2)
+	{
+		return 2 + Compare(lpString1, cchCount1, lpString2, cchCount2, (dwCmpFlags & NORM_IGNORECASE) != 0);
+	}
+
+	int MultiByteToWideChar(UINT, DWORD, LPCSTR lpMultiByteStr, int cbMultiByte, LPWSTR lpWideCharStr, int cchWideChar)
+	{
+		// the host code page is Latin-1
+		const int count = (cbMultiByte < 0) ? static_cast<int>(strlen(lpMultiByteStr)) + 1 : cbMultiByte;
+		if (cchWideChar == 0)
+		{
+			return count;
+		}
+		if (cchWideChar < count)
+		{
+			return 0;
+		}
+		for (int index = 0; index < count; index++)
+		{
+			lpWideCharStr[index] = static_cast<BYTE>(lpMultiByteStr[index]);
+		}
+		return count;
+	}
+
+	int WideCharToMultiByte(UINT, DWORD, LPCWSTR lpWideCharStr, int cchWideChar, LPSTR lpMultiByteStr, int cbMultiByte, LPCSTR, BOOL *lpUsedDefaultChar)
+	{
+		const int count = (cchWideChar < 0) ? static_cast<int>(wcslen(lpWideCharStr)) + 1 : cchWideChar;
+		if (cbMultiByte == 0)
+		{
+			return count;
+		}
+		if (cbMultiByte < count)
+		{
+			return 0;
+		}
+		bool usedDefault = false;
+		for (int index = 0; index < count; index++)
+		{
+			const wchar_t c = lpWideCharStr[index];
+			usedDefault |= c > 0xFF;
+			lpMultiByteStr[index] = (c > 0xFF) ? '?' : static_cast<char>(c);
+		}
+		if (lpUsedDefaultChar != nullptr)
+		{
+			*lpUsedDefaultChar = usedDefault;
+		}
+		return count;
+	}
+
+	int MulDiv(int nNumber, int nNumerator, int nDenominator)
+	{
+		if (nDenominator == 0)
+		{
+			return -1;
+		}
+		const long long product = static_cast<long long>(nNumber) * nNumerator;
+		const long long result = (product + ((product < 0) != (nDenominator < 0) ? -nDenominator / 2 : nDenominator / 2)) / nDenominator;
+		return (result > MAXLONG || result < -MAXLONG) ? -1 : static_cast<int>(result);
+	}
+
+	LSTATUS RegOpenKeyEx(HKEY hKey, LPCTSTR, DWORD, REGSAM samDesired, PHKEY phkResult)
+	{
+		if (g_readOnly && (samDesired & KEY_SET_VALUE) != 0)
+		{
+			return ERROR_ACCESS_DENIED;
+		}
+		g_win32.regOpens++;
+		*phkResult = hKey;
+		return ERROR_SUCCESS;
+	}
+
+	LSTATUS RegCreateKeyEx(HKEY hKey, LPCTSTR, DWORD, LPTSTR, DWORD, REGSAM samDesired, LPSECURITY_ATTRIBUTES, PHKEY phkResult, LPDWORD)
+	{
+		if (g_readOnly && (samDesired & KEY_SET_VALUE) != 0)
+		{
+			return ERROR_ACCESS_DENIED;
+		}
+		g_win32.regOpens++;
+		*phkResult = hKey;
+		return ERROR_SUCCESS;
+	}
+
+	LSTATUS RegQueryValueEx(HKEY hKey, LPCTSTR lpValueName, LPDWORD, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData)
+	{
+		g_win32.regQueries++;
+		const RegValue *value = FindValue(hKey, lpValueName);
+		if (value == nullptr)
+		{
+			return ERROR_FILE_NOT_FOUND;
+		}
+		if (lpType != nullptr)
+		{
+			*lpType = value->type;
+		}
+		const DWORD size = static_cast<DWORD>(value->data.size());
+		if (lpData == nullptr)
+		{
+			*lpcbData = size;
+			if (!g_growName.empty() && g_growRoot == RootOf(hKey) && g_growName == Upper(lpValueName))
+			{
+				g_growName.clear();
+				RegistryPut(g_growRoot, lpValueName, value->type, g_grownValue);
+			}
+			return ERROR_SUCCESS;
+		}
+		if (*lpcbData < size)
+		{
+			*lpcbData = size;
+			return ERROR_MORE_DATA;
+		}
+		memcpy(lpData, value->data.data(), size);
+		*lpcbData = size;
+		return ERROR_SUCCESS;
+	}
+
+	LSTATUS RegSetValueEx(HKEY hKey, LPCTSTR lpValueName, DWORD, DWORD dwType, const BYTE *lpData, DWORD cbData)
+	{
+		static const BYTE none = 0;
+		return WriteValue(hKey, lpValueName, dwType, (lpData == nullptr) ? &none : lpData, cbData);
+	}
+
+	LSTATUS RegDeleteValue(HKEY hKey, LPCTSTR lpValueName)
+	{
+		return WriteValue(hKey, lpValueName, REG_NONE, nullptr, 0);
+	}
+
+	LSTATUS RegQueryInfoKey(HKEY hKey, LPTSTR, LPDWORD, LPDWORD, LPDWORD, LPDWORD, LPDWORD, LPDWORD, LPDWORD, LPDWORD, LPDWORD, PFILETIME lpftLastWriteTime)
+	{
+		if (lpftLastWriteTime != nullptr)
+		{
+			lpftLastWriteTime->dwLowDateTime = g_writeTimes[RootOf(hKey)];
+			lpftLastWriteTime->dwHighDateTime = 0;
+		}
+		return ERROR_SUCCESS;
+	}
+
+	LSTATUS RegCloseKey(HKEY)
+	{
+		g_win32.regCloses++;
+		return ERROR_SUCCESS;
+	}
+
+	LONG CompareFileTime(const FILETIME *lpFileTime1, const FILETIME *lpFileTime2)
+	{
+		const unsigned long long time1 = (static_cast<unsigned long long>(lpFileTime1->dwHighDateTime) << 32) | lpFileTime1->dwLowDateTime;
+		const unsigned long long time2 = (static_cast<unsigned long long>(lpFileTime2->dwHighDateTime) << 32) | lpFileTime2->dwLowDateTime;
+		return (time1 < time2) ? -1 : (time1 > time2) ? 1 : 0;
+	}
+
+	LRESULT SendMessageTimeout(HWND, UINT, WPARAM, LPARAM, UINT, UINT, PDWORD_PTR lpdwResult)
+	{
+		g_win32.broadcasts++;
+		if (lpdwResult != nullptr)
+		{
+			*lpdwResult = 0;
+		}
+		return 1;
+	}
+
+	DWORD GetEnvironmentVariable(LPCTSTR lpName, LPTSTR lpBuffer, DWORD nSize)
+	{
+		String value;
+		if (!FindVariable(lpName, value))
+		{
+			g_lastError = ERROR_FILE_NOT_FOUND;
+			return 0;
+		}
+		if (nSize <= value.size())
+		{
+			return static_cast<DWORD>(value.size() + 1);
+		}
+		memcpy(lpBuffer, value.c_str(), (value.size() + 1) * sizeof(TCHAR));
+		return static_cast<DWORD>(value.size());
+	}
+
+	DWORD ExpandEnvironmentStrings(LPCTSTR lpSrc, LPTSTR lpDst, DWORD nSize)
+	{
+		const String source(lpSrc);
+		String expanded;
+		size_t index = 0;
+		while (index < source.size())
+		{
+			const size_t close = (source[index] == _T('%')) ? source.find(_T('%'), index + 1) : String::npos;
+			String value;
+			if (close != String::npos && FindVariable(source.substr(index + 1, close - index - 1), value))
+			{
+				expanded += value;
+				index = close + 1;
+			}
+			else
+			{
+				expanded += source[index++];
+			}
+		}
+		if (nSize > expanded.size())
+		{
+			memcpy(lpDst, expanded.c_str(), (expanded.size() + 1) * sizeof(TCHAR));
+		}
+		return static_cast<DWORD>(expanded.size() + 1);
+	}
+
+	DWORD GetFileAttributes(LPCTSTR lpFileName)
+	{
+		g_win32.fileAttributes++;
+		if (g_directories.count(Upper(lpFileName)) != 0)
+		{
+			return FILE_ATTRIBUTE_DIRECTORY;
+		}
+		struct stat status;
+		if (stat(Narrow(lpFileName).c_str(), &status) != 0)
+		{
+			g_lastError = ERROR_FILE_NOT_FOUND;
+			return INVALID_FILE_ATTRIBUTES;
+		}
+		return S_ISDIR(status.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+	}
+
+	HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD, LPSECURITY_ATTRIBUTES, DWORD dwCreationDisposition, DWORD, HANDLE)
+	{
+		return OpenFile(lpFileName, dwDesiredAccess, dwCreationDisposition);
+	}
+
+	HANDLE CreateFileW(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD, LPSECURITY_ATTRIBUTES, DWORD dwCreationDisposition, DWORD, HANDLE)
+	{
+		return OpenFile(Narrow(lpFileName), dwDesiredAccess, dwCreationDisposition);
+	}
+
+	BOOL ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, LPOVERLAPPED)
+	{
+		*lpNumberOfBytesRead = static_cast<DWORD>(fread(lpBuffer, 1, nNumberOfBytesToRead, StreamOf(hFile)));
+		return !ferror(StreamOf(hFile));
+	}
+
+	BOOL WriteFile(HANDLE hFile, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrite, LPDWORD lpNumberOfBytesWritten, LPOVERLAPPED)
+	{
+		*lpNumberOfBytesWritten = static_cast<DWORD>(fwrite(lpBuffer, 1, nNumberOfBytesToWrite, StreamOf(hFile)));
+		return *lpNumberOfBytesWritten == nNumberOfBytesToWrite;
+	}
+
+	DWORD GetFileSize(HANDLE hFile, LPDWORD lpFileSizeHigh)
+	{
+		FILE *stream = StreamOf(hFile);
+		const long position = ftell(stream);
+		fseek(stream, 0, SEEK_END);
+		const long size = ftell(stream);
+		fseek(stream, position, SEEK_SET);
+		if (lpFileSizeHigh != nullptr)
+		{
+			*lpFileSizeHigh = 0;
+		}
+		return static_cast<DWORD>(size);
+	}
+
+	DWORD SetFilePointer(HANDLE hFile, LONG lDistanceToMove, LONG *, DWORD dwMoveMethod)
+	{
+		FILE *stream = StreamOf(hFile);
+		fseek(stream, lDistanceToMove, (dwMoveMethod == FILE_END) ? SEEK_END : (dwMoveMethod == FILE_BEGIN) ? SEEK_SET : SEEK_CUR);
+		return static_cast<DWORD>(ftell(stream));
+	}
+
+	BOOL SetEndOfFile(HANDLE)
+	{
+		return TRUE;
+	}
+
+	BOOL CloseHandle(HANDLE hObject)
+	{
+		if (hObject == TransactionHandle)
+		{
+			return TRUE;
+		}
+		FileHandle *file = static_cast<FileHandle *>(hObject);
+		const bool closed = fclose(file->stream) == 0;
+		delete file;
+		return closed;
+	}
+
+	BOOL MoveFileExW(LPCWSTR lpExistingFileName, LPCWSTR lpNewFileName, DWORD)
+	{
+		return rename(Narrow(lpExistingFileName).c_str(), Narrow(lpNewFileName).c_str()) == 0;
+	}
+
+	BOOL DeleteFileW(LPCWSTR lpFileName)
+	{
+		return remove(Narrow(lpFileName).c_str()) == 0;
+	}
+
+	BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount)
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		lpPerformanceCount->QuadPart = static_cast<LONGLONG>(now.tv_sec) * 1000000000 + now.tv_nsec;
+		return TRUE;
+	}
+
+	BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency)
+	{
+		lpFrequency->QuadPart = 1000000000;
+		return TRUE;
+	}
+
+	void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime)
+	{
+		// 100ns intervals since 1601-01-01
+		timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+		const unsigned long long time = (static_cast<unsigned long long>(now.tv_sec) + 11644473600ull) * 10000000 + now.tv_nsec / 100;
+		lpSystemTimeAsFileTime->dwLowDateTime = static_cast<DWORD>(time);
+		lpSystemTimeAsFileTime->dwHighDateTime = static_cast<DWORD>(time >> 32);
+	}
+
+	HMODULE LoadLibrary(LPCTSTR lpLibFileName)
+	{
+		if (g_ktmAvailable && Upper(lpLibFileName) == Upper(_T("ktmw32.dll")))
+		{
+			return Ktmw32Module;
+		}
+		g_lastError = ERROR_FILE_NOT_FOUND;
+		return nullptr;
+	}
+
+	HMODULE GetModuleHandle(LPCTSTR lpModuleName)
+	{
+		return (Upper(lpModuleName) == Upper(_T("advapi32.dll"))) ? Advapi32Module : nullptr;
+	}
+
+	FARPROC GetProcAddress(HMODULE hModule, LPCSTR lpProcName)
+	{
+		const std::string name(lpProcName);
+		if (hModule == Advapi32Module && name == (sizeof(TCHAR) == 1 ? "RegCreateKeyTransactedA" : "RegCreateKeyTransactedW"))
+		{
+			return reinterpret_cast<FARPROC>(FakeRegCreateKeyTransacted);
+		}
+		if (hModule == Ktmw32Module && name == "CreateTransaction")
+		{
+			return reinterpret_cast<FARPROC>(FakeCreateTransaction);
+		}
+		if (hModule == Ktmw32Module && name == "CommitTransaction")
+		{
+			return reinterpret_cast<FARPROC>(FakeCommitTransaction);
+		}
+		if (hModule == Ktmw32Module && name == "RollbackTransaction")
+		{
+			return reinterpret_cast<FARPROC>(FakeRollbackTransaction);
+		}
+		return nullptr;
+	}
+
+	BOOL FreeLibrary(HMODULE)
+	{
+		return TRUE;
+	}
+
+	DWORD GetLastError(void)
+	{
+		return g_lastError;
+	}
+}
@@ -0,0 +1,89 @@
+//! @file Win32Host.h
+//! @brief State of the Win32 emulation in Win32.cpp, for host tests and benchmarks
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include <windows.h>
+
+#include <string>
+
+namespace Host
+{
+	//! string of TCHAR
+	typedef std::basic_string<TCHAR> String;
+
+	//! Calls counted by the Win32 emulation
+	struct Win32Counters
+	{
+		//! GlobalAlloc calls
+		size_t globalAllocs;
+
+		//! GlobalFree calls
+		size_t globalFrees;
+
+		//! bytes requested by GlobalAlloc
+		size_t bytesAllocated;
+
+		//! bytes allocated and not freed yet
+		size_t bytesLive;
+
+		//! RegOpenKeyEx and RegCreateKeyEx calls
+		size_t regOpens;
+
+		//! RegCloseKey calls
+		size_t regCloses;
+
+		//! RegQueryValueEx calls
+		size_t regQueries;
+
+		//! RegSetValueEx and RegDeleteValue calls
+		size_t regWrites;
+
+		//! SendMessageTimeout calls
+		size_t broadcasts;
+
+		//! GetFileAttributes calls
+		size_t fileAttributes;
+	};
+
+	//! counters since start, or since the test cleared them
+	extern Win32Counters g_win32;
+
+	//! Remove all values of HKCU and HKLM environment keys, all staged KTM writes, and a pending RegistryGrowOnQuery.
+	void RegistryClear();
+
+	//! Set a value, as if another process did.
+	void RegistryPut(HKEY root, LPCTSTR name, DWORD type, const String &value);
+
+	//! Read a value without counting it.
+	/*!
+		@return false if the value does not exist.
+	 */
+	bool RegistryGet(HKEY root, LPCTSTR name, DWORD &type, String &value);
+
+	//! Replace a value by grown just after the next RegQueryValueEx asking its size, as if another process wrote in between.
+	void RegistryGrowOnQuery(HKEY root, LPCTSTR name, const String &grown);
+
+	//! Make RegSetValueEx of a value name fail with ERROR_ACCESS_DENIED, or nullptr to stop.
+	void RegistryFailWrite(LPCTSTR name);
+
+	//! Make opening keys for write fail with ERROR_ACCESS_DENIED, as for a standard user on HKLM, or stop.
+	void RegistryReadOnly(bool readOnly);
+
+	//! Make ktmw32.dll available, and make CommitTransaction succeed or fail.
+	void KtmSetup(bool available, bool commitSucceeds = true);
+
+	//! Number of CommitTransaction and RollbackTransaction calls.
+	void KtmCounts(size_t &commits, size_t &rollbacks);
+
+	//! Set a variable of this process, returned by GetEnvironmentVariable and ExpandEnvironmentStrings. nullptr removes it.
+	void EnvironmentPut(LPCTSTR name, LPCTSTR value);
+
+	//! Make GetFileAttributes report path as a directory. Other paths are looked up in the host file system.
+	void DirectoryPut(LPCTSTR path);
+
+	//! Forget directories added by DirectoryPut.
+	void DirectoryClear();
+}
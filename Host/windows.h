@@ -0,0 +1,303 @@
+//! @file windows.h
+//! @brief Win32 subset used by EnvVarUpdate, so that the plugin builds and runs on a host without Windows SDK
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+#define WINAPI
+#define CALLBACK
+#define NSISCALL
+#define __stdcall
+#define __cdecl
+#define __declspec(x)
+#define __forceinline inline
+
+#ifdef UNICODE
+#ifndef _UNICODE
+#define _UNICODE
+#endif
+typedef wchar_t TCHAR;
+typedef wchar_t TBYTE;
+#define __T(x) L##x
+#else
+typedef char TCHAR;
+typedef unsigned char TBYTE;
+#define __T(x) x
+#endif
+#define _T(x) __T(x)
+#define TEXT(x) __T(x)
+#define _TEXT(x) __T(x)
+#define _TCHAR_DEFINED
+
+typedef TCHAR *LPTSTR;
+typedef const TCHAR *LPCTSTR;
+typedef char CHAR;
+typedef char *LPSTR;
+typedef const char *LPCSTR;
+typedef wchar_t WCHAR;
+typedef wchar_t *LPWSTR;
+typedef const wchar_t *LPCWSTR;
+typedef const wchar_t *PCWSTR;
+
+typedef unsigned char BYTE;
+typedef BYTE *LPBYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef DWORD *LPDWORD;
+typedef DWORD *PDWORD;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int64_t LONGLONG;
+typedef LONG LSTATUS;
+typedef intptr_t INT_PTR;
+typedef uintptr_t UINT_PTR;
+typedef intptr_t LONG_PTR;
+typedef uintptr_t ULONG_PTR;
+typedef uintptr_t DWORD_PTR;
+typedef DWORD_PTR *PDWORD_PTR;
+typedef void *LPVOID;
+typedef void *PVOID;
+typedef const void *LPCVOID;
+
+typedef void *HANDLE;
+typedef void *HGLOBAL;
+typedef struct HKEY__ *HKEY;
+typedef HKEY *PHKEY;
+typedef struct HWND__ *HWND;
+typedef struct HINSTANCE__ *HINSTANCE;
+typedef HINSTANCE HMODULE;
+typedef UINT_PTR WPARAM;
+typedef LONG_PTR LPARAM;
+typedef LONG_PTR LRESULT;
+typedef DWORD REGSAM;
+typedef int (*FARPROC)();
+
+typedef struct _FILETIME
+{
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME, *PFILETIME, *LPFILETIME;
+
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	} u;
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _GUID
+{
+	DWORD Data1;
+	WORD Data2;
+	WORD Data3;
+	BYTE Data4[8];
+} GUID, *LPGUID;
+
+typedef struct _SECURITY_ATTRIBUTES *LPSECURITY_ATTRIBUTES;
+typedef struct _OVERLAPPED *LPOVERLAPPED;
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define MAXLONG 0x7fffffff
+
+#define HKEY_CURRENT_USER ((HKEY)(ULONG_PTR)0x80000001)
+#define HKEY_LOCAL_MACHINE ((HKEY)(ULONG_PTR)0x80000002)
+#define KEY_QUERY_VALUE 0x0001
+#define KEY_SET_VALUE 0x0002
+#define KEY_NOTIFY 0x0010
+#define KEY_READ 0x20019
+#define KEY_WRITE 0x20006
+#define REG_OPTION_NON_VOLATILE 0
+#define REG_NONE 0
+#define REG_SZ 1
+#define REG_EXPAND_SZ 2
+#define REG_BINARY 3
+#define REG_DWORD 4
+#define REG_NOTIFY_CHANGE_LAST_SET 4
+
+#define ERROR_SUCCESS 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_ACCESS_DENIED 5L
+#define ERROR_INVALID_DATA 13L
+#define ERROR_MORE_DATA 234L
+#define ERROR_KEY_DELETED 1018L
+
+#define GMEM_FIXED 0x0000
+#define GMEM_ZEROINIT 0x0040
+#define GPTR (GMEM_FIXED | GMEM_ZEROINIT)
+
+#define HWND_BROADCAST ((HWND)(ULONG_PTR)0xffff)
+#define WM_SETTINGCHANGE 0x001A
+#define WM_USER 0x0400
+#define SMTO_ABORTIFHUNG 0x0002
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+#define INVALID_FILE_SIZE ((DWORD)0xFFFFFFFF)
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_APPEND_DATA 0x0004
+#define FILE_SHARE_READ 0x00000001
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+#define FILE_BEGIN 0
+#define FILE_END 2
+#define MOVEFILE_REPLACE_EXISTING 0x00000001
+#define MOVEFILE_WRITE_THROUGH 0x00000008
+
+#define CP_ACP 0
+#define LOCALE_USER_DEFAULT 0x0400
+#define NORM_IGNORECASE 0x00000001
+#define CSTR_LESS_THAN 1
+#define CSTR_EQUAL 2
+#define CSTR_GREATER_THAN 3
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+
+#define ZeroMemory(ptr, cnt) memset((ptr), 0, (cnt))
+
+#ifdef UNICODE
+#define lstrlen lstrlenW
+#define lstrcpy lstrcpyW
+#define lstrcpyn lstrcpynW
+#define lstrcat lstrcatW
+#define lstrcmp lstrcmpW
+#define lstrcmpi lstrcmpiW
+#define wsprintf wsprintfW
+#define CharUpper CharUpperW
+#define CompareString CompareStringW
+#define RegOpenKeyEx RegOpenKeyExW
+#define RegCreateKeyEx RegCreateKeyExW
+#define RegQueryValueEx RegQueryValueExW
+#define RegSetValueEx RegSetValueExW
+#define RegDeleteValue RegDeleteValueW
+#define RegQueryInfoKey RegQueryInfoKeyW
+#define SendMessageTimeout SendMessageTimeoutW
+#define GetEnvironmentVariable GetEnvironmentVariableW
+#define ExpandEnvironmentStrings ExpandEnvironmentStringsW
+#define GetFileAttributes GetFileAttributesW
+#define CreateFile CreateFileW
+#define LoadLibrary LoadLibraryW
+#define GetModuleHandle GetModuleHandleW
+#else
+#define lstrlen lstrlenA
+#define lstrcpy lstrcpyA
+#define lstrcpyn lstrcpynA
+#define lstrcat lstrcatA
+#define lstrcmp lstrcmpA
+#define lstrcmpi lstrcmpiA
+#define wsprintf wsprintfA
+#define CharUpper CharUpperA
+#define CompareString CompareStringA
+#define RegOpenKeyEx RegOpenKeyExA
+#define RegCreateKeyEx RegCreateKeyExA
+#define RegQueryValueEx RegQueryValueExA
+#define RegSetValueEx RegSetValueExA
+#define RegDeleteValue RegDeleteValueA
+#define RegQueryInfoKey RegQueryInfoKeyA
+#define SendMessageTimeout SendMessageTimeoutA
+#define GetEnvironmentVariable GetEnvironmentVariableA
+#define ExpandEnvironmentStrings ExpandEnvironmentStringsA
+#define GetFileAttributes GetFileAttributesA
+#define CreateFile CreateFileA
+#define LoadLibrary LoadLibraryA
+#define GetModuleHandle GetModuleHandleA
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	HGLOBAL GlobalAlloc(UINT uFlags, size_t dwBytes);
+	HGLOBAL GlobalFree(HGLOBAL hMem);
+
+	int lstrlenA(LPCSTR lpString);
+	int lstrlenW(LPCWSTR lpString);
+	LPSTR lstrcpyA(LPSTR lpString1, LPCSTR lpString2);
+	LPWSTR lstrcpyW(LPWSTR lpString1, LPCWSTR lpString2);
+	LPSTR lstrcpynA(LPSTR lpString1, LPCSTR lpString2, int iMaxLength);
+	LPWSTR lstrcpynW(LPWSTR lpString1, LPCWSTR lpString2, int iMaxLength);
+	LPSTR lstrcatA(LPSTR lpString1, LPCSTR lpString2);
+	LPWSTR lstrcatW(LPWSTR lpString1, LPCWSTR lpString2);
+	int lstrcmpA(LPCSTR lpString1, LPCSTR lpString2);
+	int lstrcmpW(LPCWSTR lpString1, LPCWSTR lpString2);
+	int lstrcmpiA(LPCSTR lpString1, LPCSTR lpString2);
+	int lstrcmpiW(LPCWSTR lpString1, LPCWSTR lpString2);
+	int wsprintfA(LPSTR buffer, LPCSTR format, ...);
+	int wsprintfW(LPWSTR buffer, LPCWSTR format, ...);
+	LPSTR CharUpperA(LPSTR lpsz);
+	LPWSTR CharUpperW(LPWSTR lpsz);
+	BOOL IsDBCSLeadByte(BYTE TestChar);
+	int CompareStringA(DWORD Locale, DWORD dwCmpFlags, LPCSTR lpString1, int cchCount1, LPCSTR lpString2, int cchCount2);
+	int CompareStringW(DWORD Locale, DWORD dwCmpFlags, LPCWSTR lpString1, int cchCount1, LPCWSTR lpString2, int cchCount2);
+	int MultiByteToWideChar(UINT CodePage, DWORD dwFlags, LPCSTR lpMultiByteStr, int cbMultiByte, LPWSTR lpWideCharStr, int cchWideChar);
+	int WideCharToMultiByte(UINT CodePage, DWORD dwFlags, LPCWSTR lpWideCharStr, int cchWideChar, LPSTR lpMultiByteStr, int cbMultiByte, LPCSTR lpDefaultChar, BOOL *lpUsedDefaultChar);
+	int MulDiv(int nNumber, int nNumerator, int nDenominator);
+
+	LSTATUS RegOpenKeyExA(HKEY hKey, LPCSTR lpSubKey, DWORD ulOptions, REGSAM samDesired, PHKEY phkResult);
+	LSTATUS RegOpenKeyExW(HKEY hKey, LPCWSTR lpSubKey, DWORD ulOptions, REGSAM samDesired, PHKEY phkResult);
+	LSTATUS RegCreateKeyExA(HKEY hKey, LPCSTR lpSubKey, DWORD Reserved, LPSTR lpClass, DWORD dwOptions, REGSAM samDesired, LPSECURITY_ATTRIBUTES lpSecurityAttributes, PHKEY phkResult, LPDWORD lpdwDisposition);
+	LSTATUS RegCreateKeyExW(HKEY hKey, LPCWSTR lpSubKey, DWORD Reserved, LPWSTR lpClass, DWORD dwOptions, REGSAM samDesired, LPSECURITY_ATTRIBUTES lpSecurityAttributes, PHKEY phkResult, LPDWORD lpdwDisposition);
+	LSTATUS RegQueryValueExA(HKEY hKey, LPCSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData);
+	LSTATUS RegQueryValueExW(HKEY hKey, LPCWSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData);
+	LSTATUS RegSetValueExA(HKEY hKey, LPCSTR lpValueName, DWORD Reserved, DWORD dwType, const BYTE *lpData, DWORD cbData);
+	LSTATUS RegSetValueExW(HKEY hKey, LPCWSTR lpValueName, DWORD Reserved, DWORD dwType, const BYTE *lpData, DWORD cbData);
+	LSTATUS RegDeleteValueA(HKEY hKey, LPCSTR lpValueName);
+	LSTATUS RegDeleteValueW(HKEY hKey, LPCWSTR lpValueName);
+	LSTATUS RegQueryInfoKeyA(HKEY hKey, LPSTR lpClass, LPDWORD lpcchClass, LPDWORD lpReserved, LPDWORD lpcSubKeys, LPDWORD lpcbMaxSubKeyLen, LPDWORD lpcbMaxClassLen, LPDWORD lpcValues, LPDWORD lpcbMaxValueNameLen, LPDWORD lpcbMaxValueLen, LPDWORD lpcbSecurityDescriptor, PFILETIME lpftLastWriteTime);
+	LSTATUS RegQueryInfoKeyW(HKEY hKey, LPWSTR lpClass, LPDWORD lpcchClass, LPDWORD lpReserved, LPDWORD lpcSubKeys, LPDWORD lpcbMaxSubKeyLen, LPDWORD lpcbMaxClassLen, LPDWORD lpcValues, LPDWORD lpcbMaxValueNameLen, LPDWORD lpcbMaxValueLen, LPDWORD lpcbSecurityDescriptor, PFILETIME lpftLastWriteTime);
+	LSTATUS RegCloseKey(HKEY hKey);
+	LONG CompareFileTime(const FILETIME *lpFileTime1, const FILETIME *lpFileTime2);
+
+	LRESULT SendMessageTimeoutA(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam, UINT fuFlags, UINT uTimeout, PDWORD_PTR lpdwResult);
+	LRESULT SendMessageTimeoutW(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam, UINT fuFlags, UINT uTimeout, PDWORD_PTR lpdwResult);
+
+	DWORD GetEnvironmentVariableA(LPCSTR lpName, LPSTR lpBuffer, DWORD nSize);
+	DWORD GetEnvironmentVariableW(LPCWSTR lpName, LPWSTR lpBuffer, DWORD nSize);
+	DWORD ExpandEnvironmentStringsA(LPCSTR lpSrc, LPSTR lpDst, DWORD nSize);
+	DWORD ExpandEnvironmentStringsW(LPCWSTR lpSrc, LPWSTR lpDst, DWORD nSize);
+
+	DWORD GetFileAttributesA(LPCSTR lpFileName);
+	DWORD GetFileAttributesW(LPCWSTR lpFileName);
+	HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
+	HANDLE CreateFileW(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
+	BOOL ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped);
+	BOOL WriteFile(HANDLE hFile, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrite, LPDWORD lpNumberOfBytesWritten, LPOVERLAPPED lpOverlapped);
+	DWORD GetFileSize(HANDLE hFile, LPDWORD lpFileSizeHigh);
+	DWORD SetFilePointer(HANDLE hFile, LONG lDistanceToMove, LONG *lpDistanceToMoveHigh, DWORD dwMoveMethod);
+	BOOL SetEndOfFile(HANDLE hFile);
+	BOOL CloseHandle(HANDLE hObject);
+	BOOL MoveFileExW(LPCWSTR lpExistingFileName, LPCWSTR lpNewFileName, DWORD dwFlags);
+	BOOL DeleteFileW(LPCWSTR lpFileName);
+
+	BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount);
+	BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency);
+	void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime);
+
+	HMODULE LoadLibraryA(LPCSTR lpLibFileName);
+	HMODULE LoadLibraryW(LPCWSTR lpLibFileName);
+	HMODULE GetModuleHandleA(LPCSTR lpModuleName);
+	HMODULE GetModuleHandleW(LPCWSTR lpModuleName);
+	FARPROC GetProcAddress(HMODULE hModule, LPCSTR lpProcName);
+	BOOL FreeLibrary(HMODULE hLibModule);
+	DWORD GetLastError(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,132 @@
+//! @file BroadcastTest.cpp
+//! @brief EnvBroadcast coalescing edits into one WM_SETTINGCHANGE, sent through a stub sender
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/Broadcast.h"
+
+using namespace Utils;
+
+namespace
+{
+	//! What the stub sender was called with
+	struct SentMessage
+	{
+		size_t calls;
+		HWND hWnd;
+		UINT Msg;
+		WPARAM wParam;
+		Host::String lParam;
+		UINT fuFlags;
+		UINT uTimeout;
+	};
+
+	SentMessage g_sent;
+
+	//! result returned by the stub sender
+	LRESULT g_sendResult = 1;
+
+	//! Stub of SendMessageTimeout
+	LRESULT WINAPI StubSender(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam, UINT fuFlags, UINT uTimeout, PDWORD_PTR lpdwResult)
+	{
+		g_sent.calls++;
+		g_sent.hWnd = hWnd;
+		g_sent.Msg = Msg;
+		g_sent.wParam = wParam;
+		g_sent.lParam = reinterpret_cast<LPCTSTR>(lParam);
+		g_sent.fuFlags = fuFlags;
+		g_sent.uTimeout = uTimeout;
+		*lpdwResult = 0;
+		return g_sendResult;
+	}
+
+	void TestCoalesced()
+	{
+		g_sent = SentMessage();
+		EnvBroadcast broadcast = {};
+		broadcast.deferred = true;
+		broadcast.sender = StubSender;
+
+		// nothing written: nothing sent
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 0);
+
+		broadcast.MarkDirty();
+		broadcast.MarkDirty();
+		broadcast.MarkDirty();
+		CHECK(g_sent.calls == 0);
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 1);
+		CHECK(broadcast.sent == 1);
+		CHECK(g_sent.hWnd == HWND_BROADCAST);
+		CHECK(g_sent.Msg == WM_SETTINGCHANGE);
+		CHECK(g_sent.wParam == 0);
+		CHECK(g_sent.lParam == _T("Environment"));
+		CHECK(g_sent.fuFlags == SMTO_ABORTIFHUNG);
+		CHECK(g_sent.uTimeout == EnvBroadcast::DefaultTimeoutMs);
+
+		// sent once per dirty period
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 1);
+
+		broadcast.timeoutMs = 250;
+		broadcast.MarkDirty();
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 2);
+		CHECK(g_sent.uTimeout == 250);
+	}
+
+	void TestNotDeferred()
+	{
+		g_sent = SentMessage();
+		EnvBroadcast broadcast = {};
+		broadcast.sender = StubSender;
+
+		// "Broadcast" "None": edits are never broadcast
+		broadcast.MarkDirty();
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 0);
+		CHECK(broadcast.sent == 0);
+	}
+
+	void TestFailed()
+	{
+		g_sent = SentMessage();
+		g_sendResult = 0;
+		EnvBroadcast broadcast = {};
+		broadcast.deferred = true;
+		broadcast.sender = StubSender;
+
+		// a timed out broadcast reports failure, and is not retried
+		broadcast.MarkDirty();
+		CHECK(!broadcast.Flush());
+		CHECK(broadcast.Flush());
+		CHECK(g_sent.calls == 1);
+		g_sendResult = 1;
+	}
+
+	void TestDefaultSender()
+	{
+		g_sent = SentMessage();
+		EnvBroadcast broadcast = {};
+		broadcast.deferred = true;
+
+		// without a sender, SendMessageTimeout is called
+		const size_t broadcasts = Host::g_win32.broadcasts;
+		broadcast.MarkDirty();
+		CHECK(broadcast.Flush());
+		CHECK(Host::g_win32.broadcasts - broadcasts == 1);
+		CHECK(g_sent.calls == 0);
+	}
+}
+
+int main()
+{
+	TestCoalesced();
+	TestNotDeferred();
+	TestFailed();
+	TestDefaultSender();
+	return Host::Summary("BroadcastTest");
+}
@@ -0,0 +1,251 @@
+//! @file EditGroupTest.cpp
+//! @brief Batches of edits popped by EditQueue, and applied by ComputeEditGroup to MemoryStore
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "NsisHost.h"
+#include "Win32Host.h"
+#include "../Utils/EditGroup.h"
+#include "../Utils/MemoryStore.h"
+
+using namespace Utils;
+
+namespace
+{
+	//! buffers of edits, as g_arena of the plugin
+	Arena g_testArena;
+
+	//! HKCU and HKLM of the tests
+	MemoryStore g_hkcu;
+	MemoryStore g_hklm;
+
+	//! SelectStore over g_hkcu and g_hklm
+	bool SelectMemory(LPCTSTR RegLoc, EnvStore &store)
+	{
+		store = EnvStore();
+		if (lstrcmpi(RegLoc, _T("HKCU")) == 0)
+		{
+			store = g_hkcu.Store();
+			return true;
+		}
+		else if (lstrcmpi(RegLoc, _T("HKLM")) == 0)
+		{
+			store = g_hklm.Store();
+			return true;
+		}
+		return false;
+	}
+
+	//! Value in store, or "<none>".
+	Host::String Value(MemoryStore &store, LPCTSTR name)
+	{
+		MemoryEntry *entry = store.Find(name);
+		return (entry != nullptr) ? entry->value : _T("<none>");
+	}
+
+	//! Put a value of REG_EXPAND_SZ.
+	void Put(MemoryStore &store, LPCTSTR name, LPCTSTR value)
+	{
+		store.Put(name, lstrlen(name), value, lstrlen(value));
+	}
+
+	//! Apply popped edits group by group, as EnvVarUpdateBatch does.
+	/*!
+		@return false if any group fails.
+	 */
+	bool ApplyBatch(EditQueue &edits, size_t &written)
+	{
+		ArenaScope batchScope(&g_testArena);
+		PathNormalizer normalizer(NormalizeNone);
+		bool success = true;
+		for (EditEntry *entry = edits.first; entry != nullptr; entry = entry->next)
+		{
+			if (entry->done)
+			{
+				continue;
+			}
+			ArenaScope scope;
+			PendingValue pending;
+			if (!ComputeEditGroup(entry, pending, normalizer, SelectMemory))
+			{
+				success = false;
+				continue;
+			}
+			if (pending.IsChanged())
+			{
+				success &= pending.store.Set(pending.first->EnvVarName, *pending.current, ChooseValueType(pending.ValueType, *pending.current));
+				written++;
+			}
+		}
+		return success;
+	}
+
+	void TestPopUntil()
+	{
+		Host::Installer installer;
+		installer.Push(_T("caller's"));
+		installer.Push(_T("/end"));
+		installer.Push(_T("C:\\B"));
+		installer.Push(_T("HKLM"));
+		installer.Push(_T("R"));
+		installer.Push(_T("PATH"));
+		installer.Push(_T("C:\\A"));
+		installer.Push(_T("HKCU"));
+		installer.Push(_T("A"));
+		installer.Push(_T("Path"));
+
+		EditQueue edits;
+		CHECK(edits.PopUntil(_T("/END")));
+		CHECK(edits.count == 2);
+		CHECK(lstrcmp(edits.first->EnvVarName, _T("Path")) == 0);
+		CHECK(lstrcmp(edits.first->Action, _T("A")) == 0);
+		CHECK(lstrcmp(edits.first->RegLoc, _T("HKCU")) == 0);
+		CHECK(lstrcmp(edits.first->PathString, _T("C:\\A")) == 0);
+		CHECK(lstrcmp(edits.last->RegLoc, _T("HKLM")) == 0);
+		CHECK(installer.Pop() == _T("caller's"));
+	}
+
+	void TestPopUntilUnderflow()
+	{
+		// no "/END": the tuple and the caller's string are popped, and all pushed back
+		Host::Installer installer;
+		installer.Push(_T("caller's"));
+		installer.Push(_T("C:\\A"));
+		installer.Push(_T("HKCU"));
+		installer.Push(_T("A"));
+		installer.Push(_T("PATH"));
+
+		EditQueue edits;
+		CHECK(!edits.PopUntil(_T("/END")));
+		CHECK(edits.count == 0);
+		CHECK(edits.first == nullptr);
+		CHECK(installer.Depth() == 5);
+		CHECK(installer.Pop() == _T("PATH"));
+		CHECK(installer.Pop() == _T("A"));
+		CHECK(installer.Pop() == _T("HKCU"));
+		CHECK(installer.Pop() == _T("C:\\A"));
+		CHECK(installer.Pop() == _T("caller's"));
+
+		// a partial tuple of Pop is pushed back as well
+		installer.Push(_T("HKCU"));
+		installer.Push(_T("A"));
+		installer.Push(_T("PATH"));
+		CHECK(!edits.Pop());
+		CHECK(edits.count == 0);
+		CHECK(installer.Depth() == 3);
+		CHECK(installer.Pop() == _T("PATH"));
+		CHECK(installer.Pop() == _T("A"));
+		CHECK(installer.Pop() == _T("HKCU"));
+
+		// empty stack
+		CHECK(!edits.PopUntil(_T("/END")));
+		CHECK(installer.Depth() == 0);
+	}
+
+	void TestGroups()
+	{
+		g_hkcu.Clear();
+		g_hklm.Clear();
+		Put(g_hkcu, _T("PATH"), _T("C:\\Old;C:\\Keep"));
+		Put(g_hklm, _T("PATH"), _T("C:\\Windows"));
+
+		Host::Installer installer;
+		for (LPCTSTR text : {
+			_T("/END"),
+			_T("C:\\Tools"), _T("HKLM"), _T("A"), _T("PATH"),
+			_T("C:\\Lib"), _T("HKCU"), _T("P"), _T("LIB"),
+			_T("C:\\Old"), _T("HKCU"), _T("R"), _T("path"),
+			_T("C:\\New"), _T("hkcu"), _T("A"), _T("PATH"),
+			})
+		{
+			installer.Push(text);
+		}
+
+		EditQueue edits;
+		CHECK(edits.PopUntil(_T("/END")));
+		CHECK(edits.count == 4);
+
+		const StoreCounters before = g_storeCounters;
+		size_t written = 0;
+		CHECK(ApplyBatch(edits, written));
+		CHECK(written == 3);
+
+		// one read and one write per (EnvVarName, RegLoc)
+		CHECK(g_storeCounters.reads - before.reads == 3);
+		CHECK(g_storeCounters.writes - before.writes == 3);
+		CHECK(Value(g_hkcu, _T("PATH")) == _T("C:\\Keep;C:\\New"));
+		CHECK(Value(g_hkcu, _T("LIB")) == _T("C:\\Lib"));
+		CHECK(Value(g_hklm, _T("PATH")) == _T("C:\\Windows;C:\\Tools"));
+	}
+
+	void TestUnchangedGroup()
+	{
+		g_hkcu.Clear();
+		Put(g_hkcu, _T("PATH"), _T("C:\\A;C:\\B"));
+
+		Host::Installer installer;
+		for (LPCTSTR text : {
+			_T("/END"),
+			_T("C:\\B"), _T("HKCU"), _T("A"), _T("PATH"),
+			_T("C:\\B"), _T("HKCU"), _T("R"), _T("PATH"),
+			})
+		{
+			installer.Push(text);
+		}
+
+		EditQueue edits;
+		CHECK(edits.PopUntil(_T("/END")));
+		const StoreCounters before = g_storeCounters;
+		size_t written = 0;
+		CHECK(ApplyBatch(edits, written));
+
+		// removed and appended again: the value is as read, and not written
+		CHECK(written == 0);
+		CHECK(g_storeCounters.reads - before.reads == 1);
+		CHECK(g_storeCounters.writes == before.writes);
+		CHECK(Value(g_hkcu, _T("PATH")) == _T("C:\\A;C:\\B"));
+	}
+
+	void TestFailedGroup()
+	{
+		g_hkcu.Clear();
+		Put(g_hkcu, _T("PATH"), _T("C:\\A"));
+		Put(g_hkcu, _T("LIB"), _T("C:\\L"));
+
+		Host::Installer installer;
+		for (LPCTSTR text : {
+			_T("/END"),
+			_T("C:\\X"), _T("HKXX"), _T("A"), _T("PATH"),
+			_T("C:\\M"), _T("HKCU"), _T("A"), _T("LIB"),
+			_T("C:\\C"), _T("HKCU"), _T("Q"), _T("PATH"),
+			_T("C:\\B"), _T("HKCU"), _T("A"), _T("PATH"),
+			})
+		{
+			installer.Push(text);
+		}
+
+		EditQueue edits;
+		CHECK(edits.PopUntil(_T("/END")));
+		size_t written = 0;
+		CHECK(!ApplyBatch(edits, written));
+
+		// the group having an unknown action is not written. Other groups are.
+		CHECK(written == 1);
+		CHECK(Value(g_hkcu, _T("PATH")) == _T("C:\\A"));
+		CHECK(Value(g_hkcu, _T("LIB")) == _T("C:\\L;C:\\M"));
+	}
+}
+
+int main()
+{
+	TestPopUntil();
+	TestPopUntilUnderflow();
+	TestGroups();
+	TestUnchangedGroup();
+	TestFailedGroup();
+	g_hkcu.Clear();
+	g_hklm.Clear();
+	g_testArena.Release();
+	return Host::Summary("EditGroupTest");
+}
@@ -0,0 +1,224 @@
+//! @file MemoryStoreTest.cpp
+//! @brief MemoryStore as EnvStore backend, its "NAME=VALUE" file, and Snapshot, Rollback and Commit
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/GrowString.h"
+#include "../Utils/MemoryStore.h"
+
+#include <cstdio>
+
+using namespace Utils;
+
+namespace
+{
+	//! file of the tests, in the current directory
+	LPCTSTR const TestPath = _T("MemoryStoreTest.env");
+
+	//! Read value through EnvStore, or "<error>".
+	Host::String Get(EnvStore &store, LPCTSTR name, DWORD &type)
+	{
+		GrowString value;
+		return store.Get(name, value, type) ? static_cast<LPCTSTR>(value) : _T("<error>");
+	}
+
+	//! Write value through EnvStore.
+	bool Set(EnvStore &store, LPCTSTR name, LPCTSTR text, DWORD type)
+	{
+		GrowString value;
+		return value.AssignString(text, 0, lstrlen(text)) && store.Set(name, value, type);
+	}
+
+	//! Remove TestPath.
+	void RemoveTestFile()
+	{
+		remove("MemoryStoreTest.env");
+	}
+
+	void TestGetSet()
+	{
+		MemoryStore memory;
+		EnvStore store = memory.Store();
+		DWORD type = REG_SZ;
+
+		// missing: empty, and REG_NONE
+		CHECK(Get(store, _T("PATH"), type) == _T(""));
+		CHECK(type == REG_NONE);
+
+		CHECK(Set(store, _T("Path"), _T("C:\\A"), REG_SZ));
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\A"));
+		CHECK(type == REG_SZ);
+
+		// names are case insensitive: replaced, not added
+		CHECK(Set(store, _T("PATH"), _T("C:\\A;%X%"), REG_EXPAND_SZ));
+		CHECK(Get(store, _T("path"), type) == _T("C:\\A;%X%"));
+		CHECK(type == REG_EXPAND_SZ);
+		CHECK(memory.first != nullptr && memory.first->next == nullptr);
+
+		CHECK(Set(store, _T("LIB"), _T(""), REG_SZ));
+		CHECK(Get(store, _T("LIB"), type) == _T(""));
+		CHECK(type == REG_SZ);
+
+		// REG_NONE deletes
+		CHECK(Set(store, _T("Path"), _T(""), REG_NONE));
+		CHECK(memory.Find(_T("PATH")) == nullptr);
+		CHECK(memory.Find(_T("LIB")) != nullptr);
+		Get(store, _T("PATH"), type);
+		CHECK(type == REG_NONE);
+	}
+
+	void TestCounters()
+	{
+		MemoryStore memory;
+		EnvStore store = memory.Store();
+		DWORD type;
+
+		const StoreCounters before = g_storeCounters;
+		Set(store, _T("PATH"), _T("C:\\A"), REG_SZ);
+		Get(store, _T("PATH"), type);
+		Get(store, _T("PATH"), type);
+		CHECK(g_storeCounters.writes - before.writes == 1);
+		CHECK(g_storeCounters.reads - before.reads == 2);
+		CHECK(g_storeCounters.bytesRead - before.bytesRead == 2 * 4 * sizeof(TCHAR));
+		CHECK(g_storeCounters.bytesWritten - before.bytesWritten == 4 * sizeof(TCHAR));
+
+		// a different instance is a different store
+		MemoryStore other;
+		CHECK(store.IsSameAs(memory.Store()));
+		CHECK(!store.IsSameAs(other.Store()));
+	}
+
+	void TestLoadSave()
+	{
+		RemoveTestFile();
+		{
+			MemoryStore memory;
+			memory.filePath = TestPath;
+			EnvStore store = memory.Store();
+
+			// each Set saves the file
+			CHECK(Set(store, _T("PATH"), _T("C:\\A;C:\\B"), REG_SZ));
+			CHECK(Set(store, _T("LIB"), _T("C:\\L=1"), REG_EXPAND_SZ));
+			CHECK(Set(store, _T("TMP"), _T("C:\\T"), REG_SZ));
+			CHECK(Set(store, _T("TMP"), _T(""), REG_NONE));
+		}
+
+		MemoryStore loaded;
+		CHECK(loaded.Load(TestPath));
+		EnvStore store = loaded.Store();
+		DWORD type;
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\A;C:\\B"));
+		CHECK(type == REG_EXPAND_SZ);
+		CHECK(Get(store, _T("LIB"), type) == _T("C:\\L=1"));
+		CHECK(loaded.Find(_T("TMP")) == nullptr);
+
+		// loading again replaces same names
+		CHECK(loaded.Load(TestPath));
+		CHECK(loaded.first != nullptr && loaded.first->next != nullptr && loaded.first->next->next == nullptr);
+
+		RemoveTestFile();
+		MemoryStore missing;
+		CHECK(!missing.Load(TestPath));
+	}
+
+	void TestSnapshot()
+	{
+		MemoryStore memory;
+		EnvStore store = memory.Store();
+		DWORD type;
+
+		// nothing to go back to
+		CHECK(!memory.Rollback());
+
+		Set(store, _T("PATH"), _T("C:\\A"), REG_SZ);
+		Set(store, _T("LIB"), _T("C:\\L"), REG_EXPAND_SZ);
+		CHECK(memory.Snapshot());
+		CHECK(memory.hasSnapshot);
+
+		// changed, added and removed since Snapshot: all go back, with their types
+		Set(store, _T("PATH"), _T("C:\\A;C:\\B"), REG_EXPAND_SZ);
+		Set(store, _T("TMP"), _T("C:\\T"), REG_SZ);
+		Set(store, _T("LIB"), _T(""), REG_NONE);
+		CHECK(memory.Rollback());
+		CHECK(!memory.hasSnapshot);
+		CHECK(memory.snapshot == nullptr);
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\A"));
+		CHECK(type == REG_SZ);
+		CHECK(Get(store, _T("LIB"), type) == _T("C:\\L"));
+		CHECK(type == REG_EXPAND_SZ);
+		CHECK(memory.Find(_T("TMP")) == nullptr);
+
+		// dropped by Rollback: a second one fails
+		CHECK(!memory.Rollback());
+
+		// Commit keeps the changes, and drops the snapshot
+		CHECK(memory.Snapshot());
+		Set(store, _T("PATH"), _T("C:\\C"), REG_SZ);
+		memory.Commit();
+		CHECK(!memory.hasSnapshot);
+		CHECK(!memory.Rollback());
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\C"));
+
+		// a snapshot of no entries goes back to empty
+		MemoryStore empty;
+		EnvStore emptyStore = empty.Store();
+		CHECK(empty.Snapshot());
+		CHECK(empty.hasSnapshot);
+		Set(emptyStore, _T("PATH"), _T("C:\\A"), REG_SZ);
+		CHECK(empty.Rollback());
+		CHECK(empty.first == nullptr);
+
+		// a new Snapshot replaces the last one
+		CHECK(memory.Snapshot());
+		Set(store, _T("PATH"), _T("C:\\D"), REG_SZ);
+		CHECK(memory.Snapshot());
+		Set(store, _T("PATH"), _T("C:\\E"), REG_SZ);
+		CHECK(memory.Rollback());
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\D"));
+	}
+
+	void TestRollbackSaves()
+	{
+		RemoveTestFile();
+		{
+			MemoryStore memory;
+			memory.filePath = TestPath;
+			EnvStore store = memory.Store();
+			Set(store, _T("PATH"), _T("C:\\A"), REG_SZ);
+			CHECK(memory.Snapshot());
+			Set(store, _T("PATH"), _T("C:\\B"), REG_SZ);
+
+			// the file follows Rollback
+			CHECK(memory.Rollback());
+		}
+		MemoryStore loaded;
+		CHECK(loaded.Load(TestPath));
+		DWORD type;
+		EnvStore store = loaded.Store();
+		CHECK(Get(store, _T("PATH"), type) == _T("C:\\A"));
+
+		// entries and the snapshot are freed by dtor
+		const size_t live = Host::g_win32.bytesLive;
+		{
+			MemoryStore memory;
+			EnvStore memoryStore = memory.Store();
+			Set(memoryStore, _T("PATH"), _T("C:\\A"), REG_SZ);
+			CHECK(memory.Snapshot());
+			Set(memoryStore, _T("PATH"), _T("C:\\B"), REG_SZ);
+		}
+		CHECK(Host::g_win32.bytesLive == live);
+		RemoveTestFile();
+	}
+}
+
+int main()
+{
+	TestGetSet();
+	TestCounters();
+	TestLoadSave();
+	TestSnapshot();
+	TestRollbackSaves();
+	return Host::Summary("MemoryStoreTest");
+}
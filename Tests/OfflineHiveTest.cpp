@@ -0,0 +1,477 @@
+//! @file OfflineHiveTest.cpp
+//! @brief OfflineHive over regf files built here: key lookup, in place and moved writes, big data, save, and refused hives
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/GrowString.h"
+#include "../Utils/OfflineHive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Utils;
+
+namespace
+{
+	//! hive file of the tests, in the current directory
+	LPCTSTR const TestHive = _T("OfflineHiveTest.dat");
+
+	//! hive under test, zero initialized as the plugin globals are
+	OfflineHive g_hive;
+
+	typedef std::vector<BYTE> Bytes;
+
+	//! Write little endian DWORD.
+	void Put32(Bytes &bytes, size_t at, DWORD value)
+	{
+		for (int index = 0; index < 4; index++)
+		{
+			bytes[at + index] = static_cast<BYTE>(value >> (8 * index));
+		}
+	}
+
+	//! Read little endian DWORD.
+	DWORD Get32(const Bytes &bytes, size_t at)
+	{
+		return bytes[at] | (bytes[at + 1] << 8) | (bytes[at + 2] << 16) | (static_cast<DWORD>(bytes[at + 3]) << 24);
+	}
+
+	//! Latin-1 text as UTF-16LE, with null.
+	Bytes Utf16(const char *text)
+	{
+		Bytes bytes;
+		for (const char *scan = text; ; scan++)
+		{
+			bytes.push_back(static_cast<BYTE>(*scan));
+			bytes.push_back(0);
+			if (*scan == 0)
+			{
+				return bytes;
+			}
+		}
+	}
+
+	//! Checksum of a base block.
+	DWORD Checksum(const Bytes &bytes)
+	{
+		DWORD checksum = 0;
+		for (size_t at = 0; at < 508; at += 4)
+		{
+			checksum ^= Get32(bytes, at);
+		}
+		return (checksum == 0) ? 1 : (checksum == 0xFFFFFFFF) ? 0xFFFFFFFE : checksum;
+	}
+
+	//! Hive of one bin, with cells added one after another, and the rest of the bin free.
+	struct HiveBuilder
+	{
+		//! the bin, from its "hbin" header
+		Bytes bin = Bytes(32, 0);
+
+		//! Add an allocated cell of body, returning its offset.
+		DWORD Cell(const Bytes &body)
+		{
+			const DWORD cell = static_cast<DWORD>(bin.size());
+			const DWORD size = static_cast<DWORD>((body.size() + 4 + 7) / 8 * 8);
+			bin.resize(cell + size, 0);
+			Put32(bin, cell, static_cast<DWORD>(-static_cast<LONG>(size)));
+			std::copy(body.begin(), body.end(), bin.begin() + cell + 4);
+			return cell;
+		}
+
+		//! Add a value, with a data cell unless 4 bytes or less.
+		DWORD Value(const char *name, DWORD type, const Bytes &data)
+		{
+			Bytes body(20, 0);
+			body[0] = 'v';
+			body[1] = 'k';
+			body[2] = static_cast<BYTE>(strlen(name));
+			Put32(body, 12, type);
+			body[16] = 1;
+			body.insert(body.end(), name, name + strlen(name));
+			if (data.size() <= 4)
+			{
+				Put32(body, 4, static_cast<DWORD>(data.size()) | 0x80000000);
+				std::copy(data.begin(), data.end(), body.begin() + 8);
+			}
+			else
+			{
+				Put32(body, 4, static_cast<DWORD>(data.size()));
+				Put32(body, 8, Cell(data));
+			}
+			return Cell(body);
+		}
+
+		//! Add a list: "lf" or "lh" with zero hashes, "li" or "ri" of cells, or a value list when signature is nullptr.
+		DWORD List(const char *signature, const std::vector<DWORD> &cells)
+		{
+			Bytes body;
+			if (signature != nullptr)
+			{
+				body.push_back(signature[0]);
+				body.push_back(signature[1]);
+				body.push_back(static_cast<BYTE>(cells.size()));
+				body.push_back(0);
+			}
+			const bool hashed = signature != nullptr && signature[0] == 'l' && signature[1] != 'i';
+			for (DWORD cell : cells)
+			{
+				body.resize(body.size() + (hashed ? 8 : 4), 0);
+				Put32(body, body.size() - (hashed ? 8 : 4), cell);
+			}
+			return Cell(body);
+		}
+
+		//! Add a key with its subkey list and values.
+		DWORD Key(const char *name, DWORD subkeyCount, DWORD subkeyList, const std::vector<DWORD> &values)
+		{
+			Bytes body(76, 0);
+			body[0] = 'n';
+			body[1] = 'k';
+			body[2] = 0x20;
+			Put32(body, 20, subkeyCount);
+			Put32(body, 28, subkeyCount == 0 ? 0xFFFFFFFF : subkeyList);
+			Put32(body, 36, static_cast<DWORD>(values.size()));
+			Put32(body, 40, values.empty() ? 0xFFFFFFFF : List(nullptr, values));
+			body[72] = static_cast<BYTE>(strlen(name));
+			body.insert(body.end(), name, name + strlen(name));
+			return Cell(body);
+		}
+
+		//! Key having one subkey, in an "lf" list.
+		DWORD Parent(const char *name, DWORD subkey)
+		{
+			return Key(name, 1, List("lf", { subkey }), {});
+		}
+
+		//! Base block and the bin, padded to 4096 by a free cell.
+		Bytes Finish(DWORD root)
+		{
+			if (bin.size() % 4096 > 4096 - 8)
+			{
+				bin.resize(bin.size() + 8, 0);
+			}
+			const DWORD free = 4096 - bin.size() % 4096;
+			const DWORD freeCell = static_cast<DWORD>(bin.size());
+			bin.resize(bin.size() + free, 0);
+			Put32(bin, freeCell, free);
+			bin[0] = 'h';
+			bin[1] = 'b';
+			bin[2] = 'i';
+			bin[3] = 'n';
+			Put32(bin, 8, static_cast<DWORD>(bin.size()));
+
+			Bytes hive(4096, 0);
+			hive[0] = 'r';
+			hive[1] = 'e';
+			hive[2] = 'g';
+			hive[3] = 'f';
+			Put32(hive, 4, 1);
+			Put32(hive, 8, 1);
+			Put32(hive, 20, 1);
+			Put32(hive, 24, 5);
+			Put32(hive, 32, 1);
+			Put32(hive, 36, root);
+			Put32(hive, 40, static_cast<DWORD>(bin.size()));
+			Put32(hive, 508, Checksum(hive));
+			hive.insert(hive.end(), bin.begin(), bin.end());
+			return hive;
+		}
+	};
+
+	//! User hive: "Console", and "Environment" with PATH, TEMP and a REG_DWORD.
+	/*!
+		@param envKey receives the "Environment" cell.
+		@param pathValue receives the "vk" cell of PATH.
+	 */
+	Bytes UserHive(DWORD &envKey, DWORD &pathValue)
+	{
+		HiveBuilder builder;
+		pathValue = builder.Value("Path", REG_EXPAND_SZ, Utf16("C:\\A;C:\\B"));
+		const DWORD temp = builder.Value("TEMP", REG_SZ, Utf16("C:\\Caf\xe9"));
+		const DWORD number = builder.Value("N", REG_DWORD, { 1, 0, 0, 0 });
+		envKey = builder.Key("Environment", 0, 0, { pathValue, temp, number });
+		const DWORD console = builder.Key("Console", 0, 0, {});
+		return builder.Finish(builder.Key("ROOT", 2, builder.List("lf", { console, envKey }), {}));
+	}
+
+	//! System hive: "Select\Current", and PATH of ControlSet001 and ControlSet002, under "ri" and "lh" lists.
+	Bytes SystemHive(DWORD current)
+	{
+		HiveBuilder builder;
+		DWORD controlSets[2];
+		for (int index = 0; index < 2; index++)
+		{
+			const DWORD path = builder.Value("Path", REG_EXPAND_SZ, Utf16(index == 0 ? "C:\\One" : "C:\\Two"));
+			const DWORD environment = builder.Key("Environment", 0, 0, { path });
+			controlSets[index] = builder.Parent(index == 0 ? "ControlSet001" : "ControlSet002", builder.Parent("Control", builder.Parent("Session Manager", environment)));
+		}
+		const DWORD select = builder.Key("Select", 0, 0, { builder.Value("Current", REG_DWORD, { static_cast<BYTE>(current), 0, 0, 0 }) });
+		const DWORD list = builder.List("ri", { builder.List("li", { controlSets[0] }), builder.List("lh", { controlSets[1], select }) });
+		return builder.Finish(builder.Key("SYSTEM", 3, list, {}));
+	}
+
+	//! Write TestHive.
+	void Store(const Bytes &hive)
+	{
+		FILE *file = fopen("OfflineHiveTest.dat", "wb");
+		fwrite(hive.data(), 1, hive.size(), file);
+		fclose(file);
+	}
+
+	//! Read TestHive.
+	Bytes Load()
+	{
+		Bytes hive;
+		FILE *file = fopen("OfflineHiveTest.dat", "rb");
+		for (int oneByte; file != nullptr && (oneByte = fgetc(file)) != EOF; )
+		{
+			hive.push_back(static_cast<BYTE>(oneByte));
+		}
+		if (file != nullptr)
+		{
+			fclose(file);
+		}
+		return hive;
+	}
+
+	//! Read value, or "<error>".
+	Host::String Get(LPCTSTR name, DWORD &type)
+	{
+		GrowString value;
+		return g_hive.Get(name, value, type) ? static_cast<LPCTSTR>(value) : _T("<error>");
+	}
+
+	//! Write value.
+	bool Set(LPCTSTR name, const Host::String &text, DWORD type)
+	{
+		GrowString value;
+		return value.AssignString(text.c_str(), 0, text.size()) && g_hive.Set(name, value, type);
+	}
+
+	//! Value of chars, ending with a marker of its length.
+	Host::String MakeValue(size_t chars)
+	{
+		Host::String value;
+		while (value.size() < chars)
+		{
+			value += _T("C:\\Dir;");
+		}
+		value.resize(chars);
+		value.back() = _T('$');
+		return value;
+	}
+
+	void TestGetSet()
+	{
+		DWORD envKey;
+		DWORD pathValue;
+		const Bytes before = UserHive(envKey, pathValue);
+		Store(before);
+		DWORD type;
+
+		CHECK(!g_hive.Open(TestHive, true));
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(!g_hive.Open(TestHive, false));
+
+		// names ignore case; a missing value is empty, and other types are errors
+		CHECK(Get(_T("PATH"), type) == _T("C:\\A;C:\\B"));
+		CHECK(type == REG_EXPAND_SZ);
+		CHECK(Get(_T("temp"), type) == _T("C:\\Caf\xe9"));
+		CHECK(type == REG_SZ);
+		CHECK(Get(_T("Missing"), type) == _T(""));
+		CHECK(type == REG_NONE);
+		CHECK(Get(_T("N"), type) == _T("<error>"));
+
+		// not saved: the file is not changed
+		CHECK(Set(_T("PATH"), _T("C:\\C"), REG_EXPAND_SZ));
+		CHECK(Get(_T("Path"), type) == _T("C:\\C"));
+		CHECK(g_hive.Close(false));
+		CHECK(Load() == before);
+
+		// shorter data is rewritten in its cell: only that cell, the value and the key change in the bins
+		const DWORD pathData = Get32(before, 4096 + pathValue + 4 + 8);
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Set(_T("PATH"), _T("C:\\C"), REG_SZ));
+		CHECK(g_hive.Close(true));
+		const Bytes after = Load();
+		CHECK(after.size() == before.size());
+		CHECK(Get32(after, 4) == 2);
+		CHECK(Get32(after, 8) == 2);
+		CHECK(Get32(after, 508) == Checksum(after));
+		size_t changedElsewhere = 0;
+		for (size_t at = 4096; at < before.size() && after.size() == before.size(); at++)
+		{
+			const size_t offset = at - 4096;
+			const bool inKey = envKey <= offset && offset < envKey + 4 + 76 + 11;
+			const bool inValue = pathValue <= offset && offset < pathValue + 4 + 20 + 4;
+			const bool inData = pathData <= offset && offset < pathData + 24;
+			changedElsewhere += (before[at] != after[at] && !inKey && !inValue && !inData) ? 1 : 0;
+		}
+		CHECK(changedElsewhere == 0);
+
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("Path"), type) == _T("C:\\C"));
+		CHECK(type == REG_SZ);
+		CHECK(Get(_T("TEMP"), type) == _T("C:\\Caf\xe9"));
+		CHECK(g_hive.Close(true));
+		CHECK(Load() == after);
+	}
+
+	void TestGrowAndDelete()
+	{
+		DWORD envKey;
+		DWORD pathValue;
+		const Bytes before = UserHive(envKey, pathValue);
+		Store(before);
+		DWORD type;
+
+		// longer data and new values take free cells of the bin, and the value list is moved as it fills
+		const Host::String longer = MakeValue(300);
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Set(_T("PATH"), longer, REG_EXPAND_SZ));
+		for (TCHAR name = _T('A'); name <= _T('L'); name++)
+		{
+			const TCHAR valueName[] = { _T('V'), name, 0 };
+			CHECK(Set(valueName, valueName, REG_SZ));
+		}
+		CHECK(Set(_T("TEMP"), _T(""), REG_NONE));
+		CHECK(Set(_T("TEMP"), _T(""), REG_NONE));
+		CHECK(g_hive.Close(true));
+		CHECK(Load().size() == before.size());
+
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("Path"), type) == longer);
+		CHECK(Get(_T("VA"), type) == _T("VA"));
+		CHECK(Get(_T("VL"), type) == _T("VL"));
+		CHECK(type == REG_SZ);
+		CHECK(Get(_T("TEMP"), type) == _T(""));
+		CHECK(type == REG_NONE);
+
+		// every value deleted, and added again to an empty key
+		CHECK(Set(_T("PATH"), _T(""), REG_NONE));
+		CHECK(Set(_T("N"), _T(""), REG_NONE));
+		for (TCHAR name = _T('A'); name <= _T('L'); name++)
+		{
+			const TCHAR valueName[] = { _T('V'), name, 0 };
+			CHECK(Set(valueName, _T(""), REG_NONE));
+		}
+		CHECK(g_hive.Close(true));
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("VA"), type) == _T(""));
+		CHECK(type == REG_NONE);
+		CHECK(Set(_T("Path"), _T("C:\\New"), REG_EXPAND_SZ));
+		CHECK(g_hive.Close(true));
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("PATH"), type) == _T("C:\\New"));
+		CHECK(g_hive.Close(false));
+	}
+
+	void TestBigData()
+	{
+		DWORD envKey;
+		DWORD pathValue;
+		const Bytes before = UserHive(envKey, pathValue);
+		Store(before);
+		DWORD type;
+
+		// beyond 16344 bytes: "db" segments, in a bin added at the end
+		const Host::String big = MakeValue(20000);
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Set(_T("PATH"), big, REG_EXPAND_SZ));
+		CHECK(Get(_T("PATH"), type) == big);
+		CHECK(g_hive.Close(true));
+		const Bytes after = Load();
+		CHECK(after.size() > before.size());
+		CHECK(after.size() % 4096 == 0);
+		CHECK(Get32(after, 40) == after.size() - 4096);
+		CHECK(Get32(after, 508) == Checksum(after));
+
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("PATH"), type) == big);
+		CHECK(Set(_T("PATH"), _T("C:\\A"), REG_EXPAND_SZ));
+		CHECK(g_hive.Close(true));
+		CHECK(g_hive.Open(TestHive, false));
+		CHECK(Get(_T("PATH"), type) == _T("C:\\A"));
+		CHECK(Get(_T("TEMP"), type) == _T("C:\\Caf\xe9"));
+		CHECK(g_hive.Close(false));
+	}
+
+	void TestSystem()
+	{
+		DWORD type;
+
+		// the control set of "Select\Current", found through "ri", "li" and "lh" lists
+		Store(SystemHive(2));
+		CHECK(!g_hive.Open(TestHive, false));
+		CHECK(g_hive.Open(TestHive, true));
+		CHECK(Get(_T("Path"), type) == _T("C:\\Two"));
+		CHECK(Set(_T("Path"), _T("C:\\Two;C:\\More"), REG_EXPAND_SZ));
+		CHECK(g_hive.Close(true));
+		CHECK(g_hive.Open(TestHive, true));
+		CHECK(Get(_T("Path"), type) == _T("C:\\Two;C:\\More"));
+		CHECK(g_hive.Close(false));
+
+		Store(SystemHive(1));
+		CHECK(g_hive.Open(TestHive, true));
+		CHECK(Get(_T("Path"), type) == _T("C:\\One"));
+		CHECK(g_hive.Close(false));
+
+		// no such control set
+		Store(SystemHive(3));
+		CHECK(!g_hive.Open(TestHive, true));
+		CHECK(!g_hive.IsOpen());
+	}
+
+	void TestRefused()
+	{
+		DWORD envKey;
+		DWORD pathValue;
+		const Bytes good = UserHive(envKey, pathValue);
+
+		// sequence numbers differ: log entries are not applied
+		Bytes dirty = good;
+		Put32(dirty, 4, 2);
+		Put32(dirty, 508, Checksum(dirty));
+		Store(dirty);
+		CHECK(!g_hive.Open(TestHive, false));
+
+		Bytes checksum = good;
+		checksum[508] ^= 1;
+		Store(checksum);
+		CHECK(!g_hive.Open(TestHive, false));
+
+		// a cell running past its bin
+		Bytes overrun = good;
+		Put32(overrun, 4096 + envKey, static_cast<DWORD>(-8192));
+		Store(overrun);
+		CHECK(!g_hive.Open(TestHive, false));
+
+		Store(Bytes(good.begin(), good.begin() + 4096));
+		CHECK(!g_hive.Open(TestHive, false));
+
+		remove("OfflineHiveTest.dat");
+		CHECK(!g_hive.Open(TestHive, false));
+		CHECK(!g_hive.IsOpen());
+
+		// not open
+		DWORD type;
+		CHECK(Get(_T("PATH"), type) == _T("<error>"));
+		CHECK(!Set(_T("PATH"), _T("C:\\A"), REG_SZ));
+	}
+}
+
+int main()
+{
+	TestGetSet();
+	TestGrowAndDelete();
+	TestBigData();
+	TestSystem();
+	TestRefused();
+	remove("OfflineHiveTest.dat");
+	return Host::Summary("OfflineHiveTest");
+}
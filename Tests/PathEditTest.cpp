@@ -0,0 +1,146 @@
+//! @file PathEditTest.cpp
+//! @brief Edit and query kernels of "A", "P", "R", "D" and "C", instantiated for char and wchar_t by the A and W builds
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/NsisString.h"
+#include "../Utils/PathEdit.h"
+
+using namespace Utils;
+
+namespace
+{
+	//! Run an action with ExactMatch, and return the result, or "FAILED".
+	template <class Action>
+	Host::String Edit(LPCTSTR value, LPCTSTR yourPath)
+	{
+		ExactMatch matcher;
+		GrowString NewPathStr;
+		if (!EditPath<Action>(StrSpan::Of(value), StrSpan::Of(yourPath), NewPathStr, matcher))
+		{
+			return _T("FAILED");
+		}
+		return static_cast<LPCTSTR>(NewPathStr);
+	}
+
+	void TestAppendPrependRemove()
+	{
+		LPCTSTR value = _T("C:\\A;C:\\B;c:\\a;C:\\C");
+
+		// every entry equal to your path ignoring case is removed, and yours goes at the end or the front
+		CHECK(Edit<AppendAction>(value, _T("C:\\A")) == _T("C:\\B;C:\\C;C:\\A"));
+		CHECK(Edit<PrependAction>(value, _T("C:\\A")) == _T("C:\\A;C:\\B;C:\\C"));
+		CHECK(Edit<RemoveAction>(value, _T("C:\\A")) == _T("C:\\B;C:\\C"));
+
+		// ExactMatch compares the text: no trailing separator or slash direction is folded
+		CHECK(Edit<RemoveAction>(value, _T("C:\\A\\")) == value);
+		CHECK(Edit<RemoveAction>(value, _T("C:/A")) == value);
+
+		// empty value, and empty entries kept by all but "C"
+		CHECK(Edit<AppendAction>(_T(""), _T("C:\\A")) == _T("C:\\A"));
+		CHECK(Edit<PrependAction>(_T(""), _T("C:\\A")) == _T("C:\\A"));
+		CHECK(Edit<RemoveAction>(_T("C:\\A"), _T("C:\\A")) == _T(""));
+		CHECK(Edit<AppendAction>(_T("C:\\B;;C:\\C"), _T("C:\\A")) == _T("C:\\B;;C:\\C;C:\\A"));
+
+		// a trailing ';' gives no last empty entry
+		CHECK(Edit<RemoveAction>(_T("C:\\B;C:\\A;"), _T("C:\\A")) == _T("C:\\B"));
+	}
+
+	void TestDedupeCompact()
+	{
+		LPCTSTR value = _T(";C:\\A;C:\\B;;c:\\a;C:\\B;C:\\C;");
+
+		// the first of repeated entries is kept, and your path is not used.
+		// A leading empty entry is not written, as by AppendSeparated of any action.
+		CHECK(Edit<DedupeAction>(value, _T("C:\\C")) == _T("C:\\A;C:\\B;C:\\C"));
+		CHECK(Edit<DedupeAction>(_T("C:\\A;;C:\\B;;"), _T("")) == _T("C:\\A;;C:\\B"));
+		CHECK(Edit<CompactAction>(value, _T("")) == _T("C:\\A;C:\\B;C:\\C"));
+
+		const EditCounters counters = g_editCounters;
+		CHECK(Edit<CompactAction>(_T("C:\\A;;C:\\A"), _T("")) == _T("C:\\A"));
+		CHECK(g_editCounters.entriesScanned - counters.entriesScanned == 3);
+		CHECK(g_editCounters.entriesRemoved - counters.entriesRemoved == 2);
+		CHECK(g_editCounters.bytesRemoved - counters.bytesRemoved == (1 + 5) * sizeof(TCHAR));
+
+		// with ExactMatch nothing is tested for existence
+		CHECK(Edit<CompactMissingAction>(_T("C:\\Gone;C:\\Gone"), _T("/MISSING")) == _T("C:\\Gone"));
+	}
+
+	void TestLists()
+	{
+		LPCTSTR value = _T("C:\\A;C:\\B;C:\\C");
+
+		// a list is added once each, in the given order, and empty or repeated entries of it are skipped
+		CHECK(Edit<AppendAction>(value, _T("C:\\D;C:\\A;;c:\\d")) == _T("C:\\B;C:\\C;C:\\D;C:\\A"));
+		CHECK(Edit<PrependAction>(value, _T("C:\\C;C:\\E")) == _T("C:\\C;C:\\E;C:\\A;C:\\B"));
+		CHECK(Edit<RemoveAction>(value, _T("c:\\a;C:\\C;C:\\X")) == _T("C:\\B"));
+
+		// "D" never takes a list: the whole value is deduped
+		CHECK(Edit<DedupeAction>(_T("C:\\A;C:\\A"), _T("C:\\A;C:\\B")) == _T("C:\\A"));
+	}
+
+	void TestWideEntries()
+	{
+		// long ASCII prefixes go through the vector compare, and the rest through CaseFold
+		const Host::String prefix = _T("C:\\Program Files\\Some Vendor\\Some Long Product Name\\");
+		const Host::String upper = _T("C:\\PROGRAM FILES\\SOME VENDOR\\SOME LONG PRODUCT NAME\\");
+		const Host::String a = prefix + _T("Bin");
+		const Host::String b = upper + _T("BIN");
+		const Host::String c = prefix + _T("Lib");
+		const Host::String value = a + _T(";") + c + _T(";") + b;
+		CHECK(Edit<RemoveAction>(value.c_str(), b.c_str()) == c);
+		CHECK(Edit<DedupeAction>(value.c_str(), _T("")) == a + _T(";") + c);
+
+		// chars beyond ASCII are kept as they are, and only match themselves here
+		const Host::String accented = prefix + _T("Caf\xe9");
+		const Host::String other = prefix + _T("Caf\xe8");
+		const Host::String mixed = accented + _T(";") + other + _T(";") + accented;
+		CHECK(Edit<DedupeAction>(mixed.c_str(), _T("")) == accented + _T(";") + other);
+		CHECK(Edit<RemoveAction>(mixed.c_str(), other.c_str()) == accented + _T(";") + accented);
+	}
+
+	void TestFixedLength()
+	{
+		// NsisString does not grow: a result longer than g_stringsize fails, and nothing is overrun
+		const unsigned int stringSize = g_stringsize;
+		g_stringsize = 16;
+		{
+			ExactMatch matcher;
+			NsisString NewPathStr;
+			CHECK(EditPath<AppendAction>(StrSpan::Of(_T("C:\\A;C:\\B")), StrSpan::Of(_T("C:\\C")), NewPathStr, matcher));
+			CHECK(static_cast<LPCTSTR>(NewPathStr) == Host::String(_T("C:\\A;C:\\B;C:\\C")));
+			CHECK(!EditPath<AppendAction>(StrSpan::Of(_T("C:\\A;C:\\B;C:\\C")), StrSpan::Of(_T("C:\\D")), NewPathStr, matcher));
+			CHECK(NewPathStr.StringCharCount() <= 16);
+			CHECK(NewPathStr.msgbuf[16] == 0);
+		}
+		g_stringsize = stringSize;
+	}
+
+	void TestFindPath()
+	{
+		ExactMatch matcher;
+		size_t count = 0;
+		const StrSpan value = StrSpan::Of(_T("C:\\A;C:\\B;c:\\a;;C:\\C"));
+		CHECK(FindPath(value, StrSpan::Of(_T("C:\\A")), matcher, count) == 0);
+		CHECK(count == 2);
+		CHECK(FindPath(value, StrSpan::Of(_T("C:\\C")), matcher, count) == 4);
+		CHECK(count == 1);
+		CHECK(FindPath(value, StrSpan::Of(_T("")), matcher, count) == 3);
+		CHECK(count == 1);
+		CHECK(FindPath(value, StrSpan::Of(_T("C:\\X")), matcher, count) == PathNotFound);
+		CHECK(count == 0);
+	}
+}
+
+int main()
+{
+	TestAppendPrependRemove();
+	TestDedupeCompact();
+	TestLists();
+	TestWideEntries();
+	TestFixedLength();
+	TestFindPath();
+	return Host::Summary("PathEditTest");
+}
@@ -0,0 +1,215 @@
+//! @file PathNormalizerTest.cpp
+//! @brief PathNormalizer keys and directory tests, with %VAR% resolved by a stub GetVariableProc
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/PathEdit.h"
+
+#include <map>
+
+using namespace Utils;
+
+namespace
+{
+	//! Variables of the stub, by upper case name
+	struct StubVariables
+	{
+		std::map<Host::String, Host::String> values;
+
+		//! getVariable calls
+		size_t calls;
+
+		//! if not empty, this variable gets longer by one char after the next call, as if set in between
+		Host::String growing;
+	};
+
+	//! Stub of GetVariableProc over StubVariables
+	DWORD StubGetVariable(void *context, LPCTSTR name, LPTSTR buffer, DWORD size)
+	{
+		StubVariables *stub = static_cast<StubVariables *>(context);
+		stub->calls++;
+		Host::String upper(name);
+		for (TCHAR &c : upper)
+		{
+			c = (c >= _T('a') && c <= _T('z')) ? static_cast<TCHAR>(c - _T('a') + _T('A')) : c;
+		}
+		auto found = stub->values.find(upper);
+		if (found == stub->values.end())
+		{
+			return 0;
+		}
+		const Host::String value = found->second;
+		if (upper == stub->growing)
+		{
+			found->second += _T('x');
+			stub->growing.clear();
+		}
+		if (size <= value.size())
+		{
+			return static_cast<DWORD>(value.size() + 1);
+		}
+		lstrcpy(buffer, value.c_str());
+		return static_cast<DWORD>(value.size());
+	}
+
+	//! Key of entry, as a string.
+	Host::String Key(PathNormalizer &normalizer, LPCTSTR entry)
+	{
+		const StrSpan key = normalizer.Key(StrSpan::Of(entry));
+		return Host::String(key.ptr, key.len);
+	}
+
+	void TestPathKeys()
+	{
+		PathNormalizer normalizer(NormalizePath);
+		StubVariables stub = {};
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		CHECK(Key(normalizer, _T("C:/Tools/bin/")) == _T("C:\\Tools\\bin"));
+		CHECK(Key(normalizer, _T("C:\\Tools\\bin\\\\")) == _T("C:\\Tools\\bin"));
+		CHECK(Key(normalizer, _T("C:\\")) == _T("C:\\"));
+		CHECK(Key(normalizer, _T("C:/")) == _T("C:\\"));
+		CHECK(Key(normalizer, _T("/")) == _T("\\"));
+
+		// not expanded in NormalizePath
+		CHECK(Key(normalizer, _T("%ROOT%\\bin")) == _T("%ROOT%\\bin"));
+		CHECK(stub.calls == 0);
+
+		// nothing to normalize: the entry itself
+		LPCTSTR plain = _T("C:\\Tools");
+		CHECK(normalizer.Key(StrSpan::Of(plain)).ptr == plain);
+	}
+
+	void TestNoneKeys()
+	{
+		PathNormalizer normalizer(NormalizeNone);
+		StubVariables stub = {};
+		stub.values[_T("ROOT")] = _T("C:\\Tools");
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		// entries as they are: slashes, trailing separators and %VAR% are kept
+		LPCTSTR slashed = _T("C:/Tools/bin/");
+		CHECK(normalizer.Key(StrSpan::Of(slashed)).ptr == slashed);
+		CHECK(Key(normalizer, _T("%ROOT%\\bin\\")) == _T("%ROOT%\\bin\\"));
+		CHECK(stub.calls == 0);
+	}
+
+	void TestExpandKeys()
+	{
+		PathNormalizer normalizer(NormalizeExpand);
+		StubVariables stub = {};
+		stub.values[_T("ROOT")] = _T("C:\\Tools");
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		CHECK(Key(normalizer, _T("%ROOT%\\bin")) == _T("C:\\Tools\\bin"));
+		CHECK(Key(normalizer, _T("%root%/bin/")) == _T("C:\\Tools\\bin"));
+		CHECK(Key(normalizer, _T("%ROOT%%ROOT%")) == _T("C:\\ToolsC:\\Tools"));
+
+		// undefined, empty name and unterminated are kept
+		CHECK(Key(normalizer, _T("%NOPE%\\bin")) == _T("%NOPE%\\bin"));
+		CHECK(Key(normalizer, _T("C:\\%%\\bin")) == _T("C:\\%%\\bin"));
+		CHECK(Key(normalizer, _T("C:\\%ROOT")) == _T("C:\\%ROOT"));
+
+		// each variable is resolved once: probe and copy for defined, probe for undefined
+		CHECK(normalizer.resolves == 2);
+		CHECK(stub.calls == 3);
+		const size_t calls = stub.calls;
+		for (int round = 0; round < 100; round++)
+		{
+			Key(normalizer, _T("%ROOT%\\bin"));
+			Key(normalizer, _T("%Nope%\\bin"));
+		}
+		CHECK(stub.calls == calls);
+		CHECK(normalizer.resolves == 2);
+	}
+
+	void TestGrowingVariable()
+	{
+		PathNormalizer normalizer(NormalizeExpand);
+		StubVariables stub = {};
+		stub.values[_T("GROW")] = _T("C:\\G");
+		stub.growing = _T("GROW");
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		// longer at the copy than at the probe: copied again with the new size
+		CHECK(Key(normalizer, _T("%GROW%\\bin")) == _T("C:\\Gx\\bin"));
+		CHECK(stub.calls == 3);
+	}
+
+	void TestEditPath()
+	{
+		PathNormalizer normalizer(NormalizeExpand);
+		StubVariables stub = {};
+		stub.values[_T("ROOT")] = _T("C:\\Tools");
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		const StrSpan value = StrSpan::Of(_T("%ROOT%\\bin;C:\\A;c:/tools/BIN/;%ROOT%\\lib"));
+		GrowString removed;
+		CHECK(EditPath<RemoveAction>(value, StrSpan::Of(_T("C:\\Tools\\bin\\")), removed, normalizer));
+		CHECK(static_cast<LPCTSTR>(removed) == Host::String(_T("C:\\A;%ROOT%\\lib")));
+
+		// entries are written as is: the first of equal keys is kept
+		GrowString deduped;
+		CHECK(EditPath<DedupeAction>(value, StrSpan::Of(_T("")), deduped, normalizer));
+		CHECK(static_cast<LPCTSTR>(deduped) == Host::String(_T("%ROOT%\\bin;C:\\A;%ROOT%\\lib")));
+		CHECK(normalizer.resolves == 1);
+	}
+
+	void TestExists()
+	{
+		Host::DirectoryClear();
+		Host::DirectoryPut(_T("C:\\Tools\\bin"));
+		PathNormalizer normalizer(NormalizeNone);
+		StubVariables stub = {};
+		stub.values[_T("ROOT")] = _T("C:\\Tools");
+		normalizer.getVariable = StubGetVariable;
+		normalizer.context = &stub;
+
+		// %VAR% is expanded for the test regardless of mode, and each distinct directory is tested once
+		const size_t attributes = Host::g_win32.fileAttributes;
+		CHECK(normalizer.Exists(StrSpan::Of(_T("%ROOT%\\bin"))));
+		CHECK(normalizer.Exists(StrSpan::Of(_T("c:/tools/bin/"))));
+		CHECK(!normalizer.Exists(StrSpan::Of(_T("C:\\Gone"))));
+		CHECK(!normalizer.Exists(StrSpan::Of(_T("c:\\gone\\"))));
+		CHECK(Host::g_win32.fileAttributes - attributes == 2);
+		CHECK(normalizer.probes == 2);
+
+		// undefined %VAR%: assumed to exist, not tested
+		CHECK(normalizer.Exists(StrSpan::Of(_T("%NOPE%\\bin"))));
+		CHECK(normalizer.probes == 2);
+
+		const StrSpan value = StrSpan::Of(_T("%ROOT%\\bin;;C:\\Gone;C:\\TOOLS\\BIN;%NOPE%"));
+		GrowString compacted;
+		CHECK(EditPath<CompactMissingAction>(value, StrSpan::Of(_T("/MISSING")), compacted, normalizer));
+		CHECK(static_cast<LPCTSTR>(compacted) == Host::String(_T("%ROOT%\\bin;C:\\TOOLS\\BIN;%NOPE%")));
+
+		// "/MISSING" tests directories by expanded key, but matches duplicates as "C" without it does
+		Host::DirectoryPut(_T("C:\\A"));
+		const StrSpan spelled = StrSpan::Of(_T("C:\\A;C:/A;c:\\a"));
+		GrowString compact;
+		CHECK(EditPath<CompactAction>(spelled, StrSpan::Of(_T("")), compact, normalizer));
+		CHECK(static_cast<LPCTSTR>(compact) == Host::String(_T("C:\\A;C:/A")));
+		GrowString compactMissing;
+		CHECK(EditPath<CompactMissingAction>(spelled, StrSpan::Of(_T("/MISSING")), compactMissing, normalizer));
+		CHECK(static_cast<LPCTSTR>(compactMissing) == Host::String(_T("C:\\A;C:/A")));
+		Host::DirectoryClear();
+	}
+}
+
+int main()
+{
+	TestPathKeys();
+	TestNoneKeys();
+	TestExpandKeys();
+	TestGrowingVariable();
+	TestEditPath();
+	TestExists();
+	return Host::Summary("PathNormalizerTest");
+}
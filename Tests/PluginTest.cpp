@@ -0,0 +1,593 @@
+//! @file PluginTest.cpp
+//! @brief EnvVarUpdate and EnvVarUpdateBatch called through the NSIS stack, as an installer does
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "NsisHost.h"
+#include "Win32Host.h"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace Host;
+
+namespace
+{
+	//! Decimal text of value.
+	String Int(size_t value)
+	{
+		TCHAR text[32];
+		wsprintf(text, _T("%u"), static_cast<UINT>(value));
+		return text;
+	}
+
+	//! Value of HKCU, or "<none>".
+	String HKCU(LPCTSTR name)
+	{
+		DWORD type;
+		String value;
+		return RegistryGet(HKEY_CURRENT_USER, name, type, value) ? value : _T("<none>");
+	}
+
+	void TestEnvVarUpdate()
+	{
+		RegistryClear();
+		Installer installer;
+
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("P"), _T("HKCU"), _T("C:\\A") });
+		CHECK(installer.Pop() == _T("C:\\A"));
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("A"), _T("HKCU"), _T("C:\\B") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B"));
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("A"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B;C:\\C"));
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("R"), _T("HKCU"), _T("c:\\b") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\C"));
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("P"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Pop() == _T("C:\\C;C:\\A"));
+		CHECK(!installer.IfErrors());
+		CHECK(HKCU(_T("MyPath")) == _T("C:\\C;C:\\A"));
+		CHECK(installer.Depth() == 0);
+
+		// unknown action: error, and an empty result keeps the stack balanced
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("Q"), _T("HKCU"), _T("C:\\C") });
+		installer.Pop();
+		CHECK(installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+		CHECK(HKCU(_T("MyPath")) == _T("C:\\C;C:\\A"));
+	}
+
+	void TestEnvVarUpdateLoop()
+	{
+		RegistryClear();
+		Installer installer;
+		installer.Push(_T("caller's"));
+
+		const PluginApiCounters before = g_pluginApi;
+		const size_t calls = 1000;
+		for (size_t call = 0; call < calls; call++)
+		{
+			TCHAR path[32];
+			wsprintf(path, _T("C:\\Tool%u"), static_cast<UINT>(call % 50));
+			installer.Call(EnvVarUpdate, { _T("LoopPath"), (call % 3 == 2) ? _T("R") : _T("A"), _T("HKCU"), path });
+			String result;
+			CHECK(installer.Pop(result));
+		}
+
+		// 4 args and 1 result per call
+		CHECK(g_pluginApi.pushes - before.pushes == calls * 5);
+		CHECK(g_pluginApi.pops - before.pops == calls * 5);
+		CHECK(g_pluginApi.underflows == before.underflows);
+		CHECK(g_pluginApi.entryAllocs - before.entryAllocs == g_pluginApi.entryFrees - before.entryFrees);
+		CHECK(g_pluginApi.entryBytes - before.entryBytes == calls * 5 * (sizeof(stack_t) + 1024 * sizeof(TCHAR)));
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Pop() == _T("caller's"));
+		CHECK(installer.HasCallback());
+	}
+
+	void TestEnvVarUpdateBatch()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\Old;C:\\Keep"));
+		Installer installer;
+
+		installer.Call(EnvVarUpdateBatch, {
+			_T("PATH"), _T("A"), _T("HKCU"), _T("C:\\New\\bin"),
+			_T("PATH"), _T("R"), _T("HKCU"), _T("C:\\Old"),
+			_T("LIB"), _T("P"), _T("HKCU"), _T("C:\\New\\lib"),
+			_T("/END"),
+		});
+		CHECK(installer.Pop() == _T("2"));
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+		CHECK(HKCU(_T("PATH")) == _T("C:\\Keep;C:\\New\\bin"));
+		CHECK(HKCU(_T("LIB")) == _T("C:\\New\\lib"));
+
+		// the same batch again writes nothing
+		const size_t writes = g_win32.regWrites;
+		for (int round = 0; round < 100; round++)
+		{
+			installer.Call(EnvVarUpdateBatch, {
+				_T("PATH"), _T("A"), _T("HKCU"), _T("C:\\New\\bin"),
+				_T("PATH"), _T("R"), _T("HKCU"), _T("C:\\Old"),
+				_T("LIB"), _T("P"), _T("HKCU"), _T("C:\\New\\lib"),
+				_T("/END"),
+			});
+			CHECK(installer.Pop() == _T("0"));
+		}
+		CHECK(g_win32.regWrites == writes);
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+	}
+
+	void TestEnvVarUpdateBatchWithoutEnd()
+	{
+		RegistryClear();
+		Installer installer;
+		installer.Push(_T("caller's"));
+
+		// no "/END": nothing is applied, and the stack is left as it was, under the pushed count
+		installer.Call(EnvVarUpdateBatch, {
+			_T("PATH"), _T("A"), _T("HKCU"), _T("C:\\A"),
+		});
+		CHECK(installer.Pop() == _T("0"));
+		CHECK(installer.IfErrors());
+		CHECK(HKCU(_T("PATH")) == _T("<none>"));
+		CHECK(installer.Depth() == 5);
+		CHECK(installer.Pop() == _T("PATH"));
+		CHECK(installer.Pop() == _T("A"));
+		CHECK(installer.Pop() == _T("HKCU"));
+		CHECK(installer.Pop() == _T("C:\\A"));
+		CHECK(installer.Pop() == _T("caller's"));
+	}
+
+	//! Counter of GetCounter.
+	String Counter(Installer &installer, LPCTSTR name)
+	{
+		installer.Call(GetCounter, { name });
+		return installer.Pop();
+	}
+
+	void TestCompactCounters()
+	{
+		RegistryClear();
+		DirectoryClear();
+		DirectoryPut(_T("C:\\A"));
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\A;;c:\\a;C:/A;C:\\Gone;C:\\A"));
+		Installer installer;
+
+		// removed by this call only, readable right after it
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("C"), _T("HKCU"), _T("/MISSING") });
+		CHECK(installer.Pop() == _T("C:\\A;C:/A"));
+		CHECK(Counter(installer, _T("LastEntriesRemoved")) == _T("4"));
+		CHECK(Counter(installer, _T("LastBytesRemoved")) == Int((1 + 5 + 8 + 5) * sizeof(TCHAR)));
+
+		// GetCounter itself does not reset them
+		CHECK(Counter(installer, _T("LastEntriesRemoved")) == _T("4"));
+
+		// an unchanged value removes nothing
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("C"), _T("HKCU"), _T("/MISSING") });
+		CHECK(installer.Pop() == _T("C:\\A;C:/A"));
+		CHECK(Counter(installer, _T("LastEntriesRemoved")) == _T("0"));
+		CHECK(Counter(installer, _T("LastBytesRemoved")) == _T("0"));
+
+		// a batch reports its removals together, and the totals keep counting
+		const String total = Counter(installer, _T("EntriesRemoved"));
+		installer.Call(EnvVarUpdateBatch, {
+			_T("PATH"), _T("R"), _T("HKCU"), _T("C:/A"),
+			_T("LIB"), _T("P"), _T("HKCU"), _T("C:\\L"),
+			_T("/END"),
+		});
+		CHECK(installer.Pop() == _T("2"));
+		CHECK(Counter(installer, _T("LastEntriesRemoved")) == _T("1"));
+		CHECK(Counter(installer, _T("EntriesRemoved")) == Int(std::stoul(total) + 1));
+		CHECK(!installer.IfErrors());
+		DirectoryClear();
+	}
+
+	void TestUnload()
+	{
+		RegistryClear();
+		const size_t live = g_win32.bytesLive;
+		{
+			Installer installer;
+			installer.Call(EnvVarUpdate, { _T("MyPath"), _T("A"), _T("HKCU"), _T("C:\\A") });
+			installer.Pop();
+			CHECK(installer.HasCallback());
+			CHECK(g_win32.bytesLive > live);
+		}
+		// NSPIM_UNLOAD releases the arena and the keys
+		CHECK(g_win32.bytesLive == live);
+		CHECK(g_win32.regOpens == g_win32.regCloses);
+
+		// a new installer registers the callback again
+		Installer installer;
+		installer.Call(EnvVarUpdate, { _T("MyPath"), _T("A"), _T("HKCU"), _T("C:\\B") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B"));
+		CHECK(installer.HasCallback());
+	}
+
+	void TestKeyReuse()
+	{
+		RegistryClear();
+		Installer installer;
+
+		// the first update opens the key to read and to write, once each
+		const size_t start = std::stoul(Counter(installer, _T("KeyOpens")));
+		const size_t regOpens = g_win32.regOpens;
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\A") });
+		CHECK(installer.Pop() == _T("C:\\A"));
+		const size_t first = std::stoul(Counter(installer, _T("KeyOpens"))) - start;
+		CHECK(first == 2);
+		CHECK(g_win32.regOpens - regOpens == first);
+
+		// later updates of the same key reuse both handles
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\B") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B"));
+		installer.Call(EnvVarUpdate, { _T("LIB"), _T("A"), _T("HKCU"), _T("C:\\L") });
+		CHECK(installer.Pop() == _T("C:\\L"));
+		CHECK(std::stoul(Counter(installer, _T("KeyOpens"))) - start == first);
+		CHECK(g_win32.regOpens - regOpens == first);
+
+		// another hive has its own handles
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKLM"), _T("C:\\S") });
+		installer.Pop();
+		CHECK(std::stoul(Counter(installer, _T("KeyOpens"))) - start == 2 * first);
+		CHECK(!installer.IfErrors());
+	}
+
+	void TestCacheCounters()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\A"));
+		Installer installer;
+		const size_t hits = std::stoul(Counter(installer, _T("CacheHits")));
+		const size_t misses = std::stoul(Counter(installer, _T("CacheMisses")));
+
+		// read once, and then remembered with the written value
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\B") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B"));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B;C:\\C"));
+		CHECK(std::stoul(Counter(installer, _T("CacheMisses"))) - misses == 1);
+		CHECK(std::stoul(Counter(installer, _T("CacheHits"))) - hits == 1);
+
+		// written by another process: read again, and its value is edited
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\X"));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\D") });
+		CHECK(installer.Pop() == _T("C:\\X;C:\\D"));
+		CHECK(std::stoul(Counter(installer, _T("CacheMisses"))) - misses == 2);
+		CHECK(HKCU(_T("PATH")) == _T("C:\\X;C:\\D"));
+		CHECK(!installer.IfErrors());
+	}
+
+	//! Result pushed by a query export.
+	String Query(Installer &installer, PluginFunction function, LPCTSTR name, LPCTSTR regLoc, LPCTSTR path)
+	{
+		installer.Call(function, { name, regLoc, path });
+		return installer.Pop();
+	}
+
+	void TestQueries()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_LOCAL_MACHINE, _T("PATH"), REG_EXPAND_SZ, _T("C:\\Windows;C:\\Tool;c:\\windows;C:\\Other"));
+		RegistryReadOnly(true);
+		Installer installer;
+		const String writes = Counter(installer, _T("Writes"));
+		const size_t regWrites = g_win32.regWrites;
+
+		// present once, present twice ignoring case, and absent
+		CHECK(Query(installer, Contains, _T("PATH"), _T("HKLM"), _T("C:\\Tool")) == _T("1"));
+		CHECK(Query(installer, IndexOf, _T("PATH"), _T("HKLM"), _T("C:\\Tool")) == _T("1"));
+		CHECK(Query(installer, Count, _T("PATH"), _T("HKLM"), _T("C:\\Tool")) == _T("1"));
+		CHECK(Query(installer, Contains, _T("PATH"), _T("HKLM"), _T("C:\\WINDOWS")) == _T("1"));
+		CHECK(Query(installer, IndexOf, _T("PATH"), _T("HKLM"), _T("C:\\WINDOWS")) == _T("0"));
+		CHECK(Query(installer, Count, _T("PATH"), _T("HKLM"), _T("C:\\WINDOWS")) == _T("2"));
+		CHECK(Query(installer, Contains, _T("PATH"), _T("HKLM"), _T("C:\\Gone")) == _T("0"));
+		CHECK(Query(installer, IndexOf, _T("PATH"), _T("HKLM"), _T("C:\\Gone")) == _T("-1"));
+		CHECK(Query(installer, Count, _T("PATH"), _T("HKLM"), _T("C:\\Gone")) == _T("0"));
+
+		// a missing value has no entries
+		CHECK(Query(installer, Contains, _T("LIB"), _T("HKLM"), _T("C:\\Tool")) == _T("0"));
+		CHECK(Query(installer, IndexOf, _T("LIB"), _T("HKLM"), _T("C:\\Tool")) == _T("-1"));
+		CHECK(Query(installer, Count, _T("LIB"), _T("HKLM"), _T("C:\\Tool")) == _T("0"));
+
+		// read only: KEY_READ is enough, and nothing is written
+		CHECK(!installer.IfErrors());
+		CHECK(Counter(installer, _T("Writes")) == writes);
+		CHECK(g_win32.regWrites == regWrites);
+		CHECK(installer.Depth() == 0);
+
+		// an update needs a key opened for write
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKLM"), _T("C:\\New") });
+		installer.Pop();
+		CHECK(installer.IfErrors());
+		RegistryReadOnly(false);
+
+		// an unknown RegLoc is an error, and keeps the stack balanced
+		CHECK(Query(installer, Count, _T("PATH"), _T("HKXX"), _T("C:\\Tool")) == _T("0"));
+		CHECK(installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+	}
+
+	void TestResultModes()
+	{
+		RegistryClear();
+		Installer installer;
+		installer.Push(_T("caller's"));
+
+		installer.Call(SetOption, { _T("Result"), _T("Status") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\A") });
+		CHECK(installer.Pop() == _T("changed"));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\A") });
+		CHECK(installer.Pop() == _T("unchanged"));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("Q"), _T("HKCU"), _T("C:\\A") });
+		CHECK(installer.Pop() == _T("error"));
+		CHECK(installer.IfErrors());
+
+		installer.Call(SetOption, { _T("Result"), _T("Length") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\B") });
+		CHECK(installer.Pop() == _T("9"));
+
+		// nothing pushed: the caller's string is on top
+		installer.Call(SetOption, { _T("Result"), _T("None") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Depth() == 1);
+		CHECK(HKCU(_T("PATH")) == _T("C:\\A;C:\\B;C:\\C"));
+
+		// an unknown mode keeps the last one
+		installer.Call(SetOption, { _T("Result"), _T("Everything") });
+		CHECK(installer.IfErrors());
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("R"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Depth() == 1);
+
+		installer.Call(SetOption, { _T("Result"), _T("Value") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B;C:\\C"));
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Pop() == _T("caller's"));
+	}
+
+	void TestResultVar()
+	{
+		RegistryClear();
+		Installer installer;
+		installer.Push(_T("caller's"));
+
+		// written to the variable, and nothing pushed
+		struct { LPCTSTR name; int index; } const variables[] = {
+			{ _T("R0"), INST_R0 }, { _T("$R0"), INST_R0 }, { _T("r9"), INST_R9 }, { _T("0"), INST_0 }, { _T("$0"), INST_0 }, { _T("$9"), INST_9 },
+		};
+		for (const auto &variable : variables)
+		{
+			installer.SetVariable(variable.index, _T("old"));
+			installer.Call(SetOption, { _T("ResultVar"), variable.name });
+			CHECK(!installer.IfErrors());
+			installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), variable.name });
+			CHECK(installer.Depth() == 1);
+			CHECK(installer.Variable(variable.index) == HKCU(_T("PATH")));
+		}
+
+		// the status goes to the variable too
+		installer.Call(SetOption, { _T("Result"), _T("Status") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("$9") });
+		CHECK(installer.Variable(INST_9) == _T("unchanged"));
+		installer.Call(SetOption, { _T("Result"), _T("Value") });
+
+		// not a user variable: error, and the last choice is kept
+		for (LPCTSTR name : { _T("$R10"), _T("$X"), _T(""), _T("R"), _T("$"), _T("10") })
+		{
+			installer.Call(SetOption, { _T("ResultVar"), name });
+			CHECK(installer.IfErrors());
+		}
+		installer.SetVariable(INST_9, _T("old"));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\X") });
+		CHECK(installer.Variable(INST_9) == HKCU(_T("PATH")));
+		CHECK(installer.Depth() == 1);
+
+		// back to the stack
+		installer.Call(SetOption, { _T("ResultVar"), _T("Stack") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("R"), _T("HKCU"), _T("C:\\X") });
+		CHECK(installer.Pop() == HKCU(_T("PATH")));
+		CHECK(installer.Variable(INST_9) != HKCU(_T("PATH")));
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Pop() == _T("caller's"));
+	}
+
+	void TestTruncations()
+	{
+		RegistryClear();
+		String longPath;
+		while (longPath.size() < 1100)
+		{
+			longPath += _T("C:\\Long\\Directory;");
+		}
+		longPath.pop_back();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, longPath);
+		Installer installer;
+		const size_t truncations = std::stoul(Counter(installer, _T("Truncations")));
+
+		// the value is written whole, and pushed cut to NSIS_MAX_STRLEN - 1 chars
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\New") });
+		CHECK(installer.Pop() == (longPath + _T(";C:\\New")).substr(0, 1023));
+		CHECK(HKCU(_T("PATH")) == longPath + _T(";C:\\New"));
+		CHECK(std::stoul(Counter(installer, _T("Truncations"))) - truncations == 1);
+
+		// a length fits
+		installer.Call(SetOption, { _T("Result"), _T("Length") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("R"), _T("HKCU"), _T("C:\\New") });
+		CHECK(installer.Pop() == Int(longPath.size()));
+		CHECK(std::stoul(Counter(installer, _T("Truncations"))) - truncations == 1);
+		installer.Call(SetOption, { _T("Result"), _T("Value") });
+
+		// a short value is not cut
+		installer.Call(EnvVarUpdate, { _T("LIB"), _T("A"), _T("HKCU"), _T("C:\\L") });
+		CHECK(installer.Pop() == _T("C:\\L"));
+		CHECK(std::stoul(Counter(installer, _T("Truncations"))) - truncations == 1);
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+	}
+
+	//! "name=value" pairs of a GetStats line, in order.
+	typedef std::vector<std::pair<String, size_t>> StatsFields;
+
+	//! Split a GetStats line.
+	StatsFields ParseStats(const String &line)
+	{
+		StatsFields fields;
+		for (size_t start = 0; start < line.size(); )
+		{
+			size_t end = line.find(_T(' '), start);
+			end = (end == String::npos) ? line.size() : end;
+			const size_t equal = line.find(_T('='), start);
+			if (equal == String::npos || equal > end)
+			{
+				fields.push_back(std::make_pair(line.substr(start, end - start), static_cast<size_t>(-1)));
+			}
+			else
+			{
+				fields.push_back(std::make_pair(line.substr(start, equal - start), std::stoul(line.substr(equal + 1, end - equal - 1))));
+			}
+			start = end + 1;
+		}
+		return fields;
+	}
+
+	//! Field of a GetStats line, or -1.
+	size_t Field(const StatsFields &fields, LPCTSTR name)
+	{
+		for (const auto &field : fields)
+		{
+			if (field.first == name)
+			{
+				return field.second;
+			}
+		}
+		return static_cast<size_t>(-1);
+	}
+
+	//! Line pushed by GetStats.
+	String Stats(Installer &installer)
+	{
+		installer.Call(GetStats);
+		return installer.Pop();
+	}
+
+	void TestStats()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\A;C:\\B"));
+		Installer installer;
+		installer.Call(SetOption, { _T("Stats"), _T("On") });
+		CHECK(!installer.IfErrors());
+
+		const StatsFields before = ParseStats(Stats(installer));
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\C") });
+		CHECK(installer.Pop() == _T("C:\\A;C:\\B;C:\\C"));
+		const StatsFields after = ParseStats(Stats(installer));
+
+		// every field, in order
+		LPCTSTR const names[] = {
+			_T("reads"), _T("get_us"), _T("transforms"), _T("transform_us"), _T("writes"), _T("set_us"),
+			_T("bytes_read"), _T("bytes_written"), _T("entries"), _T("allocations"), _T("bytes_used"),
+		};
+		CHECK(after.size() == sizeof(names) / sizeof(names[0]));
+		for (size_t index = 0; index < after.size() && index < sizeof(names) / sizeof(names[0]); index++)
+		{
+			CHECK(after[index].first == names[index]);
+			CHECK(after[index].second != static_cast<size_t>(-1));
+		}
+
+		// one read, edit and write of the value
+		CHECK(Field(after, _T("reads")) - Field(before, _T("reads")) == 1);
+		CHECK(Field(after, _T("transforms")) - Field(before, _T("transforms")) == 1);
+		CHECK(Field(after, _T("writes")) - Field(before, _T("writes")) == 1);
+		CHECK(Field(after, _T("bytes_read")) - Field(before, _T("bytes_read")) == 9 * sizeof(TCHAR));
+		CHECK(Field(after, _T("bytes_written")) - Field(before, _T("bytes_written")) == 14 * sizeof(TCHAR));
+		CHECK(Field(after, _T("entries")) > Field(before, _T("entries")));
+		CHECK(Field(after, _T("get_us")) >= Field(before, _T("get_us")));
+		CHECK(Field(after, _T("transform_us")) >= Field(before, _T("transform_us")));
+		CHECK(Field(after, _T("set_us")) >= Field(before, _T("set_us")));
+
+		// times stop with "Off", and counters go on
+		installer.Call(SetOption, { _T("Stats"), _T("Off") });
+		installer.Call(EnvVarUpdate, { _T("PATH"), _T("R"), _T("HKCU"), _T("C:\\C") });
+		installer.Pop();
+		const StatsFields off = ParseStats(Stats(installer));
+		CHECK(Field(off, _T("reads")) - Field(after, _T("reads")) == 1);
+		CHECK(Field(off, _T("get_us")) == Field(after, _T("get_us")));
+		CHECK(Field(off, _T("transform_us")) == Field(after, _T("transform_us")));
+		CHECK(Field(off, _T("set_us")) == Field(after, _T("set_us")));
+		CHECK(!installer.IfErrors());
+		CHECK(installer.Depth() == 0);
+	}
+
+	void TestStatsLog()
+	{
+		remove("PluginTest.stats.log");
+		RegistryClear();
+		String line;
+		{
+			Installer installer;
+			installer.Call(SetOption, { _T("StatsLog"), _T("PluginTest.stats.log") });
+			installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\A") });
+			installer.Pop();
+			line = Stats(installer);
+			CHECK(!installer.IfErrors());
+		}
+
+		// NSPIM_UNLOAD appends the GetStats line
+		FILE *file = fopen("PluginTest.stats.log", "rb");
+		CHECK(file != nullptr);
+		std::string written;
+		for (int oneChar; file != nullptr && (oneChar = fgetc(file)) != EOF; )
+		{
+			written += static_cast<char>(oneChar);
+		}
+		if (file != nullptr)
+		{
+			fclose(file);
+		}
+		CHECK(written == std::string(line.begin(), line.end()) + "\r\n");
+
+		// "" writes no more
+		{
+			Installer installer;
+			installer.Call(SetOption, { _T("StatsLog"), _T("") });
+			CHECK(!installer.IfErrors());
+		}
+		file = fopen("PluginTest.stats.log", "rb");
+		size_t length = 0;
+		while (file != nullptr && fgetc(file) != EOF)
+		{
+			length++;
+		}
+		if (file != nullptr)
+		{
+			fclose(file);
+		}
+		CHECK(length == written.size());
+		remove("PluginTest.stats.log");
+	}
+}
+
+int main()
+{
+	TestEnvVarUpdate();
+	TestEnvVarUpdateLoop();
+	TestEnvVarUpdateBatch();
+	TestEnvVarUpdateBatchWithoutEnd();
+	TestCompactCounters();
+	TestUnload();
+	TestKeyReuse();
+	TestCacheCounters();
+	TestQueries();
+	TestResultModes();
+	TestTruncations();
+	TestResultVar();
+	TestStats();
+	TestStatsLog();
+	return Summary("PluginTest");
+}
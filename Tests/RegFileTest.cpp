@@ -0,0 +1,322 @@
+//! @file RegFileTest.cpp
+//! @brief RegFile and RegStream over UTF-16 and ANSI .reg files: same bytes for the same edits, writes in place, and bounded buffers
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/RegFile.h"
+#include "../Utils/RegStream.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace Utils;
+
+namespace
+{
+	//! file edited by the tests, in the current directory
+	LPCWSTR const InPath = L"RegFileTest.reg";
+
+	//! file written by RegStream
+	LPCWSTR const OutPath = L"RegFileTest.out.reg";
+
+	//! RegFile of the tests, zero initialized as the plugin globals are
+	RegFile g_regFile;
+
+	//! RegStream of the tests
+	RegStream g_stream;
+
+	typedef std::vector<BYTE> Bytes;
+
+	//! Narrow path of the tests.
+	std::string Narrow(LPCWSTR path)
+	{
+		std::string narrow;
+		for (; *path != 0; path++)
+		{
+			narrow += static_cast<char>(*path);
+		}
+		return narrow;
+	}
+
+	//! Text as file bytes: UTF-16LE with BOM, or Latin-1 as the host code page.
+	Bytes Encode(const std::wstring &text, bool unicode)
+	{
+		Bytes bytes;
+		if (unicode)
+		{
+			bytes.push_back(0xFF);
+			bytes.push_back(0xFE);
+		}
+		for (wchar_t oneChar : text)
+		{
+			bytes.push_back(static_cast<BYTE>(oneChar & 0xFF));
+			if (unicode)
+			{
+				bytes.push_back(static_cast<BYTE>((oneChar >> 8) & 0xFF));
+			}
+		}
+		return bytes;
+	}
+
+	//! Write file.
+	void Store(LPCWSTR path, const Bytes &bytes)
+	{
+		FILE *file = fopen(Narrow(path).c_str(), "wb");
+		fwrite(bytes.data(), 1, bytes.size(), file);
+		fclose(file);
+	}
+
+	//! Read file, or "<none>" as bytes if missing.
+	Bytes Load(LPCWSTR path)
+	{
+		FILE *file = fopen(Narrow(path).c_str(), "rb");
+		if (file == nullptr)
+		{
+			return Encode(L"<none>", false);
+		}
+		Bytes bytes;
+		for (int oneByte; (oneByte = fgetc(file)) != EOF; )
+		{
+			bytes.push_back(static_cast<BYTE>(oneByte));
+		}
+		fclose(file);
+		return bytes;
+	}
+
+	//! Edit of the tests.
+	RegEdit Edit(LPCWSTR name, LPCTSTR action, bool system, LPCTSTR path)
+	{
+		RegEdit edit = { name, action, system, path };
+		return edit;
+	}
+
+	//! Apply edits with RegStream from InPath to OutPath.
+	RegStreamResult Stream(const std::vector<RegEdit> &edits, LPCWSTR outPath = OutPath, size_t maxEntryBytes = 0)
+	{
+		PathNormalizer normalizer(NormalizeNone);
+		g_stream.edits = edits.data();
+		g_stream.editCount = edits.size();
+		g_stream.maxEntryBytes = maxEntryBytes;
+		return g_stream.Edit(InPath, outPath, normalizer);
+	}
+
+	//! Apply edits with RegFile to InPath, one value at a time, as EnvVarUpdate does.
+	bool Rewrite(const std::vector<RegEdit> &edits)
+	{
+		bool success = g_regFile.Open(_T("RegFileTest.reg"), edits[0].system);
+		for (const RegEdit &edit : edits)
+		{
+			const Host::String name(edit.EnvVarName, edit.EnvVarName + lstrlenW(edit.EnvVarName));
+			GrowString value;
+			GrowString newValue;
+			DWORD type;
+			PathNormalizer normalizer(NormalizeNone);
+			success = success
+				&& g_regFile.Get(name.c_str(), value, type)
+				&& ApplyAction(edit.Action, value, edit.PathString, newValue, normalizer)
+				&& (newValue.Span().Equals(value.Span()) || g_regFile.Set(name.c_str(), newValue, ChooseValueType(type, newValue)));
+		}
+		return g_regFile.Close(true) && success;
+	}
+
+	//! Value read by RegFile, or "<error>".
+	Host::String Read(LPCTSTR name, bool system)
+	{
+		GrowString value;
+		DWORD type;
+		const bool success = g_regFile.Open(_T("RegFileTest.reg"), system) && g_regFile.Get(name, value, type);
+		g_regFile.Close(false);
+		return success ? static_cast<LPCTSTR>(value) : _T("<error>");
+	}
+
+	//! Exported HKCU environment, with PATH as hex(2) over continued lines, and another key after it.
+	std::wstring UserFile(bool unicode)
+	{
+		std::wstring path = L"\"Path\"=hex(2):";
+		const char *value = "C:\\Windows;C:\\Windows\\System32;C:\\Program Files\\Tool;C:\\A";
+		size_t lineLen = path.size();
+		for (const char *scan = value; ; scan++)
+		{
+			const int units = unicode ? 2 : 1;
+			for (int unit = 0; unit < units; unit++)
+			{
+				const BYTE one = (unit == 0) ? static_cast<BYTE>(*scan) : 0;
+				path += L"0123456789abcdef"[one >> 4];
+				path += L"0123456789abcdef"[one & 15];
+				lineLen += 2;
+				if (*scan == 0 && unit + 1 == units)
+				{
+					break;
+				}
+				path += L',';
+				lineLen++;
+				if (lineLen >= 76)
+				{
+					path += L"\\\r\n  ";
+					lineLen = 2;
+				}
+			}
+			if (*scan == 0)
+			{
+				break;
+			}
+		}
+		return std::wstring(unicode ? L"Windows Registry Editor Version 5.00\r\n" : L"REGEDIT4\r\n")
+			+ L"\r\n[HKEY_CURRENT_USER\\Environment]\r\n"
+			+ path + L"\r\n"
+			+ L"\"TEMP\"=\"C:\\\\Users\\\\Caf\xe9\\\\Temp\"\r\n"
+			+ L"\"OLD\"=-\r\n"
+			+ L"\r\n"
+			+ L"[HKEY_CURRENT_USER\\Console]\r\n"
+			+ L"\"FaceName\"=\"Consolas\"\r\n";
+	}
+
+	void TestSameAsRegFile()
+	{
+		for (bool unicode : { true, false })
+		{
+			const Bytes original = Encode(UserFile(unicode), unicode);
+			const std::vector<RegEdit> edits =
+			{
+				Edit(L"PATH", _T("R"), false, _T("C:\\A")),
+				Edit(L"PATH", _T("A"), false, _T("C:\\Tools\\bin")),
+				Edit(L"temp", _T("P"), false, _T("D:\\Temp")),
+				Edit(L"OLD", _T("A"), false, _T("C:\\Old")),
+				Edit(L"NEW", _T("A"), false, _T("%ROOT%\\bin")),
+			};
+
+			// the same bytes: only edited entries are written, and NEW goes before the blank line
+			Store(InPath, original);
+			CHECK(Stream(edits) == RegStreamChanged);
+			const Bytes streamed = Load(OutPath);
+			CHECK(Load(InPath) == original);
+			CHECK(Rewrite(edits));
+			CHECK(streamed == Load(InPath));
+
+			CHECK(Read(_T("Path"), false) == _T("C:\\Windows;C:\\Windows\\System32;C:\\Program Files\\Tool;C:\\Tools\\bin"));
+			CHECK(Read(_T("TEMP"), false) == _T("D:\\Temp;C:\\Users\\Caf\xe9\\Temp"));
+			CHECK(Read(_T("OLD"), false) == _T("C:\\Old"));
+			CHECK(Read(_T("NEW"), false) == _T("%ROOT%\\bin"));
+			// the next key is kept as it was
+			const std::wstring text = UserFile(unicode);
+			const Bytes console = Encode(text.substr(text.find(L"\r\n[HKEY_CURRENT_USER\\Console]")), unicode);
+			CHECK(streamed.size() > console.size());
+			CHECK(Bytes(streamed.end() - (console.size() - (unicode ? 2 : 0)), streamed.end()) == Bytes(console.begin() + (unicode ? 2 : 0), console.end()));
+
+			// a missing key is added at the end of the file, by both
+			Store(InPath, original);
+			const std::vector<RegEdit> system = { Edit(L"Path", _T("A"), true, _T("C:\\Sys")) };
+			CHECK(Stream(system) == RegStreamChanged);
+			CHECK(Rewrite(system));
+			CHECK(Load(OutPath) == Load(InPath));
+			CHECK(Read(_T("PATH"), true) == _T("C:\\Sys"));
+		}
+	}
+
+	void TestUnchangedAndCheck()
+	{
+		const Bytes original = Encode(UserFile(false), false);
+		Store(InPath, original);
+		remove("RegFileTest.out.reg");
+
+		// nothing to change: no file is written
+		CHECK(Stream({ Edit(L"PATH", _T("R"), false, _T("C:\\Nowhere")), Edit(L"GONE", _T("R"), true, _T("C:\\X")) }) == RegStreamUnchanged);
+		CHECK(Load(OutPath) == Encode(L"<none>", false));
+		CHECK(Load(L"RegFileTest.out.reg.new") == Encode(L"<none>", false));
+
+		// check only
+		CHECK(Stream({ Edit(L"PATH", _T("D"), false, _T("")), Edit(L"PATH", _T("A"), false, _T("C:\\Windows")) }, nullptr) == RegStreamChanged);
+		CHECK(Load(InPath) == original);
+
+		// in place
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\Windows")) }, InPath) == RegStreamChanged);
+		CHECK(Read(_T("PATH"), false) == _T("C:\\Windows\\System32;C:\\Program Files\\Tool;C:\\A;C:\\Windows"));
+	}
+
+	void TestFailures()
+	{
+		const Bytes original = Encode(UserFile(true), true);
+		Store(InPath, original);
+		remove("RegFileTest.out.reg");
+
+		// an environment entry longer than the worker may hold
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\B")) }, OutPath, 256) == RegStreamFailed);
+		CHECK(g_stream.error == Host::String(_T("entry too long")));
+		CHECK(Load(OutPath) == Encode(L"<none>", false));
+
+		// long lines of other keys pass through
+		const std::wstring longLine = L"\"Blob\"=\"" + std::wstring(3000, L'x') + L"\"\r\n";
+		Store(InPath, Encode(UserFile(false) + longLine, false));
+		CHECK(Stream({ Edit(L"TEMP", _T("A"), false, _T("C:\\B")) }, OutPath, 256) == RegStreamChanged);
+		const Bytes written = Load(OutPath);
+		const Bytes tail = Encode(longLine, false);
+		CHECK(written.size() > tail.size() && Bytes(written.end() - tail.size(), written.end()) == tail);
+
+		Store(InPath, Encode(L"REGEDIT4\r\n\r\n[HKEY_CURRENT_USER\\Environment]\r\n\"PATH\"=dword:00000001\r\n", false));
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\B")) }) == RegStreamFailed);
+		CHECK(g_stream.error == Host::String(_T("not a string value")));
+
+		Store(InPath, Encode(L"PATH=C:\\A\r\n", false));
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\B")) }) == RegStreamFailed);
+		CHECK(g_stream.error == Host::String(_T("not a .reg file")));
+
+		remove("RegFileTest.reg");
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\B")) }) == RegStreamFailed);
+		CHECK(g_stream.error == Host::String(_T("not read")));
+	}
+
+	void TestBoundedMemory()
+	{
+		// 40,000 entries of another key before the environment
+		std::wstring text = L"Windows Registry Editor Version 5.00\r\n\r\n[HKEY_CURRENT_USER\\Software\\Big]\r\n";
+		for (int index = 0; index < 40000; index++)
+		{
+			text += L"\"Value" + std::to_wstring(index) + L"\"=\"C:\\\\Some\\\\Long\\\\Directory\\\\Name\"\r\n";
+		}
+		const Bytes bytes = Encode(text + L"\r\n[HKEY_CURRENT_USER\\Environment]\r\n\"PATH\"=\"C:\\\\A\"\r\n", true);
+		Store(InPath, bytes);
+
+		// buffers do not grow with the file
+		const size_t allocated = Host::g_win32.bytesAllocated;
+		const size_t live = Host::g_win32.bytesLive;
+		CHECK(Stream({ Edit(L"PATH", _T("A"), false, _T("C:\\B")) }) == RegStreamChanged);
+		CHECK(Host::g_win32.bytesAllocated - allocated < 512 * 1024);
+		CHECK(bytes.size() > 2 * 1024 * 1024);
+		g_stream.Release();
+		CHECK(Host::g_win32.bytesLive < live);
+
+		// RegFile moves the text after the entry in place: a series of writes does not copy the file each time
+		CHECK(g_regFile.Open(_T("RegFileTest.reg"), false));
+		GrowString longest;
+		longest.AssignString(_T("C:\\AAAA"), 0, 7);
+		CHECK(g_regFile.Set(_T("LIB"), longest, REG_SZ));
+		const size_t before = Host::g_win32.bytesAllocated;
+		for (int round = 0; round < 100; round++)
+		{
+			GrowString value;
+			const Host::String text = (round % 2 == 0) ? _T("C:\\AAAA") : _T("C:\\B");
+			value.AssignString(text.c_str(), 0, text.size());
+			CHECK(g_regFile.Set(_T("PATH"), value, REG_SZ));
+			CHECK(g_regFile.Set(_T("LIB"), value, REG_SZ));
+		}
+		CHECK(Host::g_win32.bytesAllocated - before < bytes.size());
+		CHECK(g_regFile.Close(true));
+		CHECK(Read(_T("PATH"), false) == _T("C:\\B"));
+		CHECK(Read(_T("LIB"), false) == _T("C:\\B"));
+	}
+}
+
+int main()
+{
+	TestSameAsRegFile();
+	TestUnchangedAndCheck();
+	TestFailures();
+	TestBoundedMemory();
+	g_stream.Release();
+	remove("RegFileTest.reg");
+	remove("RegFileTest.out.reg");
+	return Host::Summary("RegFileTest");
+}
@@ -0,0 +1,214 @@
+//! @file RegistryStoreTest.cpp
+//! @brief Two-phase registry reads of RegistryStore: size probe, exact buffer, grow and retry, and missing values
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "Win32Host.h"
+#include "../Utils/GrowString.h"
+#include "../Utils/RegistryStore.h"
+#include "../Utils/RegTransaction.h"
+
+using namespace Utils;
+
+namespace
+{
+	//! Value of chars, ending with a marker of its length.
+	Host::String MakeValue(size_t chars)
+	{
+		Host::String value;
+		while (value.size() < chars)
+		{
+			value += _T("C:\\Dir;");
+		}
+		value.resize(chars);
+		value.back() = _T('$');
+		return value;
+	}
+
+	//! Start each test with an empty registry, and no open keys or remembered values.
+	void Reset()
+	{
+		ReleaseRegistryKeys();
+		Host::RegistryClear();
+	}
+
+	void TestProbeAndRead()
+	{
+		Reset();
+		const Host::String stored = MakeValue(10000);
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, stored);
+
+		EnvStore store = HKCURegistryStore();
+		const size_t queries = Host::g_win32.regQueries;
+		GrowString value;
+		DWORD type = REG_NONE;
+		CHECK(store.Get(_T("Path"), value, type));
+		CHECK(type == REG_EXPAND_SZ);
+		CHECK(static_cast<LPCTSTR>(value) == stored);
+
+		// size, and then data into the buffer reserved once for it: the value and its null
+		CHECK(Host::g_win32.regQueries - queries == 2);
+		CHECK(value.maxPos == stored.size() + 1);
+
+		// a short value fits the initial buffer
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("LIB"), REG_SZ, _T("C:\\L"));
+		GrowString shortValue;
+		const size_t initial = shortValue.maxPos;
+		CHECK(store.Get(_T("LIB"), shortValue, type));
+		CHECK(type == REG_SZ);
+		CHECK(static_cast<LPCTSTR>(shortValue) == Host::String(_T("C:\\L")));
+		CHECK(shortValue.maxPos == initial);
+	}
+
+	void TestGrowAndRetry()
+	{
+		Reset();
+		const Host::String grown = MakeValue(5000);
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, MakeValue(1000));
+		Host::RegistryGrowOnQuery(HKEY_CURRENT_USER, _T("PATH"), grown);
+
+		EnvStore store = HKCURegistryStore();
+		const size_t queries = Host::g_win32.regQueries;
+		GrowString value;
+		DWORD type = REG_NONE;
+		CHECK(store.Get(_T("PATH"), value, type));
+
+		// size of 1000 chars, ERROR_MORE_DATA with the grown size, and then the grown value
+		CHECK(Host::g_win32.regQueries - queries == 3);
+		CHECK(static_cast<LPCTSTR>(value) == grown);
+		CHECK(value.maxPos == grown.size() + 1);
+	}
+
+	void TestMissing()
+	{
+		Reset();
+		EnvStore store = HKCURegistryStore();
+		const size_t queries = Host::g_win32.regQueries;
+		GrowString value;
+		value.AssignString(_T("stale"), 0, 5);
+		DWORD type = REG_SZ;
+
+		// read as empty, with REG_NONE, by one query
+		CHECK(store.Get(_T("PATH"), value, type));
+		CHECK(type == REG_NONE);
+		CHECK(value.StringCharCount() == 0);
+		CHECK(Host::g_win32.regQueries - queries == 1);
+
+		// a value of other type is an error
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("NUMBER"), REG_DWORD, _T("1"));
+		CHECK(!store.Get(_T("NUMBER"), value, type));
+	}
+
+	void TestDelete()
+	{
+		Reset();
+		Host::RegistryPut(HKEY_LOCAL_MACHINE, _T("PATH"), REG_SZ, _T("C:\\A"));
+		EnvStore store = HKLMRegistryStore();
+		GrowString value;
+		DWORD type;
+
+		// REG_NONE deletes, and deleting a missing value succeeds
+		CHECK(store.Set(_T("PATH"), value, REG_NONE));
+		CHECK(store.Set(_T("PATH"), value, REG_NONE));
+		Host::String unused;
+		CHECK(!Host::RegistryGet(HKEY_LOCAL_MACHINE, _T("PATH"), type, unused));
+		CHECK(store.Get(_T("PATH"), value, type));
+		CHECK(type == REG_NONE);
+	}
+
+	//! Value read by store, or "<error>".
+	Host::String Read(EnvStore &store, LPCTSTR name)
+	{
+		GrowString value;
+		DWORD type;
+		return store.Get(name, value, type) ? static_cast<LPCTSTR>(value) : _T("<error>");
+	}
+
+	void TestValueCache()
+	{
+		Reset();
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\A"));
+		EnvStore store = HKCURegistryStore();
+
+		// the first read queries, and the next ones of the unchanged key are hits
+		const StoreCounters start = g_storeCounters;
+		const size_t queries = Host::g_win32.regQueries;
+		for (int read = 0; read < 10; read++)
+		{
+			CHECK(Read(store, _T("PATH")) == _T("C:\\A"));
+		}
+		CHECK(g_storeCounters.cacheMisses - start.cacheMisses == 1);
+		CHECK(g_storeCounters.cacheHits - start.cacheHits == 9);
+		CHECK(Host::g_win32.regQueries - queries == 2);
+
+		// written by another process: the last write time moves, and the new value is read
+		const FILETIME remembered = g_hkcuKeys.lastWriteTime;
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\B"));
+		CHECK(Read(store, _T("Path")) == _T("C:\\B"));
+		CHECK(CompareFileTime(&g_hkcuKeys.lastWriteTime, &remembered) != 0);
+		CHECK(g_storeCounters.cacheMisses - start.cacheMisses == 2);
+		CHECK(Read(store, _T("PATH")) == _T("C:\\B"));
+		CHECK(g_storeCounters.cacheHits - start.cacheHits == 10);
+
+		// another value of the same key is forgotten too
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("LIB"), REG_SZ, _T("C:\\L"));
+		CHECK(Read(store, _T("PATH")) == _T("C:\\B"));
+		CHECK(g_storeCounters.cacheMisses - start.cacheMisses == 3);
+
+		// a write of this store is remembered as written
+		GrowString written;
+		written.AssignString(_T("C:\\C"), 0, 4);
+		CHECK(store.Set(_T("PATH"), written, REG_EXPAND_SZ));
+		CHECK(Read(store, _T("PATH")) == _T("C:\\C"));
+		CHECK(g_storeCounters.cacheHits - start.cacheHits == 11);
+		CHECK(g_storeCounters.cacheMisses - start.cacheMisses == 3);
+	}
+
+	void TestValueCacheInTransaction()
+	{
+		Reset();
+		Host::KtmSetup(true);
+		Host::RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\A"));
+		EnvStore store = HKCURegistryStore();
+		CHECK(Read(store, _T("PATH")) == _T("C:\\A"));
+		{
+			RegTransaction transaction;
+			CHECK(transaction.Begin());
+			EnvStore transacted = transaction.Store(store);
+
+			// reads of the transaction see its writes, and are never remembered
+			const StoreCounters start = g_storeCounters;
+			GrowString written;
+			written.AssignString(_T("C:\\T"), 0, 4);
+			CHECK(transacted.Set(_T("PATH"), written, REG_EXPAND_SZ));
+			CHECK(Read(transacted, _T("PATH")) == _T("C:\\T"));
+			CHECK(Read(transacted, _T("PATH")) == _T("C:\\T"));
+			CHECK(Read(transacted, _T("LIB")) == _T(""));
+			CHECK(g_storeCounters.cacheHits == start.cacheHits);
+			CHECK(g_storeCounters.cacheMisses - start.cacheMisses == 3);
+
+			// others do not see the write until commit
+			CHECK(Read(store, _T("PATH")) == _T("C:\\A"));
+			CHECK(transaction.Commit());
+		}
+
+		// the commit moves the last write time: the committed value is read, not the remembered one
+		const size_t misses = g_storeCounters.cacheMisses;
+		CHECK(Read(store, _T("PATH")) == _T("C:\\T"));
+		CHECK(g_storeCounters.cacheMisses - misses == 1);
+		Host::KtmSetup(false);
+	}
+}
+
+int main()
+{
+	TestProbeAndRead();
+	TestGrowAndRetry();
+	TestMissing();
+	TestDelete();
+	TestValueCache();
+	TestValueCacheInTransaction();
+	ReleaseRegistryKeys();
+	return Host::Summary("RegistryStoreTest");
+}
@@ -0,0 +1,196 @@
+//! @file TransactionTest.cpp
+//! @brief TransactionBegin, TransactionAdd and TransactionCommit with "Transaction" "Restore" and "KTM", through the NSIS stack
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#include "Check.h"
+#include "NsisHost.h"
+#include "Win32Host.h"
+
+#include <cstdio>
+
+using namespace Host;
+
+namespace
+{
+	//! .reg file of the tests, in the current directory
+	LPCTSTR const TestRegFile = _T("TransactionTest.reg");
+
+	//! Value of root, or "<none>".
+	String Registry(HKEY root, LPCTSTR name)
+	{
+		DWORD type;
+		String value;
+		return RegistryGet(root, name, type, value) ? value : _T("<none>");
+	}
+
+	//! Queue edits of PATH in HKCU and HKLM, and commit them. Returns the pushed count.
+	String Commit(Installer &installer, LPCTSTR hkcuPath, LPCTSTR hklmPath)
+	{
+		installer.Call(TransactionBegin);
+		installer.Call(TransactionAdd, { _T("PATH"), _T("A"), _T("HKCU"), hkcuPath });
+		installer.Call(TransactionAdd, { _T("PATH"), _T("A"), _T("HKLM"), hklmPath });
+		installer.Call(TransactionCommit);
+		return installer.Pop();
+	}
+
+	//! Run one installer with options, and count the WM_SETTINGCHANGE sent at its unload.
+	template <class Body>
+	size_t BroadcastsOf(LPCTSTR transaction, Body body)
+	{
+		const size_t broadcasts = g_win32.broadcasts;
+		{
+			Installer installer;
+			installer.Call(SetOption, { _T("Broadcast"), _T("Unload") });
+			installer.Call(SetOption, { _T("Transaction"), transaction });
+			CHECK(!installer.IfErrors());
+			body(installer);
+			installer.Call(SetOption, { _T("Transaction"), _T("Restore") });
+		}
+		return g_win32.broadcasts - broadcasts;
+	}
+
+	void TestRestore()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\U"));
+		RegistryPut(HKEY_LOCAL_MACHINE, _T("PATH"), REG_EXPAND_SZ, _T("C:\\M"));
+
+		// the HKLM write fails: the written HKCU value is restored, and nothing is broadcast
+		RegistryFailWrite(_T("PATH"));
+		CHECK(BroadcastsOf(_T("Restore"), [](Installer &installer)
+		{
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("0"));
+			CHECK(installer.IfErrors());
+		}) == 0);
+		RegistryFailWrite(nullptr);
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("C:\\U"));
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M"));
+
+		CHECK(BroadcastsOf(_T("Restore"), [](Installer &installer)
+		{
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("2"));
+			CHECK(!installer.IfErrors());
+		}) == 1);
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("C:\\U;C:\\U2"));
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M;C:\\M2"));
+
+		// a single EnvVarUpdate failing to write is not broadcast either
+		RegistryFailWrite(_T("PATH"));
+		CHECK(BroadcastsOf(_T("Restore"), [](Installer &installer)
+		{
+			installer.Call(EnvVarUpdate, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\U3") });
+			installer.Pop();
+			CHECK(installer.IfErrors());
+		}) == 0);
+		RegistryFailWrite(nullptr);
+	}
+
+	void TestKtm()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_CURRENT_USER, _T("PATH"), REG_EXPAND_SZ, _T("C:\\U"));
+		RegistryPut(HKEY_LOCAL_MACHINE, _T("PATH"), REG_EXPAND_SZ, _T("C:\\M"));
+		size_t commits;
+		size_t rollbacks;
+
+		// commit fails: nothing is seen, and nothing is broadcast
+		KtmSetup(true, false);
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("0"));
+			CHECK(installer.IfErrors());
+		}) == 0);
+		KtmCounts(commits, rollbacks);
+		CHECK(commits == 1);
+		CHECK(rollbacks == 1);
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("C:\\U"));
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M"));
+
+		// no KTM: nothing is written
+		KtmSetup(false);
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("0"));
+			CHECK(installer.IfErrors());
+		}) == 0);
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("C:\\U"));
+
+		// committed: both are seen, and broadcast once
+		KtmSetup(true, true);
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("2"));
+			CHECK(!installer.IfErrors());
+		}) == 1);
+		KtmCounts(commits, rollbacks);
+		CHECK(commits == 1);
+		CHECK(rollbacks == 0);
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("C:\\U;C:\\U2"));
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M;C:\\M2"));
+		KtmSetup(false);
+	}
+
+	void TestKtmWithRegFile()
+	{
+		RegistryClear();
+		RegistryPut(HKEY_LOCAL_MACHINE, _T("PATH"), REG_EXPAND_SZ, _T("C:\\M"));
+		FILE *file = fopen("TransactionTest.reg", "wb");
+		fputs("REGEDIT4\r\n\r\n[HKEY_CURRENT_USER\\Environment]\r\n\"PATH\"=\"C:\\\\U\"\r\n", file);
+		fclose(file);
+
+		// the .reg file is not in the KTM transaction: it is restored when the commit fails
+		KtmSetup(true, false);
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			installer.Call(RegFileOpen, { _T("HKCU"), TestRegFile });
+			CHECK(!installer.IfErrors());
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("0"));
+			CHECK(installer.IfErrors());
+			installer.Call(Count, { _T("PATH"), _T("HKCU"), _T("C:\\U2") });
+			CHECK(installer.Pop() == _T("0"));
+			installer.Call(Count, { _T("PATH"), _T("HKCU"), _T("C:\\U") });
+			CHECK(installer.Pop() == _T("1"));
+			installer.Call(RegFileClose, { _T("HKCU") });
+			CHECK(!installer.IfErrors());
+		}) == 0);
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M"));
+
+		// committed: the .reg file is written, and only the HKLM write is broadcast
+		KtmSetup(true, true);
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			installer.Call(RegFileOpen, { _T("HKCU"), TestRegFile });
+			CHECK(Commit(installer, _T("C:\\U2"), _T("C:\\M2")) == _T("2"));
+			CHECK(!installer.IfErrors());
+			installer.Call(RegFileClose, { _T("HKCU") });
+			CHECK(!installer.IfErrors());
+		}) == 1);
+		CHECK(Registry(HKEY_LOCAL_MACHINE, _T("PATH")) == _T("C:\\M;C:\\M2"));
+		CHECK(Registry(HKEY_CURRENT_USER, _T("PATH")) == _T("<none>"));
+
+		// only the .reg file written: nothing to broadcast
+		CHECK(BroadcastsOf(_T("KTM"), [](Installer &installer)
+		{
+			installer.Call(RegFileOpen, { _T("HKCU"), TestRegFile });
+			installer.Call(TransactionBegin);
+			installer.Call(TransactionAdd, { _T("PATH"), _T("A"), _T("HKCU"), _T("C:\\U3") });
+			installer.Call(TransactionCommit);
+			CHECK(installer.Pop() == _T("1"));
+			installer.Call(Count, { _T("PATH"), _T("HKCU"), _T("C:\\U2") });
+			CHECK(installer.Pop() == _T("1"));
+			installer.Call(RegFileClose, { _T("HKCU") });
+			CHECK(!installer.IfErrors());
+		}) == 0);
+		KtmSetup(false);
+		remove("TransactionTest.reg");
+	}
+}
+
+int main()
+{
+	TestRestore();
+	TestKtm();
+	TestKtmWithRegFile();
+	return Summary("TransactionTest");
+}
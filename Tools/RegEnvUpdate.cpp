@@ -0,0 +1,315 @@
+//! @file RegEnvUpdate.cpp
+//! @brief Apply EnvVarUpdate edits to the environment keys of many .reg files, in parallel
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+// each worker has its own arena, stats and counters
+#define UTILS_PER_THREAD thread_local
+
+#include <windows.h>
+#include "../Utils/RegStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Utils;
+
+namespace
+{
+	typedef std::basic_string<TCHAR> String;
+
+	//! Command line of the tool.
+	struct Options
+	{
+		//! edits, in order
+		std::vector<RegEdit> edits;
+
+		//! strings of edits
+		std::vector<std::wstring> names;
+		std::vector<String> texts;
+
+		//! .reg files
+		std::vector<std::string> files;
+
+		//! worker threads
+		unsigned int workers;
+
+		//! longest entry of a worker
+		size_t maxEntryBytes;
+
+		//! write nothing
+		bool check;
+
+		//! written to file + suffix, if not empty, instead of file
+		std::string suffix;
+
+		//! matching of entries
+		NormalizeMode mode;
+	};
+
+	//! Result of one file.
+	struct FileResult
+	{
+		RegStreamResult result;
+		LPCTSTR error;
+	};
+
+	//! Text of the command line as UTF-16.
+	std::wstring Wide(const char *text)
+	{
+		const int count = MultiByteToWideChar(CP_ACP, 0, text, -1, NULL, 0);
+		std::vector<WCHAR> wide(count + 1, 0);
+		MultiByteToWideChar(CP_ACP, 0, text, -1, wide.data(), count);
+		return std::wstring(wide.data());
+	}
+
+	//! Text of the command line as TCHAR.
+	String Text(const char *text)
+	{
+#ifdef UNICODE
+		return Wide(text);
+#else
+		return text;
+#endif
+	}
+
+	//! Narrow TCHAR text to print.
+	std::string Narrow(LPCTSTR text)
+	{
+		std::string narrow;
+		for (; *text != 0; text++)
+		{
+			narrow += static_cast<char>(*text);
+		}
+		return narrow;
+	}
+
+	void Usage()
+	{
+		fprintf(stderr,
+			"Usage: RegEnvUpdate [options] -e EnvVarName Action RegLoc PathString [-e ...] FILE.reg...\n"
+			"\n"
+			"Applies the edits, in order, to the environment keys of .reg files exported by regedit.\n"
+			"\n"
+			"  -e NAME ACTION REGLOC PATH  edit, as EnvVarUpdate: Action is A, P, R, D or C, RegLoc is HKCU or HKLM\n"
+			"  -l LIST                     also edit the .reg files listed in LIST, one per line\n"
+			"  -j N                        worker threads (default: one per core)\n"
+			"  -m BYTES                    longest environment entry a worker holds (default: 1048576)\n"
+			"  -n none|path                match entries as EnvVarUpdate's \"Normalize\" option (default: none)\n"
+			"  -s SUFFIX                   write FILE.regSUFFIX instead of replacing FILE.reg\n"
+			"  -c                          check only: report changes, and write nothing\n"
+			"\n"
+			"Prints \"changed\", \"unchanged\" or \"failed\" and the file, for each file in order.\n"
+			"Exits with 1 if any file failed, and 2 for a bad command line.\n");
+	}
+
+	//! Add the files listed in path.
+	bool ReadList(const char *path, std::vector<std::string> &files)
+	{
+		FILE *list = fopen(path, "rb");
+		if (list == nullptr)
+		{
+			return false;
+		}
+		std::string file;
+		for (int oneChar; (oneChar = fgetc(list)) != EOF; )
+		{
+			if (oneChar == '\n' || oneChar == '\r')
+			{
+				if (!file.empty())
+				{
+					files.push_back(file);
+				}
+				file.clear();
+			}
+			else
+			{
+				file += static_cast<char>(oneChar);
+			}
+		}
+		if (!file.empty())
+		{
+			files.push_back(file);
+		}
+		fclose(list);
+		return true;
+	}
+
+	//! Parse the command line.
+	bool Parse(int argc, char **argv, Options &options)
+	{
+		options.workers = std::thread::hardware_concurrency();
+		options.maxEntryBytes = RegStream::DefaultMaxEntryBytes;
+		options.check = false;
+		options.mode = NormalizeNone;
+
+		for (int index = 1; index < argc; index++)
+		{
+			const std::string arg = argv[index];
+			const bool hasValue = index + 1 < argc;
+			if (arg == "-e" && index + 4 < argc)
+			{
+				const String action = Text(argv[index + 2]);
+				const String regLoc = Text(argv[index + 3]);
+				const String path = Text(argv[index + 4]);
+				const bool known = false
+					|| lstrcmpi(action.c_str(), _T("A")) == 0
+					|| lstrcmpi(action.c_str(), _T("P")) == 0
+					|| lstrcmpi(action.c_str(), _T("R")) == 0
+					|| lstrcmpi(action.c_str(), _T("D")) == 0
+					|| lstrcmpi(action.c_str(), _T("C")) == 0;
+				if (!known || (lstrcmpi(regLoc.c_str(), _T("HKCU")) != 0 && lstrcmpi(regLoc.c_str(), _T("HKLM")) != 0))
+				{
+					fprintf(stderr, "RegEnvUpdate: bad edit: %s %s %s\n", argv[index + 1], argv[index + 2], argv[index + 3]);
+					return false;
+				}
+				if (lstrcmpi(action.c_str(), _T("C")) == 0 && lstrcmpi(path.c_str(), _T("/MISSING")) == 0)
+				{
+					// the directories are on the machines the files come from
+					fprintf(stderr, "RegEnvUpdate: \"C\" \"/MISSING\" is not supported\n");
+					return false;
+				}
+				options.names.push_back(Wide(argv[index + 1]));
+				options.texts.push_back(action);
+				options.texts.push_back(path);
+				RegEdit edit = { nullptr, nullptr, lstrcmpi(regLoc.c_str(), _T("HKLM")) == 0, nullptr };
+				options.edits.push_back(edit);
+				index += 4;
+			}
+			else if (arg == "-l" && hasValue)
+			{
+				if (!ReadList(argv[++index], options.files))
+				{
+					fprintf(stderr, "RegEnvUpdate: list not read: %s\n", argv[index]);
+					return false;
+				}
+			}
+			else if (arg == "-j" && hasValue)
+			{
+				options.workers = static_cast<unsigned int>(strtoul(argv[++index], nullptr, 10));
+			}
+			else if (arg == "-m" && hasValue)
+			{
+				options.maxEntryBytes = static_cast<size_t>(strtoull(argv[++index], nullptr, 10));
+			}
+			else if (arg == "-n" && hasValue)
+			{
+				const std::string mode = argv[++index];
+				if (mode != "none" && mode != "path")
+				{
+					fprintf(stderr, "RegEnvUpdate: -n is none or path: %%VAR%% of other machines is not known here\n");
+					return false;
+				}
+				options.mode = (mode == "path") ? NormalizePath : NormalizeNone;
+			}
+			else if (arg == "-s" && hasValue)
+			{
+				options.suffix = argv[++index];
+			}
+			else if (arg == "-c")
+			{
+				options.check = true;
+			}
+			else if (!arg.empty() && arg[0] == '-')
+			{
+				return false;
+			}
+			else
+			{
+				options.files.push_back(arg);
+			}
+		}
+
+		// strings do not move any more
+		for (size_t index = 0; index < options.edits.size(); index++)
+		{
+			options.edits[index].EnvVarName = options.names[index].c_str();
+			options.edits[index].Action = options.texts[2 * index].c_str();
+			options.edits[index].PathString = options.texts[2 * index + 1].c_str();
+		}
+		options.workers = (options.workers == 0) ? 1 : options.workers;
+		return !options.edits.empty() && !options.files.empty() && options.maxEntryBytes >= 256;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (!Parse(argc, argv, options))
+	{
+		Usage();
+		return 2;
+	}
+
+	// detected once, before the workers read it
+	GetSimdLevel();
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<FileResult> results(options.files.size());
+	std::atomic<size_t> next(0);
+	std::mutex totalsLock;
+	EditCounters totals = {};
+	size_t peakBytes = 0;
+
+	// each worker takes the next file, and keeps its buffers for the next one
+	auto work = [&]()
+	{
+		Arena arena = Arena();
+		RegStream stream = RegStream();
+		stream.edits = options.edits.data();
+		stream.editCount = options.edits.size();
+		stream.maxEntryBytes = options.maxEntryBytes;
+		for (size_t index = next++; index < options.files.size(); index = next++)
+		{
+			const std::wstring inPath = Wide(options.files[index].c_str());
+			const std::wstring outPath = Wide((options.files[index] + options.suffix).c_str());
+			ArenaScope scope(&arena);
+			PathNormalizer normalizer(options.mode);
+			results[index].result = stream.Edit(inPath.c_str(), options.check ? nullptr : outPath.c_str(), normalizer);
+			results[index].error = stream.error;
+		}
+		stream.Release();
+
+		std::lock_guard<std::mutex> lock(totalsLock);
+		totals.entriesRemoved += g_editCounters.entriesRemoved;
+		totals.bytesRemoved += g_editCounters.bytesRemoved;
+		totals.entriesScanned += g_editCounters.entriesScanned;
+		peakBytes = (arena.bytesAllocated > peakBytes) ? arena.bytesAllocated : peakBytes;
+		arena.Release();
+	};
+	std::vector<std::thread> workers;
+	for (unsigned int index = 0; index < options.workers; index++)
+	{
+		workers.emplace_back(work);
+	}
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	size_t counts[3] = {};
+	for (size_t index = 0; index < results.size(); index++)
+	{
+		const FileResult &result = results[index];
+		counts[result.result]++;
+		if (result.result == RegStreamFailed)
+		{
+			printf("failed\t%s\t%s\n", options.files[index].c_str(), Narrow(result.error).c_str());
+		}
+		else
+		{
+			printf("%s\t%s\n", (result.result == RegStreamChanged) ? "changed" : "unchanged", options.files[index].c_str());
+		}
+	}
+	fprintf(stderr, "%zu files: %zu %s, %zu unchanged, %zu failed. %zu entries scanned, %zu removed. %.1f ms, %u workers, arena peak %zu bytes per worker\n",
+		results.size(), counts[RegStreamChanged], options.check ? "to change" : "changed", counts[RegStreamUnchanged], counts[RegStreamFailed],
+		totals.entriesScanned, totals.entriesRemoved, ms, options.workers, peakBytes);
+	return (counts[RegStreamFailed] != 0) ? 1 : 0;
+}
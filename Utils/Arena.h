@@ -0,0 +1,178 @@
+//! @file Arena.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "PerThread.h"
+#include "ZeroFill.h"
+
+namespace Utils
+{
+	//! Bump allocator over retained GlobalAlloc blocks (without CRT)
+	/*!
+		@remarks
+		Memory is not zeroed unless asked. Nothing is freed individually:
+		ArenaScope rewinds the arena, and the blocks are reused by the next scope until Release.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	class Arena
+	{
+	public:
+		//! GlobalAlloc calls
+		size_t allocations;
+
+		//! bytes obtained from GlobalAlloc
+		size_t bytesAllocated;
+
+		//! bytes handed out
+		size_t bytesUsed;
+
+		//! bytes zero filled
+		size_t bytesZeroed;
+
+		//! arena used by FixedLenStr and PathIndex, or nullptr to use GlobalAlloc
+		static UTILS_PER_THREAD Arena *current;
+
+		//! Position to rewind to.
+		struct Mark
+		{
+			void *block;
+			size_t used;
+		};
+
+		//! Allocate bytes, 8 bytes aligned.
+		LPVOID Allocate(size_t bytes, bool zeroFill = false)
+		{
+			bytes = (bytes + 7) & ~static_cast<size_t>(7);
+
+			while (cur != nullptr && cur->size < cur->used + bytes && cur->next != nullptr)
+			{
+				cur = cur->next;
+			}
+			if (cur == nullptr || cur->size < cur->used + bytes)
+			{
+				const size_t size = (bytes < DefaultBlockSize) ? DefaultBlockSize : bytes;
+				Block *block = (Block *)GlobalAlloc(GMEM_FIXED, sizeof(Block) + size);
+				if (block == nullptr)
+				{
+					return nullptr;
+				}
+				allocations++;
+				bytesAllocated += size;
+				block->size = size;
+				block->used = 0;
+				if (cur == nullptr)
+				{
+					block->next = first;
+					first = block;
+				}
+				else
+				{
+					block->next = cur->next;
+					cur->next = block;
+				}
+				cur = block;
+			}
+
+			LPBYTE ptr = reinterpret_cast<LPBYTE>(cur + 1) + cur->used;
+			cur->used += bytes;
+			bytesUsed += bytes;
+			if (zeroFill)
+			{
+				ZeroFill(ptr, bytes);
+				bytesZeroed += bytes;
+			}
+			return ptr;
+		}
+
+		//! Current position.
+		Mark GetMark() const
+		{
+			Mark mark = { cur, (cur == nullptr) ? 0 : cur->used };
+			return mark;
+		}
+
+		//! Forget allocations made after mark. Blocks are kept.
+		void Rewind(const Mark &mark)
+		{
+			Block *keep = reinterpret_cast<Block *>(mark.block);
+			for (Block *block = (keep == nullptr) ? first : keep->next; block != nullptr; block = block->next)
+			{
+				block->used = 0;
+			}
+			if (keep != nullptr)
+			{
+				keep->used = mark.used;
+			}
+			cur = (keep == nullptr) ? first : keep;
+		}
+
+		//! Free all blocks.
+		void Release()
+		{
+			while (first != nullptr)
+			{
+				Block *next = first->next;
+				GlobalFree(first);
+				first = next;
+			}
+			cur = nullptr;
+		}
+
+	private:
+		//! block header, followed by data
+		struct Block
+		{
+			Block *next;
+			size_t size;
+			size_t used;
+		};
+
+		//! enough for a few 32K char values and NsisString
+		static const size_t DefaultBlockSize = 256 * 1024;
+
+		//! block chain, in fill order
+		Block *first;
+
+		//! block being filled
+		Block *cur;
+	};
+
+	UTILS_PER_THREAD Arena *Arena::current = nullptr;
+
+	//! Makes arena current, and rewinds it at end of scope.
+	class ArenaScope
+	{
+	public:
+		//! ctor
+		/*!
+			@param arena nullptr to keep current arena, and to rewind it at end of scope.
+		 */
+		ArenaScope(Arena *arena = nullptr) : previous(Arena::current)
+		{
+			if (arena != nullptr)
+			{
+				Arena::current = arena;
+			}
+			mark = (Arena::current == nullptr) ? Arena::Mark() : Arena::current->GetMark();
+		}
+
+		//! dtor
+		~ArenaScope()
+		{
+			if (Arena::current != nullptr)
+			{
+				Arena::current->Rewind(mark);
+			}
+			Arena::current = previous;
+		}
+
+	private:
+		//! position at scope start
+		Arena::Mark mark;
+
+		//! arena to restore
+		Arena *previous;
+	};
+}
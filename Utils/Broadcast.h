@@ -0,0 +1,77 @@
+//! @file Broadcast.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <Windows.h>
+
+namespace Utils
+{
+	//! SendMessageTimeout prototype, to replace the sender
+	typedef LRESULT(WINAPI *SendMessageTimeoutProc)(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam, UINT fuFlags, UINT uTimeout, PDWORD_PTR lpdwResult);
+
+	//! Coalesced WM_SETTINGCHANGE "Environment" broadcast.
+	/*!
+		@remarks
+		Edits mark it dirty, and Flush sends one broadcast for all of them.
+		SMTO_ABORTIFHUNG skips hung windows instead of waiting for the timeout on each.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	class EnvBroadcast
+	{
+	public:
+		//! timeout used when timeoutMs is 0
+		static const UINT DefaultTimeoutMs = 5000;
+
+		//! true to defer broadcast until Flush. false to broadcast nothing.
+		bool deferred;
+
+		//! an edit is written, and not broadcast yet
+		bool dirty;
+
+		//! timeout per window in milliseconds, or 0 for DefaultTimeoutMs
+		UINT timeoutMs;
+
+		//! broadcasts sent
+		size_t sent;
+
+		//! sender, or nullptr for SendMessageTimeout
+		SendMessageTimeoutProc sender;
+
+		//! Note that the environment is written.
+		void MarkDirty()
+		{
+			if (deferred)
+			{
+				dirty = true;
+			}
+		}
+
+		//! Broadcast once if dirty.
+		/*!
+			@return false if the broadcast timed out or failed.
+		 */
+		bool Flush()
+		{
+			if (!dirty)
+			{
+				return true;
+			}
+			dirty = false;
+			sent++;
+
+			SendMessageTimeoutProc send = (sender != nullptr) ? sender : SendMessageTimeout;
+			DWORD_PTR result;
+			return send(
+				HWND_BROADCAST,
+				WM_SETTINGCHANGE,
+				0,
+				reinterpret_cast<LPARAM>(_T("Environment")),
+				SMTO_ABORTIFHUNG,
+				(timeoutMs != 0) ? timeoutMs : DefaultTimeoutMs,
+				&result
+			) != 0;
+		}
+	};
+}
@@ -0,0 +1,98 @@
+//! @file CpuFeatures.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <Windows.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define UTILS_X86_SIMD 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Utils
+{
+	//! SIMD kernel sets, in increasing order.
+	enum SimdLevel
+	{
+		SimdScalar,
+		SimdSse2,
+		SimdAvx2,
+	};
+
+	//! detected or forced SimdLevel, -1 until detected
+	int g_simdLevel = -1;
+
+	//! Detect usable SIMD level with CPUID (without CRT)
+	SimdLevel DetectSimdLevel()
+	{
+#ifdef UTILS_X86_SIMD
+		int regs[4] = { 0, 0, 0, 0 };
+#ifdef _MSC_VER
+		__cpuid(regs, 0);
+		const int maxLeaf = regs[0];
+		__cpuid(regs, 1);
+#else
+		unsigned int eax, ebx, ecx, edx;
+		const int maxLeaf = static_cast<int>(__get_cpuid_max(0, nullptr));
+		__cpuid(1, eax, ebx, ecx, edx);
+		regs[2] = static_cast<int>(ecx);
+		regs[3] = static_cast<int>(edx);
+#endif
+		const bool sse2 = (regs[3] & (1 << 26)) != 0;
+		const bool osxsave = (regs[2] & (1 << 27)) != 0;
+		const bool avx = (regs[2] & (1 << 28)) != 0;
+		if (!sse2)
+		{
+			return SimdScalar;
+		}
+		if (maxLeaf < 7 || !osxsave || !avx)
+		{
+			return SimdSse2;
+		}
+		// OS must save YMM state
+#ifdef _MSC_VER
+		const unsigned long long xcr0 = _xgetbv(0);
+#else
+		unsigned int xcr0Low, xcr0High;
+		__asm__ ("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+		const unsigned long long xcr0 = xcr0Low;
+#endif
+		if ((xcr0 & 6) != 6)
+		{
+			return SimdSse2;
+		}
+#ifdef _MSC_VER
+		__cpuidex(regs, 7, 0);
+#else
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		regs[1] = static_cast<int>(ebx);
+#endif
+		return ((regs[1] & (1 << 5)) != 0) ? SimdAvx2 : SimdSse2;
+#else
+		return SimdScalar;
+#endif
+	}
+
+	//! SIMD level used by kernels.
+	SimdLevel GetSimdLevel()
+	{
+		if (g_simdLevel < 0)
+		{
+			g_simdLevel = DetectSimdLevel();
+		}
+		return static_cast<SimdLevel>(g_simdLevel);
+	}
+
+	//! Force a lower SIMD level, e.g. to compare kernels.
+	void SetSimdLevel(SimdLevel level)
+	{
+		const SimdLevel detected = DetectSimdLevel();
+		g_simdLevel = (level < detected) ? level : detected;
+	}
+}
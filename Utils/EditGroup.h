@@ -0,0 +1,153 @@
+//! @file EditGroup.h
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include "EditQueue.h"
+#include "EnvStore.h"
+#include "PathEdit.h"
+
+namespace Utils
+{
+	//! Select store by RegLoc, such as "HKCU".
+	/*!
+		@return false for unknown RegLoc.
+	 */
+	typedef bool(*SelectStore)(LPCTSTR RegLoc, EnvStore &store);
+
+	//! Run EditPath of Action with the matcher chosen by normalizer.mode.
+	/*!
+		@remarks Action dropping missing directories always uses normalizer, which remembers tested directories.
+	 */
+	template <class Action>
+	bool EditPathMatching(const StrSpan &value, const StrSpan &yourPath, FixedLenStr &NewPathStr, PathNormalizer &normalizer)
+	{
+		if (normalizer.mode == NormalizeNone && !Action::DropMissing)
+		{
+			ExactMatch exact;
+			return EditPath<Action>(value, yourPath, NewPathStr, exact);
+		}
+		return EditPath<Action>(value, yourPath, NewPathStr, normalizer);
+	}
+
+	//! Apply one action ("A", "P", "R", "D" or "C") to PathFromReg, and write result to NewPathStr.
+	/*!
+		@remarks Action is dispatched once here, to the EditPath kernel specialized for it.
+	 */
+	bool ApplyAction(LPCTSTR Action, const FixedLenStr &PathFromReg, LPCTSTR PathString, FixedLenStr &NewPathStr, PathNormalizer &normalizer)
+	{
+		PhaseTimer timer(g_stats.transformTime);
+		g_stats.transforms++;
+
+		const StrSpan value = PathFromReg.Span();
+		const StrSpan yourPath = StrSpan::Of(PathString);
+
+		if (lstrcmpi(Action, _T("A")) == 0)
+		{
+			return EditPathMatching<AppendAction>(value, yourPath, NewPathStr, normalizer);
+		}
+		else if (lstrcmpi(Action, _T("P")) == 0)
+		{
+			return EditPathMatching<PrependAction>(value, yourPath, NewPathStr, normalizer);
+		}
+		else if (lstrcmpi(Action, _T("R")) == 0)
+		{
+			return EditPathMatching<RemoveAction>(value, yourPath, NewPathStr, normalizer);
+		}
+		else if (lstrcmpi(Action, _T("D")) == 0)
+		{
+			return EditPathMatching<DedupeAction>(value, yourPath, NewPathStr, normalizer);
+		}
+		else if (lstrcmpi(Action, _T("C")) == 0)
+		{
+			if (lstrcmpi(PathString, _T("/MISSING")) == 0)
+			{
+				return EditPathMatching<CompactMissingAction>(value, yourPath, NewPathStr, normalizer);
+			}
+			return EditPathMatching<CompactAction>(value, yourPath, NewPathStr, normalizer);
+		}
+		return false;
+	}
+
+	//! New value of one (EnvVarName, RegLoc) group, computed before it is written.
+	struct PendingValue
+	{
+		//! where the value lives
+		EnvStore store;
+
+		//! the first entry of the group
+		EditEntry *first;
+
+		//! value as read, kept to be compared and restored
+		GrowString ReadValue;
+
+		//! type of ReadValue, REG_NONE if missing
+		DWORD ValueType;
+
+		//! edited value
+		GrowString Value;
+
+		//! work buffer of edits
+		GrowString NewValue;
+
+		//! ReadValue or Value, whichever has the result
+		const FixedLenStr *current;
+
+		//! true once written
+		bool written;
+
+		//! group computed before this one, or nullptr
+		PendingValue *prev;
+
+		//! ctor
+		PendingValue() : first(nullptr), ValueType(REG_NONE), current(&ReadValue), written(false), prev(nullptr)
+		{
+
+		}
+
+		//! The edits result in a value other than the read one.
+		bool IsChanged() const
+		{
+			return !current->Span().Equals(ReadValue.Span());
+		}
+	};
+
+	//! Read the value of the group of first, and apply all edits of the group in memory.
+	/*!
+		@param first the first not yet done entry of the group. Entries of the group are marked done.
+		@param select store of RegLoc. Entries of the same EnvVarName and store make a group.
+		@return false if any edit of the group fails.
+	 */
+	bool ComputeEditGroup(EditEntry *first, PendingValue &pending, PathNormalizer &normalizer, SelectStore select)
+	{
+		pending.first = first;
+
+		bool success = select(first->RegLoc, pending.store);
+		success = success && pending.store.Get(first->EnvVarName, pending.ReadValue, pending.ValueType);
+
+		for (EditEntry *entry = first; entry != nullptr; entry = entry->next)
+		{
+			if (entry->done)
+			{
+				continue;
+			}
+
+			EnvStore entryStore;
+			select(entry->RegLoc, entryStore);
+			if (entryStore.IsSameAs(pending.store) && lstrcmpi(entry->EnvVarName, first->EnvVarName) == 0)
+			{
+				entry->done = true;
+
+				if (success)
+				{
+					// the first edit reads ReadValue, and it is kept to be compared at last
+					success = ApplyAction(entry->Action, *pending.current, entry->PathString, pending.NewValue, normalizer);
+					pending.Value.Swap(pending.NewValue);
+					pending.current = &pending.Value;
+				}
+			}
+		}
+		return success;
+	}
+}
@@ -0,0 +1,265 @@
+//! @file EditQueue.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "ShortString.h"
+
+namespace Utils
+{
+	//! One queued (EnvVarName, Action, RegLoc, PathString) tuple.
+	struct EditEntry
+	{
+		//! next entry, in pop order
+		EditEntry *next;
+
+		//! true once this entry has been applied as a part of its group
+		bool done;
+
+		LPTSTR EnvVarName;
+		LPTSTR Action;
+		LPTSTR RegLoc;
+		LPTSTR PathString;
+	};
+
+	//! Entries of EditQueue, kept between plugin calls.
+	/*!
+		@remarks Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	struct EditList
+	{
+		//! first entry
+		EditEntry *first;
+
+		//! last entry
+		EditEntry *last;
+
+		//! number of entries
+		size_t count;
+	};
+
+	//! A list of edits popped from NSIS stack (without CRT)
+	/*!
+		@remarks Each entry is a single GlobalAlloc block holding EnvVarName and PathString of g_stringsize,
+		and Action and RegLoc of ShortString::Length.
+	 */
+	class EditQueue : public EditList
+	{
+	public:
+		//! ctor
+		EditQueue()
+		{
+			first = nullptr;
+			last = nullptr;
+			count = 0;
+		}
+
+		//! dtor
+		~EditQueue()
+		{
+			Clear();
+		}
+
+		//! Release all entries.
+		void Clear()
+		{
+			while (first != nullptr)
+			{
+				EditEntry *next = first->next;
+				GlobalFree(first);
+				first = next;
+			}
+			last = nullptr;
+			count = 0;
+		}
+
+		//! Pop tuples until terminator string.
+		/*!
+			@param terminator such as "/END"
+			@return false on stack underflow or out of memory.
+			@remarks On failure all strings popped by this call are pushed back, and nothing is added:
+			a missing terminator leaves the stack of the caller as it was.
+		 */
+		bool PopUntil(LPCTSTR terminator)
+		{
+			EditQueue popped;
+			while (true)
+			{
+				EditEntry *entry = Allocate();
+				if (entry == nullptr)
+				{
+					popped.PushBack();
+					return false;
+				}
+				if (!PopString(entry->EnvVarName))
+				{
+					GlobalFree(entry);
+					popped.PushBack();
+					return false;
+				}
+				if (lstrcmpi(entry->EnvVarName, terminator) == 0)
+				{
+					GlobalFree(entry);
+					popped.MoveTo(*this);
+					return true;
+				}
+				if (!popped.PopRest(entry))
+				{
+					popped.PushBack();
+					return false;
+				}
+			}
+		}
+
+		//! Pop one tuple.
+		/*!
+			@return false on stack underflow or out of memory. Strings of a partial tuple are pushed back.
+		 */
+		bool Pop()
+		{
+			EditEntry *entry = Allocate();
+			if (entry == nullptr)
+			{
+				return false;
+			}
+			if (!PopString(entry->EnvVarName))
+			{
+				GlobalFree(entry);
+				return false;
+			}
+			return PopRest(entry);
+		}
+
+		//! Push all entries back to the stack, so that they pop in the same order again, and release them.
+		/*!
+			@remarks Action and RegLoc are pushed as popped: truncated to ShortString::Length.
+		 */
+		void PushBack()
+		{
+			// reverse the list, so that the first entry is pushed last
+			EditEntry *reversed = nullptr;
+			while (first != nullptr)
+			{
+				EditEntry *next = first->next;
+				first->next = reversed;
+				reversed = first;
+				first = next;
+			}
+			for (EditEntry *entry = reversed; entry != nullptr; entry = entry->next)
+			{
+				PushString(entry->PathString);
+				PushString(entry->RegLoc);
+				PushString(entry->Action);
+				PushString(entry->EnvVarName);
+			}
+			first = reversed;
+			Clear();
+		}
+
+		//! Move all entries to the tail of list.
+		void MoveTo(EditList &list)
+		{
+			if (first != nullptr)
+			{
+				if (list.last == nullptr)
+				{
+					list.first = first;
+				}
+				else
+				{
+					list.last->next = first;
+				}
+				list.last = last;
+				list.count += count;
+			}
+			first = nullptr;
+			last = nullptr;
+			count = 0;
+		}
+
+		//! Take all entries of list, to be released by this.
+		void TakeFrom(EditList &list)
+		{
+			Clear();
+			first = list.first;
+			last = list.last;
+			count = list.count;
+			list.first = nullptr;
+			list.last = nullptr;
+			list.count = 0;
+		}
+
+	private:
+		//! Pop Action, RegLoc and PathString of entry, and link it.
+		/*!
+			@remarks On failure, the strings popped for entry are pushed back, and entry is freed.
+		 */
+		bool PopRest(EditEntry *entry)
+		{
+			if (!PopStringN(entry->Action, ShortString::Length))
+			{
+				return Unpop(entry, 1);
+			}
+			if (!PopStringN(entry->RegLoc, ShortString::Length))
+			{
+				return Unpop(entry, 2);
+			}
+			if (!PopString(entry->PathString))
+			{
+				return Unpop(entry, 3);
+			}
+			Add(entry);
+			return true;
+		}
+
+		//! Push back the first popped strings of a not linked entry, in reverse order, and free it.
+		/*!
+			@param popped 1 for EnvVarName, 2 for Action too, and 3 for RegLoc too.
+			@return false always.
+		 */
+		static bool Unpop(EditEntry *entry, int popped)
+		{
+			LPCTSTR const texts[] = { entry->EnvVarName, entry->Action, entry->RegLoc };
+			while (popped > 0)
+			{
+				popped--;
+				PushString(texts[popped]);
+			}
+			GlobalFree(entry);
+			return false;
+		}
+
+		//! Allocate an entry with 2 string slots of g_stringsize, and 2 short slots.
+		EditEntry *Allocate()
+		{
+			const size_t slot = g_stringsize + 1;
+			const size_t shortSlot = ShortString::Length;
+			EditEntry *entry = (EditEntry *)GlobalAlloc(GPTR, sizeof(EditEntry) + (2 * slot + 2 * shortSlot) * sizeof(TCHAR));
+			if (entry != nullptr)
+			{
+				LPTSTR text = reinterpret_cast<LPTSTR>(entry + 1);
+				entry->EnvVarName = text;
+				entry->PathString = text + slot;
+				entry->Action = text + 2 * slot;
+				entry->RegLoc = text + 2 * slot + shortSlot;
+			}
+			return entry;
+		}
+
+		//! Link entry at tail.
+		void Add(EditEntry *entry)
+		{
+			if (last == nullptr)
+			{
+				first = entry;
+			}
+			else
+			{
+				last->next = entry;
+			}
+			last = entry;
+			count++;
+		}
+	};
+}
@@ -0,0 +1,140 @@
+//! @file EnvStore.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "FixedLenStr.h"
+#include "Stats.h"
+
+namespace Utils
+{
+	//! getter prototype
+	/*!
+		@param ValueType REG_SZ or REG_EXPAND_SZ, or REG_NONE for a missing value which is read as empty.
+	 */
+	typedef bool(*GetRegValue)(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType);
+
+	//! setter prototype
+	/*!
+		@param ValueType REG_SZ or REG_EXPAND_SZ, or REG_NONE to delete the value.
+	 */
+	typedef bool(*SetRegValue)(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType);
+
+	//! getter error fallback
+	bool GetNullRegValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		return false;
+	}
+
+	//! setter error fallback
+	bool SetNullRegValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		return false;
+	}
+
+	//! Value type to write NewValue, which was read as ReadType.
+	/*!
+		@remarks REG_SZ is kept unless NewValue refers to %VAR%. New values are REG_EXPAND_SZ.
+	 */
+	DWORD ChooseValueType(DWORD ReadType, const FixedLenStr &NewValue)
+	{
+		if (ReadType == REG_SZ)
+		{
+			const StrSpan value = NewValue.Span();
+			if (FindChar(value.ptr, value.len, _T('%')) == value.len)
+			{
+				return REG_SZ;
+			}
+		}
+		return REG_EXPAND_SZ;
+	}
+
+	//! I/O counters shared by all stores
+	struct StoreCounters
+	{
+		//! getter calls
+		size_t reads;
+
+		//! setter calls
+		size_t writes;
+
+		//! string bytes returned by getter
+		size_t bytesRead;
+
+		//! string bytes passed to setter
+		size_t bytesWritten;
+
+		//! registry key open calls
+		size_t keyOpens;
+
+		//! registry reads answered by remembered values
+		size_t cacheHits;
+
+		//! registry reads done
+		size_t cacheMisses;
+	};
+
+	//! counters of this DLL instance
+	StoreCounters g_storeCounters;
+
+	//! A place where environment variables live, such as HKCU\\Environment.
+	/*!
+		@remarks
+		A getter/setter pair with its context. Backends are:
+		@li RegistryStore.h: Win32 registry
+		@li MemoryStore.h: in-memory map, optionally loaded from and saved to a file
+	 */
+	class EnvStore
+	{
+	public:
+		//! backend getter
+		GetRegValue getter;
+
+		//! backend setter
+		SetRegValue setter;
+
+		//! backend instance passed to getter and setter
+		void *context;
+
+		//! ctor with null backend
+		EnvStore() : getter(GetNullRegValue), setter(SetNullRegValue), context(nullptr)
+		{
+
+		}
+
+		//! ctor
+		EnvStore(GetRegValue getter, SetRegValue setter, void *context) : getter(getter), setter(setter), context(context)
+		{
+
+		}
+
+		//! Read value. A missing value is read as empty string, with REG_NONE.
+		bool Get(LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+		{
+			PhaseTimer timer(g_stats.getTime);
+			g_storeCounters.reads++;
+			if (getter(context, EnvVarName, ResultVar, ValueType))
+			{
+				g_storeCounters.bytesRead += ResultVar.StringBytesLength();
+				return true;
+			}
+			return false;
+		}
+
+		//! Write value.
+		bool Set(LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+		{
+			PhaseTimer timer(g_stats.setTime);
+			g_storeCounters.writes++;
+			g_storeCounters.bytesWritten += NewValue.StringBytesLength();
+			return setter(context, EnvVarName, NewValue, ValueType);
+		}
+
+		//! Both stores refer to the same backend instance.
+		bool IsSameAs(const EnvStore &other) const
+		{
+			return getter == other.getter && setter == other.setter && context == other.context;
+		}
+	};
+}
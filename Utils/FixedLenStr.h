@@ -4,7 +4,9 @@
 
 #pragma once
 
-#include "ZeroFill.h"
+#include "Arena.h"
+#include "StrSpan.h"
+#include "NsisStack.h"
 
 namespace Utils
 {
@@ -21,29 +23,78 @@ namespace Utils
 		//! max position in TCHAR count (excluding one null barrier char)
 		size_t maxPos;
 
+		//! arena owning msgbuf, or nullptr if msgbuf is from GlobalAlloc
+		Arena *arena;
+
+		//! true if Reserve may reallocate msgbuf
+		bool growable;
+
 	protected:
 		//! ctor with 
-		FixedLenStr(size_t maxCharCount) : maxPos(0)
+		/*!
+			@remarks Allocates from Arena::current if any. The buffer is not zero filled.
+		 */
+		FixedLenStr(size_t maxCharCount, bool growable = false) : maxPos(0), arena(Arena::current), growable(growable)
 		{
-			msgbuf = (LPTSTR)GlobalAlloc(GPTR, (maxCharCount + 1) * sizeof(TCHAR));
+			msgbuf = Allocate(maxCharCount);
 
 			if (msgbuf != nullptr)
 			{
 				maxPos = maxCharCount;
+				msgbuf[0] = 0;
+				msgbuf[maxPos] = 0;
 			}
 		}
 
 	public:
+		//! Make room for a string of charCount.
+		/*!
+			@return false if it does not fit and this is not growable, or out of memory.
+			@remarks Growable string grows at least twice, or exactly to charCount if larger, and keeps its content.
+		 */
+		bool Reserve(size_t charCount)
+		{
+			if (msgbuf != nullptr && charCount <= maxPos)
+			{
+				return true;
+			}
+			if (!growable)
+			{
+				return false;
+			}
+			size_t newMaxPos = maxPos * 2;
+			if (newMaxPos < charCount)
+			{
+				newMaxPos = charCount;
+			}
+			LPTSTR newBuf = Allocate(newMaxPos);
+			if (newBuf == nullptr)
+			{
+				return false;
+			}
+			newBuf[0] = 0;
+			newBuf[newMaxPos] = 0;
+			if (msgbuf != nullptr)
+			{
+				lstrcpyn(newBuf, msgbuf, static_cast<int>(maxPos + 1));
+				if (arena == nullptr)
+				{
+					GlobalFree(msgbuf);
+				}
+			}
+			msgbuf = newBuf;
+			maxPos = newMaxPos;
+			return true;
+		}
+
 		//! Assign from external string
 		bool AssignString(const FixedLenStr &source)
 		{
 			if (true
-				&& msgbuf != nullptr
 				&& source.msgbuf != nullptr
-				&& source.StringCharCount() < BufferCharCount()
+				&& Reserve(source.StringCharCount() + 1)
 				)
 			{
-				Clear();
 				lstrcpy(msgbuf, source.msgbuf);
 				return true;
 			}
@@ -54,43 +105,51 @@ namespace Utils
 		//! @param charCount -1 is invalid.
 		bool AssignString(LPCTSTR source, size_t offset, size_t charCount)
 		{
-			if (msgbuf != nullptr && charCount < BufferCharCount(true))
+			if (Reserve(charCount))
 			{
-				Clear();
-				lstrcpyn(msgbuf, source + offset, charCount + 1);
+				lstrcpyn(msgbuf, source + offset, static_cast<int>(charCount + 1));
 				return true;
 			}
 			return false;
 		}
 
-		//! Append string if not empty.
-		bool AppendStringIfNotEmpty(LPCTSTR text)
-		{
-			if (StringCharCount() != 0)
-			{
-				return AppendString(text);
-			}
-			return true;
-		}
-
 		//! Append single null terminated string.
 		bool AppendString(LPCTSTR text)
 		{
 			const size_t textLen = lstrlen(text);
-			LPTSTR appendAt = msgbuf + lstrlen(msgbuf);
-			LPTSTR endAt = msgbuf + maxPos;
-			if (appendAt + textLen < endAt)
+			const size_t stringLen = StringCharCount();
+			if (Reserve(stringLen + textLen + 1))
 			{
-				lstrcpy(appendAt, text);
+				lstrcpy(msgbuf + stringLen, text);
 				return true;
 			}
 			return false;
 		}
 
-		//! Clear string buffer.
+		//! Exchange buffers with another string.
+		void Swap(FixedLenStr &other)
+		{
+			LPTSTR otherBuf = other.msgbuf;
+			size_t otherMaxPos = other.maxPos;
+			Arena *otherArena = other.arena;
+			bool otherGrowable = other.growable;
+			other.msgbuf = msgbuf;
+			other.maxPos = maxPos;
+			other.arena = arena;
+			other.growable = growable;
+			msgbuf = otherBuf;
+			maxPos = otherMaxPos;
+			arena = otherArena;
+			growable = otherGrowable;
+		}
+
+		//! Clear string. Only the first char is written.
 		void Clear()
 		{
-			ZeroFill(msgbuf, BufferBytesLength(true));
+			if (msgbuf != nullptr)
+			{
+				msgbuf[0] = 0;
+			}
 		}
 
 		//! Return written string length in TCHAR count.
@@ -120,7 +179,7 @@ namespace Utils
 		//! NSIS pushstring
 		void Push()
 		{
-			pushstring(msgbuf);
+			PushString(msgbuf);
 		}
 
 		//! NSIS popstring
@@ -128,7 +187,7 @@ namespace Utils
 		{
 			if (msgbuf != nullptr)
 			{
-				if (popstring(msgbuf) == 0)
+				if (PopString(msgbuf))
 				{
 					return true;
 				}
@@ -157,39 +216,24 @@ namespace Utils
 		//! dtor
 		~FixedLenStr()
 		{
-			if (msgbuf != nullptr)
+			if (msgbuf != nullptr && arena == nullptr)
 			{
 				GlobalFree(msgbuf);
 			}
 		}
 
-		//! Split path to tokens separated by delimiter.
-		/*!
-			@param nextPos 0 for initial start.
-		 */
-		bool GetToken(TCHAR delim, size_t &nextPos, FixedLenStr &outStr)
+		//! View of written string.
+		StrSpan Span() const
 		{
-			if (msgbuf != nullptr)
-			{
-				const size_t maxLen = lstrlen(msgbuf);
-				const size_t lastPos = nextPos;
-				if (maxLen <= nextPos)
-				{
-					return false;
-				}
-				while (true)
-				{
-					TCHAR oneChar = msgbuf[nextPos];
-					if (oneChar == delim || oneChar == 0 || maxLen < nextPos)
-					{
-						bool result = outStr.AssignString(msgbuf, lastPos, nextPos - lastPos);
-						nextPos++;
-						return result;
-					}
-					nextPos++;
-				}
-			}
-			return false;
+			return StrSpan::Of(msgbuf);
+		}
+
+	private:
+		//! Allocate buffer of maxCharCount and one null barrier, from arena or GlobalAlloc.
+		LPTSTR Allocate(size_t maxCharCount)
+		{
+			const size_t bytes = (maxCharCount + 1) * sizeof(TCHAR);
+			return (LPTSTR)((arena != nullptr) ? arena->Allocate(bytes) : GlobalAlloc(GMEM_FIXED, bytes));
 		}
 	};
 }
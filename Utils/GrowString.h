@@ -0,0 +1,25 @@
+//! @file GrowString.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "FixedLenStr.h"
+
+namespace Utils
+{
+	//! A string growing geometrically, with no length limit (without CRT)
+	/*!
+		@remarks
+		Starts small, and is sized by Reserve, e.g. from the value size reported by RegQueryValueEx.
+	 */
+	class GrowString : public FixedLenStr
+	{
+	public:
+		//! ctor
+		GrowString(size_t initialCharCount = 256) : FixedLenStr(initialCharCount, true)
+		{
+
+		}
+	};
+}
@@ -0,0 +1,311 @@
+//! @file MemoryStore.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "EnvStore.h"
+
+namespace Utils
+{
+	//! One variable of MemoryStore.
+	struct MemoryEntry
+	{
+		//! next entry
+		MemoryEntry *next;
+
+		//! null terminated name
+		LPTSTR name;
+
+		//! null terminated value, following name in the same allocation
+		LPTSTR value;
+
+		//! REG_SZ or REG_EXPAND_SZ
+		DWORD type;
+	};
+
+	//! In-memory environment variable store (without CRT)
+	/*!
+		@remarks
+		Names are compared case insensitively, like the registry does.
+		Contents can be loaded from and saved to a file of "NAME=VALUE" lines, in TCHAR encoding.
+		Value types are not saved: loaded values are REG_EXPAND_SZ.
+		Snapshot keeps a copy of all entries, to go back to by Rollback.
+	 */
+	class MemoryStore
+	{
+	public:
+		//! first entry
+		MemoryEntry *first;
+
+		//! file path to save on each Set, or nullptr
+		LPCTSTR filePath;
+
+		//! entries copied by Snapshot, or nullptr
+		MemoryEntry *snapshot;
+
+		//! true while snapshot is taken, even if no entries
+		bool hasSnapshot;
+
+		//! ctor
+		MemoryStore() : first(nullptr), filePath(nullptr), snapshot(nullptr), hasSnapshot(false)
+		{
+
+		}
+
+		//! dtor
+		~MemoryStore()
+		{
+			Clear();
+			Commit();
+		}
+
+		//! Remove all entries.
+		void Clear()
+		{
+			Free(first);
+		}
+
+		//! Copy all entries, to Rollback later.
+		bool Snapshot()
+		{
+			Commit();
+			hasSnapshot = true;
+			MemoryEntry **link = &snapshot;
+			for (MemoryEntry *entry = first; entry != nullptr; entry = entry->next)
+			{
+				*link = Copy(entry);
+				if (*link == nullptr)
+				{
+					Commit();
+					return false;
+				}
+				link = &(*link)->next;
+			}
+			return true;
+		}
+
+		//! Go back to the last Snapshot, and drop it.
+		bool Rollback()
+		{
+			if (!hasSnapshot)
+			{
+				return false;
+			}
+			Clear();
+			first = snapshot;
+			snapshot = nullptr;
+			hasSnapshot = false;
+			return filePath == nullptr || Save(filePath);
+		}
+
+		//! Keep changes since the last Snapshot, and drop it.
+		void Commit()
+		{
+			Free(snapshot);
+			hasSnapshot = false;
+		}
+
+		//! Remove entry by name.
+		void Remove(LPCTSTR name)
+		{
+			MemoryEntry **link = &first;
+			while (*link != nullptr && lstrcmpi((*link)->name, name) != 0)
+			{
+				link = &(*link)->next;
+			}
+			if (*link != nullptr)
+			{
+				MemoryEntry *entry = *link;
+				*link = entry->next;
+				GlobalFree(entry);
+			}
+		}
+
+		//! Find entry by name.
+		MemoryEntry *Find(LPCTSTR name) const
+		{
+			for (MemoryEntry *entry = first; entry != nullptr; entry = entry->next)
+			{
+				if (lstrcmpi(entry->name, name) == 0)
+				{
+					return entry;
+				}
+			}
+			return nullptr;
+		}
+
+		//! Add or replace entry.
+		/*!
+			@param valueLen value length in TCHAR count.
+		 */
+		bool Put(LPCTSTR name, size_t nameLen, LPCTSTR value, size_t valueLen, DWORD type = REG_EXPAND_SZ)
+		{
+			MemoryEntry *entry = (MemoryEntry *)GlobalAlloc(GPTR, sizeof(MemoryEntry) + (nameLen + valueLen + 2) * sizeof(TCHAR));
+			if (entry == nullptr)
+			{
+				return false;
+			}
+			entry->name = reinterpret_cast<LPTSTR>(entry + 1);
+			entry->value = entry->name + nameLen + 1;
+			entry->type = type;
+			lstrcpyn(entry->name, name, static_cast<int>(nameLen + 1));
+			lstrcpyn(entry->value, value, static_cast<int>(valueLen + 1));
+
+			MemoryEntry **link = &first;
+			while (*link != nullptr && lstrcmpi((*link)->name, entry->name) != 0)
+			{
+				link = &(*link)->next;
+			}
+			if (*link != nullptr)
+			{
+				entry->next = (*link)->next;
+				GlobalFree(*link);
+			}
+			*link = entry;
+			return true;
+		}
+
+		//! Load "NAME=VALUE" lines from file. Existing entries having same name are replaced.
+		bool Load(LPCTSTR path)
+		{
+			HANDLE file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			bool success = false;
+			DWORD bytes = GetFileSize(file, NULL);
+			LPTSTR text = (LPTSTR)GlobalAlloc(GPTR, bytes + sizeof(TCHAR));
+			DWORD bytesRead = 0;
+			if (text != nullptr && ReadFile(file, text, bytes, &bytesRead, NULL) && bytesRead == bytes)
+			{
+				success = true;
+				const size_t textLen = bytes / sizeof(TCHAR);
+				size_t lineStart = 0;
+				while (lineStart < textLen)
+				{
+					size_t lineEnd = lineStart;
+					size_t equalAt = 0;
+					while (lineEnd < textLen && text[lineEnd] != _T('\n'))
+					{
+						if (equalAt == 0 && text[lineEnd] == _T('='))
+						{
+							equalAt = lineEnd;
+						}
+						lineEnd++;
+					}
+					size_t valueEnd = lineEnd;
+					if (lineStart < valueEnd && text[valueEnd - 1] == _T('\r'))
+					{
+						valueEnd--;
+					}
+					if (lineStart < equalAt)
+					{
+						success &= Put(text + lineStart, equalAt - lineStart, text + equalAt + 1, valueEnd - equalAt - 1);
+					}
+					lineStart = lineEnd + 1;
+				}
+			}
+			if (text != nullptr)
+			{
+				GlobalFree(text);
+			}
+			CloseHandle(file);
+			return success;
+		}
+
+		//! Save all entries as "NAME=VALUE" lines.
+		bool Save(LPCTSTR path) const
+		{
+			HANDLE file = CreateFile(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			bool success = true;
+			for (MemoryEntry *entry = first; entry != nullptr; entry = entry->next)
+			{
+				success &= Write(file, entry->name, lstrlen(entry->name));
+				success &= Write(file, _T("="), 1);
+				success &= Write(file, entry->value, lstrlen(entry->value));
+				success &= Write(file, _T("\n"), 1);
+			}
+			CloseHandle(file);
+			return success;
+		}
+
+		//! getter for EnvStore
+		static bool GetValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+		{
+			MemoryEntry *entry = reinterpret_cast<MemoryStore *>(context)->Find(EnvVarName);
+			if (entry == nullptr)
+			{
+				ValueType = REG_NONE;
+				ResultVar.Clear();
+				return ResultVar.BufferCharCount() != 0;
+			}
+			ValueType = entry->type;
+			return ResultVar.AssignString(entry->value, 0, lstrlen(entry->value));
+		}
+
+		//! setter for EnvStore
+		static bool SetValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+		{
+			MemoryStore *self = reinterpret_cast<MemoryStore *>(context);
+			if (ValueType == REG_NONE)
+			{
+				self->Remove(EnvVarName);
+				return self->filePath == nullptr || self->Save(self->filePath);
+			}
+			if (self->Put(EnvVarName, lstrlen(EnvVarName), NewValue, NewValue.StringCharCount(), ValueType))
+			{
+				return self->filePath == nullptr || self->Save(self->filePath);
+			}
+			return false;
+		}
+
+		//! Obtain EnvStore bound to this instance.
+		EnvStore Store()
+		{
+			return EnvStore(GetValue, SetValue, this);
+		}
+
+	private:
+		//! Copy one entry, unlinked.
+		static MemoryEntry *Copy(const MemoryEntry *entry)
+		{
+			const size_t nameLen = lstrlen(entry->name);
+			const size_t valueLen = lstrlen(entry->value);
+			MemoryEntry *copy = (MemoryEntry *)GlobalAlloc(GPTR, sizeof(MemoryEntry) + (nameLen + valueLen + 2) * sizeof(TCHAR));
+			if (copy != nullptr)
+			{
+				copy->name = reinterpret_cast<LPTSTR>(copy + 1);
+				copy->value = copy->name + nameLen + 1;
+				copy->type = entry->type;
+				lstrcpy(copy->name, entry->name);
+				lstrcpy(copy->value, entry->value);
+			}
+			return copy;
+		}
+
+		//! Free a list of entries.
+		static void Free(MemoryEntry *&list)
+		{
+			while (list != nullptr)
+			{
+				MemoryEntry *next = list->next;
+				GlobalFree(list);
+				list = next;
+			}
+		}
+
+		//! Write TCHARs to file.
+		static bool Write(HANDLE file, LPCTSTR text, size_t charCount)
+		{
+			DWORD bytesWritten = 0;
+			const DWORD bytes = static_cast<DWORD>(charCount * sizeof(TCHAR));
+			return WriteFile(file, text, bytes, &bytesWritten, NULL) && bytesWritten == bytes;
+		}
+	};
+}
@@ -0,0 +1,79 @@
+//! @file NsisStack.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <nsis/pluginapi.h> // nsis plugin
+
+namespace Utils
+{
+	//! NSIS stack traffic
+	struct StackCounters
+	{
+		//! strings pushed
+		size_t pushes;
+
+		//! strings popped
+		size_t pops;
+
+		//! bytes of stack entries allocated by NSIS for pushes
+		size_t bytesPushed;
+	};
+
+	//! counters of this DLL instance
+	StackCounters g_stackCounters;
+
+	//! Bytes of one stack entry. NSIS allocates g_stringsize chars for each, regardless of text length.
+	size_t StackEntryBytes()
+	{
+		return sizeof(stack_t) + g_stringsize * sizeof(TCHAR);
+	}
+
+	//! pushstring, counted.
+	void PushString(LPCTSTR text)
+	{
+		g_stackCounters.pushes++;
+		g_stackCounters.bytesPushed += StackEntryBytes();
+		pushstring(text);
+	}
+
+	//! pushint, counted.
+	void PushInt(INT_PTR value)
+	{
+		g_stackCounters.pushes++;
+		g_stackCounters.bytesPushed += StackEntryBytes();
+		pushintptr(value);
+	}
+
+	//! popstring, counted.
+	/*!
+		@param text buffer of g_stringsize chars.
+		@return false on stack underflow.
+	 */
+	bool PopString(LPTSTR text)
+	{
+		if (popstring(text) != 0)
+		{
+			return false;
+		}
+		g_stackCounters.pops++;
+		return true;
+	}
+
+	//! popstringn, counted.
+	/*!
+		@param text buffer of maxLen chars, including null.
+		@param maxLen longer string is truncated to maxLen - 1 chars.
+		@return false on stack underflow.
+	 */
+	bool PopStringN(LPTSTR text, int maxLen)
+	{
+		if (popstringn(text, maxLen) != 0)
+		{
+			return false;
+		}
+		g_stackCounters.pops++;
+		return true;
+	}
+}
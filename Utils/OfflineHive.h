@@ -0,0 +1,1093 @@
+//! @file OfflineHive.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "EnvStore.h"
+#include "WideText.h"
+
+namespace Utils
+{
+	//! Environment key of a hive file not loaded by Windows, such as NTUSER.DAT and SYSTEM of an offline image.
+	/*!
+		@remarks
+		The regf format is read and written here, without any DLL.
+		The whole file is read in memory. A write changes only the cells of the value:
+		data that fits its cell is rewritten in place, and other cells are taken from free cells of the hive,
+		or from a bin added at the end. All other cells are kept byte for byte.
+		A hive having unapplied transaction log entries, where the primary and secondary sequence numbers differ, is not opened.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	class OfflineHive
+	{
+	public:
+		//! Open hive file, and its environment key.
+		/*!
+			@param hivePath NTUSER.DAT for HKCU, or SYSTEM for HKLM.
+			@param system true to open "ControlSet00x\Control\Session Manager\Environment", of the control set in "Select\Current".
+			@return false if already open, the file is not a consistent hive, or the key is not found.
+		 */
+		bool Open(LPCTSTR hivePath, bool system)
+		{
+			if (IsOpen())
+			{
+				return false;
+			}
+			WideText widePath(hivePath);
+			if (widePath.text == nullptr || lstrlenW(widePath.text) >= MAX_PATH - 4)
+			{
+				return false;
+			}
+			lstrcpyW(path, widePath.text);
+			written = false;
+			damaged = false;
+
+			if (!Read())
+			{
+				Close(false);
+				return false;
+			}
+
+			WCHAR keyName[64];
+			if (system)
+			{
+				DWORD current = 0;
+				if (!ReadDword(FindKey(Get32(data + RootCellField), L"Select"), L"Current", current) || current == 0 || current > 999)
+				{
+					Close(false);
+					return false;
+				}
+				wsprintfW(keyName, L"ControlSet%03u\\Control\\Session Manager\\Environment", current);
+			}
+			else
+			{
+				lstrcpyW(keyName, L"Environment");
+			}
+			keyCell = FindKey(Get32(data + RootCellField), keyName);
+			if (keyCell == NoCell)
+			{
+				Close(false);
+				return false;
+			}
+			return true;
+		}
+
+		//! Hive is open.
+		bool IsOpen() const
+		{
+			return data != nullptr;
+		}
+
+		//! Read value. A missing value is read as empty string, with REG_NONE.
+		bool Get(LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+		{
+			WideText name(EnvVarName);
+			if (!IsOpen() || name.text == nullptr)
+			{
+				return false;
+			}
+			ResultVar.Clear();
+			DWORD index;
+			const DWORD value = FindValue(name.text, index);
+			if (value == NoCell)
+			{
+				ValueType = REG_NONE;
+				return true;
+			}
+			ValueType = Get32(Body(value, VkNameField) + VkTypeField);
+			if (ValueType != REG_SZ && ValueType != REG_EXPAND_SZ)
+			{
+				return false;
+			}
+			DWORD bytes;
+			LPBYTE raw = ReadData(value, bytes);
+			if (raw == nullptr)
+			{
+				return false;
+			}
+
+			// UTF-16LE, up to the first null
+			const DWORD count = bytes / 2;
+			LPWSTR wide = (LPWSTR)GlobalAlloc(GMEM_FIXED, (count + 1) * sizeof(WCHAR));
+			bool success = false;
+			if (wide != nullptr)
+			{
+				DWORD length = 0;
+				while (length < count && (raw[2 * length] | raw[2 * length + 1]) != 0)
+				{
+					wide[length] = static_cast<WCHAR>(raw[2 * length] | (raw[2 * length + 1] << 8));
+					length++;
+				}
+				wide[length] = 0;
+#ifdef UNICODE
+				success = ResultVar.AssignString(wide, 0, length);
+#else
+				const int ansiCount = WideCharToMultiByte(CP_ACP, 0, wide, -1, NULL, 0, NULL, NULL);
+				success = ansiCount > 0
+					&& ResultVar.Reserve(ansiCount)
+					&& WideCharToMultiByte(CP_ACP, 0, wide, -1, static_cast<LPSTR>(ResultVar), ansiCount, NULL, NULL) == ansiCount;
+#endif
+				GlobalFree(wide);
+			}
+			GlobalFree(raw);
+			return success;
+		}
+
+		//! Write value in memory. REG_NONE deletes the value.
+		/*!
+			@remarks If a write fails half way, such as out of memory, the hive is not saved by Close.
+		 */
+		bool Set(LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+		{
+			WideText name(EnvVarName);
+			if (!IsOpen() || name.text == nullptr || damaged)
+			{
+				return false;
+			}
+			DWORD index;
+			DWORD value = FindValue(name.text, index);
+			if (ValueType == REG_NONE)
+			{
+				if (value != NoCell)
+				{
+					DeleteValue(value, index);
+					Touch(0, 0);
+					written = true;
+				}
+				return true;
+			}
+
+			WideText text(NewValue);
+			if (text.text == nullptr)
+			{
+				return false;
+			}
+			// UTF-16LE, with null
+			const DWORD chars = static_cast<DWORD>(lstrlenW(text.text)) + 1;
+			const DWORD bytes = chars * 2;
+			LPBYTE encoded = (LPBYTE)GlobalAlloc(GMEM_FIXED, bytes);
+			if (encoded == nullptr)
+			{
+				return false;
+			}
+			for (DWORD pos = 0; pos < chars; pos++)
+			{
+				encoded[2 * pos] = static_cast<BYTE>(text.text[pos] & 0xFF);
+				encoded[2 * pos + 1] = static_cast<BYTE>((text.text[pos] >> 8) & 0xFF);
+			}
+
+			const DWORD nameLen = static_cast<DWORD>(lstrlenW(name.text));
+			if (value == NoCell)
+			{
+				value = AddValue(name.text, nameLen);
+			}
+			const bool success = value != NoCell && WriteData(value, ValueType, encoded, bytes);
+			GlobalFree(encoded);
+			if (!success)
+			{
+				damaged = true;
+				return false;
+			}
+			Touch(nameLen, bytes);
+			written = true;
+			return true;
+		}
+
+		//! Close hive.
+		/*!
+			@param save true to write the hive back to its file, if anything is written.
+			@return false if save failed, or a write failed half way. The file is not changed then.
+			@remarks The hive is saved to "file.new" first, and replaces the file.
+			Both sequence numbers are advanced, so that the file stays consistent, and older log entries are not applied to it.
+		 */
+		bool Close(bool save)
+		{
+			bool success = true;
+			if (save && written && data != nullptr)
+			{
+				success = !damaged && Save();
+			}
+			if (data != nullptr)
+			{
+				GlobalFree(data);
+				data = nullptr;
+			}
+			capacity = 0;
+			binsSize = 0;
+			keyCell = NoCell;
+			written = false;
+			damaged = false;
+			return success;
+		}
+
+	private:
+		//! bytes of the base block, before the first bin. Cell offsets count from its end.
+		static const DWORD BaseBlockSize = 4096;
+
+		//! bins are multiples of this
+		static const DWORD BinAlignment = 4096;
+
+		//! bytes of "hbin" header, before the cells of a bin
+		static const DWORD BinHeaderSize = 32;
+
+		//! bytes of one segment of "db" big data, in hives of version 1.4 or later
+		static const DWORD BigDataSegment = 16344;
+
+		//! offset of no cell
+		static const DWORD NoCell = 0xFFFFFFFF;
+
+		//! data size flag of data stored in the data offset field, up to 4 bytes
+		static const DWORD ResidentData = 0x80000000;
+
+		//! base block: primary sequence number
+		static const DWORD PrimarySequenceField = 4;
+
+		//! base block: secondary sequence number
+		static const DWORD SecondarySequenceField = 8;
+
+		//! base block: last written FILETIME
+		static const DWORD TimestampField = 12;
+
+		//! base block: major version, 1
+		static const DWORD MajorVersionField = 20;
+
+		//! base block: minor version
+		static const DWORD MinorVersionField = 24;
+
+		//! base block: file type, 0 for the primary file
+		static const DWORD FileTypeField = 28;
+
+		//! base block: file format, 1 for direct memory load
+		static const DWORD FileFormatField = 32;
+
+		//! base block: root key cell
+		static const DWORD RootCellField = 36;
+
+		//! base block: bytes of all bins
+		static const DWORD BinsSizeField = 40;
+
+		//! base block: XOR of the dwords before it
+		static const DWORD ChecksumField = 508;
+
+		//! "nk": last written FILETIME
+		static const DWORD NkTimestampField = 4;
+
+		//! "nk": number of subkeys
+		static const DWORD NkSubkeyCountField = 20;
+
+		//! "nk": subkey list cell
+		static const DWORD NkSubkeyListField = 28;
+
+		//! "nk": number of values
+		static const DWORD NkValueCountField = 36;
+
+		//! "nk": value list cell
+		static const DWORD NkValueListField = 40;
+
+		//! "nk": largest value name, in bytes
+		static const DWORD NkMaxValueNameField = 60;
+
+		//! "nk": largest value data, in bytes
+		static const DWORD NkMaxValueDataField = 64;
+
+		//! "nk": name length in bytes
+		static const DWORD NkNameLengthField = 72;
+
+		//! "nk": name
+		static const DWORD NkNameField = 76;
+
+		//! "nk" flag: name is 8 bit chars
+		static const WORD NkCompressedName = 0x0020;
+
+		//! "vk": name length in bytes
+		static const DWORD VkNameLengthField = 2;
+
+		//! "vk": data size, with ResidentData
+		static const DWORD VkDataSizeField = 4;
+
+		//! "vk": data cell, or resident data
+		static const DWORD VkDataField = 8;
+
+		//! "vk": value type
+		static const DWORD VkTypeField = 12;
+
+		//! "vk": flags
+		static const DWORD VkFlagsField = 16;
+
+		//! "vk": name
+		static const DWORD VkNameField = 20;
+
+		//! "vk" flag: name is 8 bit chars
+		static const WORD VkCompressedName = 0x0001;
+
+		//! Read little endian WORD.
+		static WORD Get16(const BYTE *at)
+		{
+			return static_cast<WORD>(at[0] | (at[1] << 8));
+		}
+
+		//! Read little endian DWORD.
+		static DWORD Get32(const BYTE *at)
+		{
+			return static_cast<DWORD>(at[0]) | (static_cast<DWORD>(at[1]) << 8) | (static_cast<DWORD>(at[2]) << 16) | (static_cast<DWORD>(at[3]) << 24);
+		}
+
+		//! Write little endian WORD.
+		static void Set16(LPBYTE at, DWORD value)
+		{
+			at[0] = static_cast<BYTE>(value);
+			at[1] = static_cast<BYTE>(value >> 8);
+		}
+
+		//! Write little endian DWORD.
+		static void Set32(LPBYTE at, DWORD value)
+		{
+			at[0] = static_cast<BYTE>(value);
+			at[1] = static_cast<BYTE>(value >> 8);
+			at[2] = static_cast<BYTE>(value >> 16);
+			at[3] = static_cast<BYTE>(value >> 24);
+		}
+
+		//! Round up to a multiple of alignment.
+		static DWORD Align(DWORD value, DWORD alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		//! Test 2 char signature.
+		static bool IsSignature(const BYTE *at, const char *signature)
+		{
+			return at[0] == static_cast<BYTE>(signature[0]) && at[1] == static_cast<BYTE>(signature[1]);
+		}
+
+		//! Checksum of the base block.
+		DWORD Checksum() const
+		{
+			DWORD checksum = 0;
+			for (DWORD offset = 0; offset < ChecksumField; offset += 4)
+			{
+				checksum ^= Get32(data + offset);
+			}
+			return (checksum == 0) ? 1 : (checksum == 0xFFFFFFFF) ? 0xFFFFFFFE : checksum;
+		}
+
+		//! Size field of cell: negative if allocated, positive if free.
+		LONG CellSize(DWORD cell) const
+		{
+			return static_cast<LONG>(Get32(data + BaseBlockSize + cell));
+		}
+
+		//! Body of an allocated cell having at least bytes, or nullptr.
+		LPBYTE Body(DWORD cell, DWORD bytes) const
+		{
+			if (cell == NoCell || cell % 8 != 0 || cell >= binsSize || binsSize - cell < 4)
+			{
+				return nullptr;
+			}
+			const LONG size = CellSize(cell);
+			if (size >= 0 || static_cast<DWORD>(-size) > binsSize - cell || static_cast<DWORD>(-size) - 4 < bytes)
+			{
+				return nullptr;
+			}
+			return data + BaseBlockSize + cell + 4;
+		}
+
+		//! Bytes available in body of an allocated cell.
+		DWORD Capacity(DWORD cell) const
+		{
+			return static_cast<DWORD>(-CellSize(cell)) - 4;
+		}
+
+		//! Read and check the hive file: base block, and that bins and cells cover the hive data.
+		bool Read()
+		{
+			HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			const DWORD size = GetFileSize(file, NULL);
+			data = (size == INVALID_FILE_SIZE || size < BaseBlockSize + BinAlignment) ? nullptr : (LPBYTE)GlobalAlloc(GMEM_FIXED, size);
+			DWORD bytesRead = 0;
+			const bool read = data != nullptr && ReadFile(file, data, size, &bytesRead, NULL) && bytesRead == size;
+			CloseHandle(file);
+			if (!read)
+			{
+				return false;
+			}
+			capacity = size;
+			binsSize = Get32(data + BinsSizeField);
+			if (false
+				|| data[0] != 'r' || data[1] != 'e' || data[2] != 'g' || data[3] != 'f'
+				|| Get32(data + PrimarySequenceField) != Get32(data + SecondarySequenceField)
+				|| Get32(data + MajorVersionField) != 1
+				|| Get32(data + MinorVersionField) < 2 || Get32(data + MinorVersionField) > 6
+				|| Get32(data + FileTypeField) != 0
+				|| Get32(data + FileFormatField) != 1
+				|| Get32(data + ChecksumField) != Checksum()
+				|| binsSize == 0 || binsSize % BinAlignment != 0 || binsSize > size - BaseBlockSize
+				)
+			{
+				return false;
+			}
+			for (DWORD bin = 0; bin < binsSize; )
+			{
+				const BYTE *header = data + BaseBlockSize + bin;
+				const DWORD binSize = Get32(header + 8);
+				if (false
+					|| header[0] != 'h' || header[1] != 'b' || header[2] != 'i' || header[3] != 'n'
+					|| Get32(header + 4) != bin
+					|| binSize == 0 || binSize % BinAlignment != 0 || binSize > binsSize - bin
+					)
+				{
+					return false;
+				}
+				DWORD cell = bin + BinHeaderSize;
+				while (cell < bin + binSize)
+				{
+					const LONG cellSize = CellSize(cell);
+					const DWORD bytes = static_cast<DWORD>((cellSize < 0) ? -cellSize : cellSize);
+					if (bytes < 8 || bytes % 8 != 0 || bytes > bin + binSize - cell)
+					{
+						return false;
+					}
+					cell += bytes;
+				}
+				bin += binSize;
+			}
+			return true;
+		}
+
+		//! Write the hive to "file.new", and replace the file.
+		bool Save()
+		{
+			const DWORD sequence = Get32(data + PrimarySequenceField) + 1;
+			Set32(data + PrimarySequenceField, sequence);
+			Set32(data + SecondarySequenceField, sequence);
+			FILETIME now;
+			GetSystemTimeAsFileTime(&now);
+			Set32(data + TimestampField, now.dwLowDateTime);
+			Set32(data + TimestampField + 4, now.dwHighDateTime);
+			Set32(data + ChecksumField, Checksum());
+
+			WCHAR newPath[MAX_PATH];
+			lstrcpyW(newPath, path);
+			lstrcatW(newPath, L".new");
+			bool success = false;
+			HANDLE file = CreateFileW(newPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				const DWORD size = BaseBlockSize + binsSize;
+				DWORD bytesWritten = 0;
+				success = WriteFile(file, data, size, &bytesWritten, NULL) && bytesWritten == size;
+				CloseHandle(file);
+				success = success && MoveFileExW(newPath, path, MOVEFILE_REPLACE_EXISTING) != FALSE;
+				if (!success)
+				{
+					DeleteFileW(newPath);
+				}
+			}
+			return success;
+		}
+
+		//! Fold a name char for comparison, as the registry compares names ignoring case.
+		static WCHAR Fold(WCHAR oneChar)
+		{
+			if (oneChar < 0x80)
+			{
+				return (L'a' <= oneChar && oneChar <= L'z') ? static_cast<WCHAR>(oneChar - (L'a' - L'A')) : oneChar;
+			}
+			const ULONG_PTR charCode = static_cast<ULONG_PTR>(oneChar);
+			return static_cast<WCHAR>(reinterpret_cast<ULONG_PTR>(CharUpperW(reinterpret_cast<LPWSTR>(charCode))));
+		}
+
+		//! Compare a name stored in a cell with name, ignoring case.
+		/*!
+			@param stored name bytes: 8 bit chars if compressed, or UTF-16LE.
+		 */
+		static bool NameEquals(const BYTE *stored, DWORD storedBytes, bool compressed, LPCWSTR name, size_t nameLen)
+		{
+			if (storedBytes != (compressed ? nameLen : nameLen * 2))
+			{
+				return false;
+			}
+			for (size_t index = 0; index < nameLen; index++)
+			{
+				const WCHAR oneChar = compressed ? static_cast<WCHAR>(stored[index]) : static_cast<WCHAR>(Get16(stored + 2 * index));
+				if (Fold(oneChar) != Fold(name[index]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//! Find subkey by name in a subkey list: "lf", "lh", "li", or "ri" of them.
+		DWORD FindInList(DWORD list, LPCWSTR name, size_t nameLen, bool nested) const
+		{
+			const BYTE *body = Body(list, 4);
+			if (body == nullptr)
+			{
+				return NoCell;
+			}
+			const bool hashed = IsSignature(body, "lf") || IsSignature(body, "lh");
+			const bool index = IsSignature(body, "ri");
+			if (!hashed && !index && !IsSignature(body, "li"))
+			{
+				return NoCell;
+			}
+			const DWORD count = Get16(body + 2);
+			const DWORD stride = hashed ? 8 : 4;
+			if ((index && nested) || Body(list, 4 + count * stride) == nullptr)
+			{
+				return NoCell;
+			}
+			for (DWORD entry = 0; entry < count; entry++)
+			{
+				const DWORD child = Get32(body + 4 + entry * stride);
+				if (index)
+				{
+					const DWORD found = FindInList(child, name, nameLen, true);
+					if (found != NoCell)
+					{
+						return found;
+					}
+					continue;
+				}
+				const BYTE *key = Body(child, NkNameField);
+				if (true
+					&& key != nullptr
+					&& IsSignature(key, "nk")
+					&& Body(child, NkNameField + Get16(key + NkNameLengthField)) != nullptr
+					&& NameEquals(key + NkNameField, Get16(key + NkNameLengthField), (Get16(key + 2) & NkCompressedName) != 0, name, nameLen)
+					)
+				{
+					return child;
+				}
+			}
+			return NoCell;
+		}
+
+		//! Find key by path of names separated by '\\', from key.
+		DWORD FindKey(DWORD key, LPCWSTR keyPath) const
+		{
+			while (key != NoCell && *keyPath != 0)
+			{
+				const BYTE *body = Body(key, NkNameField);
+				if (body == nullptr || !IsSignature(body, "nk"))
+				{
+					return NoCell;
+				}
+				size_t nameLen = 0;
+				while (keyPath[nameLen] != 0 && keyPath[nameLen] != L'\\')
+				{
+					nameLen++;
+				}
+				key = (Get32(body + NkSubkeyCountField) == 0) ? NoCell : FindInList(Get32(body + NkSubkeyListField), keyPath, nameLen, false);
+				keyPath += nameLen + ((keyPath[nameLen] == L'\\') ? 1 : 0);
+			}
+			return (Body(key, NkNameField) != nullptr && IsSignature(Body(key, NkNameField), "nk")) ? key : NoCell;
+		}
+
+		//! Find value of the environment key by name.
+		/*!
+			@param index receives its position in the value list.
+		 */
+		DWORD FindValue(LPCWSTR name, DWORD &index) const
+		{
+			return FindValueOf(keyCell, name, index);
+		}
+
+		//! Find value of key by name.
+		DWORD FindValueOf(DWORD key, LPCWSTR name, DWORD &index) const
+		{
+			const BYTE *body = Body(key, NkNameField);
+			if (body == nullptr)
+			{
+				return NoCell;
+			}
+			const DWORD count = Get32(body + NkValueCountField);
+			const BYTE *list = (count == 0) ? nullptr : Body(Get32(body + NkValueListField), count * 4);
+			const size_t nameLen = lstrlenW(name);
+			for (index = 0; list != nullptr && index < count; index++)
+			{
+				const DWORD value = Get32(list + 4 * index);
+				const BYTE *valueBody = Body(value, VkNameField);
+				if (true
+					&& valueBody != nullptr
+					&& IsSignature(valueBody, "vk")
+					&& Body(value, VkNameField + Get16(valueBody + VkNameLengthField)) != nullptr
+					&& NameEquals(valueBody + VkNameField, Get16(valueBody + VkNameLengthField), (Get16(valueBody + VkFlagsField) & VkCompressedName) != 0, name, nameLen)
+					)
+				{
+					return value;
+				}
+			}
+			return NoCell;
+		}
+
+		//! Read a REG_DWORD value of key.
+		bool ReadDword(DWORD key, LPCWSTR name, DWORD &result) const
+		{
+			DWORD index;
+			const DWORD value = FindValueOf(key, name, index);
+			if (value == NoCell || Get32(Body(value, VkNameField) + VkTypeField) != REG_DWORD)
+			{
+				return false;
+			}
+			DWORD bytes;
+			LPBYTE raw = ReadData(value, bytes);
+			const bool success = raw != nullptr && bytes == 4;
+			if (success)
+			{
+				result = Get32(raw);
+			}
+			if (raw != nullptr)
+			{
+				GlobalFree(raw);
+			}
+			return success;
+		}
+
+		//! Test if value data is stored as "db" big data.
+		bool IsBigData(DWORD bytes, DWORD cell) const
+		{
+			const BYTE *body = Body(cell, 8);
+			return bytes > BigDataSegment && Get32(data + MinorVersionField) >= 4 && body != nullptr && IsSignature(body, "db");
+		}
+
+		//! Read data of value to a GlobalAlloc block, to be freed by caller.
+		LPBYTE ReadData(DWORD value, DWORD &bytes) const
+		{
+			const BYTE *body = Body(value, VkNameField);
+			const DWORD size = Get32(body + VkDataSizeField);
+			const DWORD cell = Get32(body + VkDataField);
+			bytes = size & ~ResidentData;
+			LPBYTE out = (LPBYTE)GlobalAlloc(GMEM_FIXED, bytes + 1);
+			if (out == nullptr)
+			{
+				return nullptr;
+			}
+			bool success = true;
+			if ((size & ResidentData) != 0)
+			{
+				success = bytes <= 4;
+				for (DWORD index = 0; success && index < bytes; index++)
+				{
+					out[index] = body[VkDataField + index];
+				}
+			}
+			else if (IsBigData(bytes, cell))
+			{
+				const BYTE *bigData = Body(cell, 8);
+				const DWORD segments = Get16(bigData + 2);
+				const BYTE *list = Body(Get32(bigData + 4), segments * 4);
+				DWORD copied = 0;
+				success = list != nullptr;
+				for (DWORD segment = 0; success && segment < segments && copied < bytes; segment++)
+				{
+					const DWORD part = (bytes - copied < BigDataSegment) ? bytes - copied : BigDataSegment;
+					const BYTE *from = Body(Get32(list + 4 * segment), part);
+					success = from != nullptr;
+					for (DWORD index = 0; success && index < part; index++)
+					{
+						out[copied++] = from[index];
+					}
+				}
+				success = success && copied == bytes;
+			}
+			else if (bytes != 0)
+			{
+				const BYTE *from = Body(cell, bytes);
+				success = from != nullptr;
+				for (DWORD index = 0; success && index < bytes; index++)
+				{
+					out[index] = from[index];
+				}
+			}
+			if (!success)
+			{
+				GlobalFree(out);
+				return nullptr;
+			}
+			return out;
+		}
+
+		//! Free cells of value data, unless resident.
+		void FreeData(DWORD value)
+		{
+			const BYTE *body = Body(value, VkNameField);
+			const DWORD size = Get32(body + VkDataSizeField);
+			const DWORD cell = Get32(body + VkDataField);
+			const DWORD bytes = size & ~ResidentData;
+			if ((size & ResidentData) != 0 || bytes == 0)
+			{
+				return;
+			}
+			if (IsBigData(bytes, cell))
+			{
+				const BYTE *bigData = Body(cell, 8);
+				const DWORD segments = Get16(bigData + 2);
+				const DWORD list = Get32(bigData + 4);
+				const BYTE *listBody = Body(list, segments * 4);
+				for (DWORD segment = 0; listBody != nullptr && segment < segments; segment++)
+				{
+					Free(Get32(listBody + 4 * segment));
+				}
+				Free(list);
+			}
+			Free(cell);
+		}
+
+		//! Store data of value: in place if it fits the data cell, otherwise in new cells.
+		/*!
+			@return false if out of memory. The old data is kept then.
+		 */
+		bool WriteData(DWORD value, DWORD type, const BYTE *bytes, DWORD size)
+		{
+			const DWORD oldSize = Get32(Body(value, VkNameField) + VkDataSizeField);
+			const DWORD oldCell = Get32(Body(value, VkNameField) + VkDataField);
+			const bool bigData = size > BigDataSegment && Get32(data + MinorVersionField) >= 4;
+
+			DWORD cell;
+			if (size <= 4)
+			{
+				cell = 0;
+				for (DWORD index = 0; index < size; index++)
+				{
+					cell |= static_cast<DWORD>(bytes[index]) << (8 * index);
+				}
+				FreeData(value);
+				size |= ResidentData;
+			}
+			else if (true
+				&& !bigData
+				&& (oldSize & ResidentData) == 0
+				&& !IsBigData(oldSize, oldCell)
+				&& Body(oldCell, size) != nullptr
+				)
+			{
+				// rewritten in place
+				cell = oldCell;
+				Copy(Body(cell, size), bytes, size);
+			}
+			else if (!bigData)
+			{
+				cell = Allocate(size);
+				if (cell == NoCell)
+				{
+					return false;
+				}
+				Copy(Body(cell, size), bytes, size);
+				FreeData(value);
+			}
+			else
+			{
+				// "db": a list of segments
+				const DWORD segments = (size + BigDataSegment - 1) / BigDataSegment;
+				cell = Allocate(8);
+				const DWORD list = (cell == NoCell) ? NoCell : Allocate(segments * 4);
+				if (list == NoCell)
+				{
+					return false;
+				}
+				for (DWORD segment = 0; segment < segments; segment++)
+				{
+					const DWORD offset = segment * BigDataSegment;
+					const DWORD part = (size - offset < BigDataSegment) ? size - offset : BigDataSegment;
+					const DWORD segmentCell = Allocate(part);
+					if (segmentCell == NoCell)
+					{
+						return false;
+					}
+					Copy(Body(segmentCell, part), bytes + offset, part);
+					Set32(Body(list, segments * 4) + 4 * segment, segmentCell);
+				}
+				LPBYTE bigDataBody = Body(cell, 8);
+				bigDataBody[0] = 'd';
+				bigDataBody[1] = 'b';
+				Set16(bigDataBody + 2, segments);
+				Set32(bigDataBody + 4, list);
+				FreeData(value);
+			}
+			LPBYTE body = Body(value, VkNameField);
+			Set32(body + VkDataSizeField, size);
+			Set32(body + VkDataField, cell);
+			Set32(body + VkTypeField, type);
+			return true;
+		}
+
+		//! Add value of name, having no data, to the environment key.
+		DWORD AddValue(LPCWSTR name, DWORD nameLen)
+		{
+			bool compressed = true;
+			for (DWORD index = 0; index < nameLen; index++)
+			{
+				compressed = compressed && name[index] < 0x100;
+			}
+			const DWORD nameBytes = compressed ? nameLen : nameLen * 2;
+			const DWORD count = Get32(Body(keyCell, NkNameField) + NkValueCountField);
+			DWORD list = Get32(Body(keyCell, NkNameField) + NkValueListField);
+			if (count != 0 && Body(list, count * 4) == nullptr)
+			{
+				return NoCell;
+			}
+			const DWORD value = Allocate(VkNameField + nameBytes);
+			if (value == NoCell)
+			{
+				return NoCell;
+			}
+			LPBYTE body = Body(value, VkNameField + nameBytes);
+			body[0] = 'v';
+			body[1] = 'k';
+			Set16(body + VkNameLengthField, nameBytes);
+			Set32(body + VkDataSizeField, ResidentData);
+			Set32(body + VkDataField, 0);
+			Set32(body + VkTypeField, REG_NONE);
+			Set16(body + VkFlagsField, compressed ? VkCompressedName : 0);
+			for (DWORD index = 0; index < nameLen; index++)
+			{
+				if (compressed)
+				{
+					body[VkNameField + index] = static_cast<BYTE>(name[index]);
+				}
+				else
+				{
+					Set16(body + VkNameField + 2 * index, name[index]);
+				}
+			}
+
+			// the list is replaced by a larger one only when full
+			if (count == 0 || Capacity(list) < (count + 1) * 4)
+			{
+				const DWORD newList = Allocate((count + 1) * 4);
+				if (newList == NoCell)
+				{
+					Free(value);
+					return NoCell;
+				}
+				if (count != 0)
+				{
+					Copy(Body(newList, count * 4), Body(list, count * 4), count * 4);
+					Free(list);
+				}
+				list = newList;
+				Set32(Body(keyCell, NkNameField) + NkValueListField, list);
+			}
+			Set32(Body(list, (count + 1) * 4) + 4 * count, value);
+			Set32(Body(keyCell, NkNameField) + NkValueCountField, count + 1);
+			return value;
+		}
+
+		//! Remove value at index of the value list, and free its cells.
+		void DeleteValue(DWORD value, DWORD index)
+		{
+			FreeData(value);
+			Free(value);
+			LPBYTE key = Body(keyCell, NkNameField);
+			const DWORD count = Get32(key + NkValueCountField);
+			const DWORD list = Get32(key + NkValueListField);
+			LPBYTE listBody = Body(list, count * 4);
+			for (DWORD next = index + 1; next < count; next++)
+			{
+				Set32(listBody + 4 * (next - 1), Get32(listBody + 4 * next));
+			}
+			Set32(key + NkValueCountField, count - 1);
+			if (count == 1)
+			{
+				Free(list);
+				Set32(key + NkValueListField, NoCell);
+			}
+		}
+
+		//! Update the environment key: its timestamp, and its largest value name and data.
+		void Touch(DWORD nameLen, DWORD bytes)
+		{
+			LPBYTE key = Body(keyCell, NkNameField);
+			FILETIME now;
+			GetSystemTimeAsFileTime(&now);
+			Set32(key + NkTimestampField, now.dwLowDateTime);
+			Set32(key + NkTimestampField + 4, now.dwHighDateTime);
+			if (Get32(key + NkMaxValueNameField) < nameLen * 2)
+			{
+				Set32(key + NkMaxValueNameField, nameLen * 2);
+			}
+			if (Get32(key + NkMaxValueDataField) < bytes)
+			{
+				Set32(key + NkMaxValueDataField, bytes);
+			}
+		}
+
+		//! Copy bytes.
+		static void Copy(LPBYTE to, const BYTE *from, DWORD bytes)
+		{
+			for (DWORD index = 0; index < bytes; index++)
+			{
+				to[index] = from[index];
+			}
+		}
+
+		//! End of the bin holding cell.
+		DWORD BinEnd(DWORD cell) const
+		{
+			DWORD bin = 0;
+			while (bin + Get32(data + BaseBlockSize + bin + 8) <= cell)
+			{
+				bin += Get32(data + BaseBlockSize + bin + 8);
+			}
+			return bin + Get32(data + BaseBlockSize + bin + 8);
+		}
+
+		//! Allocate a zero filled cell having a body of bytes: the first free cell large enough, or a new bin.
+		DWORD Allocate(DWORD bytes)
+		{
+			const DWORD cellSize = Align(bytes + 4, 8);
+			for (DWORD bin = 0; bin < binsSize; bin += Get32(data + BaseBlockSize + bin + 8))
+			{
+				const DWORD binEnd = bin + Get32(data + BaseBlockSize + bin + 8);
+				for (DWORD cell = bin + BinHeaderSize; cell < binEnd; )
+				{
+					const LONG size = CellSize(cell);
+					if (size > 0 && static_cast<DWORD>(size) >= cellSize)
+					{
+						Take(cell, size, cellSize);
+						return cell;
+					}
+					cell += static_cast<DWORD>((size < 0) ? -size : size);
+				}
+			}
+			const DWORD bin = AppendBin(cellSize);
+			if (bin == NoCell)
+			{
+				return NoCell;
+			}
+			Take(bin + BinHeaderSize, CellSize(bin + BinHeaderSize), cellSize);
+			return bin + BinHeaderSize;
+		}
+
+		//! Allocate cellSize bytes at the start of a free cell of size, leaving the rest free.
+		void Take(DWORD cell, DWORD size, DWORD cellSize)
+		{
+			if (size - cellSize >= 8)
+			{
+				Set32(data + BaseBlockSize + cell + cellSize, size - cellSize);
+			}
+			else
+			{
+				cellSize = size;
+			}
+			Set32(data + BaseBlockSize + cell, static_cast<DWORD>(-static_cast<LONG>(cellSize)));
+			LPBYTE body = data + BaseBlockSize + cell + 4;
+			for (DWORD index = 0; index < cellSize - 4; index++)
+			{
+				body[index] = 0;
+			}
+		}
+
+		//! Mark cell free, merged with free cells following it in the same bin.
+		void Free(DWORD cell)
+		{
+			if (Body(cell, 0) == nullptr)
+			{
+				return;
+			}
+			DWORD size = static_cast<DWORD>(-CellSize(cell));
+			const DWORD binEnd = BinEnd(cell);
+			while (cell + size < binEnd && CellSize(cell + size) > 0)
+			{
+				size += static_cast<DWORD>(CellSize(cell + size));
+			}
+			Set32(data + BaseBlockSize + cell, size);
+		}
+
+		//! Add a bin having one free cell of cellSize at least, at the end of the hive.
+		/*!
+			@return offset of the bin, or NoCell if out of memory.
+		 */
+		DWORD AppendBin(DWORD cellSize)
+		{
+			const DWORD binSize = Align(BinHeaderSize + cellSize, BinAlignment);
+			const DWORD size = BaseBlockSize + binsSize + binSize;
+			if (size > capacity)
+			{
+				// room for a few more bins, without copying the hive again
+				const DWORD newCapacity = size + 16 * BinAlignment;
+				LPBYTE newData = (LPBYTE)GlobalAlloc(GMEM_FIXED, newCapacity);
+				if (newData == nullptr)
+				{
+					return NoCell;
+				}
+				Copy(newData, data, BaseBlockSize + binsSize);
+				GlobalFree(data);
+				data = newData;
+				capacity = newCapacity;
+			}
+			const DWORD bin = binsSize;
+			LPBYTE header = data + BaseBlockSize + bin;
+			for (DWORD index = 0; index < BinHeaderSize; index++)
+			{
+				header[index] = 0;
+			}
+			header[0] = 'h';
+			header[1] = 'b';
+			header[2] = 'i';
+			header[3] = 'n';
+			Set32(header + 4, bin);
+			Set32(header + 8, binSize);
+			FILETIME now;
+			GetSystemTimeAsFileTime(&now);
+			Set32(header + 20, now.dwLowDateTime);
+			Set32(header + 24, now.dwHighDateTime);
+			Set32(header + BinHeaderSize, binSize - BinHeaderSize);
+			binsSize += binSize;
+			Set32(data + BinsSizeField, binsSize);
+			return bin;
+		}
+
+		//! hive file in memory, or nullptr
+		LPBYTE data;
+
+		//! bytes allocated for data
+		DWORD capacity;
+
+		//! bytes of all bins, following the base block
+		DWORD binsSize;
+
+		//! environment key cell
+		DWORD keyCell;
+
+		//! a value is written since Open
+		bool written;
+
+		//! a write failed half way: not saved
+		bool damaged;
+
+		//! hive file
+		WCHAR path[MAX_PATH];
+	};
+
+	//! getter of offline hive
+	bool GetOfflineRegValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		return static_cast<OfflineHive *>(context)->Get(EnvVarName, ResultVar, ValueType);
+	}
+
+	//! setter of offline hive
+	bool SetOfflineRegValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		return static_cast<OfflineHive *>(context)->Set(EnvVarName, NewValue, ValueType);
+	}
+
+	//! Store of an open offline hive
+	EnvStore OfflineHiveStore(OfflineHive *hive)
+	{
+		return EnvStore(GetOfflineRegValue, SetOfflineRegValue, hive);
+	}
+
+	//! Store writes to an offline hive, which running programs do not see.
+	bool IsOfflineStore(const EnvStore &store)
+	{
+		return store.getter == GetOfflineRegValue;
+	}
+}
@@ -0,0 +1,221 @@
+//! @file PathEdit.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "StrBuilder.h"
+#include "GrowString.h"
+#include "PathIndex.h"
+#include "PathNormalizer.h"
+#include "PerThread.h"
+
+namespace Utils
+{
+	//! "A": remove your path, and append it.
+	struct AppendAction
+	{
+		static const bool Prepend = false;
+		static const bool Append = true;
+		static const bool Dedupe = false;
+		static const bool DropEmpty = false;
+		static const bool DropMissing = false;
+	};
+
+	//! "P": prepend your path, and remove the others.
+	struct PrependAction
+	{
+		static const bool Prepend = true;
+		static const bool Append = false;
+		static const bool Dedupe = false;
+		static const bool DropEmpty = false;
+		static const bool DropMissing = false;
+	};
+
+	//! "R": remove your path.
+	struct RemoveAction
+	{
+		static const bool Prepend = false;
+		static const bool Append = false;
+		static const bool Dedupe = false;
+		static const bool DropEmpty = false;
+		static const bool DropMissing = false;
+	};
+
+	//! "D": remove repeated paths, keeping the first one. Your path is not used.
+	struct DedupeAction
+	{
+		static const bool Prepend = false;
+		static const bool Append = false;
+		static const bool Dedupe = true;
+		static const bool DropEmpty = false;
+		static const bool DropMissing = false;
+	};
+
+	//! "C": remove empty and repeated paths. Your path is not used.
+	struct CompactAction
+	{
+		static const bool Prepend = false;
+		static const bool Append = false;
+		static const bool Dedupe = true;
+		static const bool DropEmpty = true;
+		static const bool DropMissing = false;
+	};
+
+	//! "C" with "/MISSING": remove empty and repeated paths, and directories that do not exist.
+	struct CompactMissingAction
+	{
+		static const bool Prepend = false;
+		static const bool Append = false;
+		static const bool Dedupe = true;
+		static const bool DropEmpty = true;
+		static const bool DropMissing = true;
+	};
+
+	//! Entries scanned and removed by the kernels
+	struct EditCounters
+	{
+		//! entries removed
+		size_t entriesRemoved;
+
+		//! bytes of removed entries, including one separator each
+		size_t bytesRemoved;
+
+		//! entries scanned by EditPath and FindPath
+		size_t entriesScanned;
+	};
+
+	//! counters of this DLL instance
+	UTILS_PER_THREAD EditCounters g_editCounters;
+
+	//! Test if key of an entry is your path, or one of the list of them.
+	bool IsYours(const StrSpan &key, const StrSpan &yourKey, bool isList, const PathIndex &yourKeys)
+	{
+		return isList ? yourKeys.Contains(key) : key.EqualsIgnoreCase(yourKey);
+	}
+
+	//! Edit kernel, specialized for each action and matcher at compile time.
+	/*!
+		@param value current value, a list separated by ';'.
+		@param yourPath path to add or remove, or a list of them separated by ';'.
+		@param NewPathStr receives the result.
+		@param matcher ExactMatch, or PathNormalizer. Entries are compared by matcher.Key, ignoring case.
+		Directories are tested by matcher.Exists, once per distinct entry.
+		@remarks Tokens are scanned once. Not taken branches are removed by the compiler.
+		A list of your paths is matched by a hashed set of keys, and is added once each, in the given order.
+	 */
+	template <class Action, class Matcher>
+	bool EditPath(const StrSpan &value, const StrSpan &yourPath, FixedLenStr &NewPathStr, Matcher &matcher)
+	{
+		StrBuilder NewPath(NewPathStr);
+		bool success = true;
+
+		if (NewPathStr.growable)
+		{
+			// the result is not longer than this
+			success &= NewPathStr.Reserve(value.len + 1 + yourPath.len + 1);
+		}
+
+		// a list of your paths: keys in yourKeys, and distinct entries in yourList
+		const bool isList = !Action::Dedupe && FindChar(yourPath.ptr, yourPath.len, _T(';')) != yourPath.len;
+		const StrSpan yourKey = isList ? yourPath : matcher.Key(yourPath);
+		PathIndex yourKeys;
+		GrowString yourListStr(isList ? yourPath.len + 1 : 0);
+		StrSpan yourList = yourPath;
+		if (isList)
+		{
+			success &= yourKeys.Reserve(PathIndex::CountTokens(yourPath, _T(';')));
+			StrBuilder yourListBuilder(yourListStr);
+			StrTokenizer yourTokens(yourPath, _T(';'));
+			StrSpan yourOne;
+			while (yourTokens.Next(yourOne))
+			{
+				if (yourOne.len != 0 && yourKeys.Insert(matcher.Key(yourOne)))
+				{
+					success &= yourListBuilder.AppendSeparated(_T(';'), yourOne);
+				}
+			}
+			yourList.ptr = yourListStr.msgbuf;
+			yourList.len = yourListBuilder.Length();
+		}
+
+		PathIndex seen;
+		if (Action::Dedupe)
+		{
+			success &= seen.Reserve(PathIndex::CountTokens(value, _T(';')));
+		}
+
+		if (Action::Prepend)
+		{
+			// at first prepend your path
+			success &= NewPath.Append(yourList);
+		}
+
+		// filter out your path, or repeated paths, from registry
+		StrTokenizer tokens(value, _T(';'));
+		StrSpan onePath;
+		while (tokens.Next(onePath))
+		{
+			g_editCounters.entriesScanned++;
+			const bool keep = true
+				&& !(Action::DropEmpty && onePath.len == 0)
+				&& (Action::Dedupe ? seen.Insert(matcher.Key(onePath)) : !IsYours(matcher.Key(onePath), yourKey, isList, yourKeys))
+				&& !(Action::DropMissing && !matcher.Exists(onePath))
+				;
+			if (keep)
+			{
+				success &= NewPath.AppendSeparated(_T(';'), onePath);
+			}
+			else
+			{
+				g_editCounters.entriesRemoved++;
+				g_editCounters.bytesRemoved += (onePath.len + 1) * sizeof(TCHAR);
+			}
+		}
+
+		if (Action::Append)
+		{
+			// now append your path
+			success &= NewPath.AppendSeparated(_T(';'), yourList);
+		}
+
+		return success;
+	}
+
+	//! FindPath result when no entry matches
+	const size_t PathNotFound = static_cast<size_t>(-1);
+
+	//! Query kernel: find your path in value. Nothing is built, or written.
+	/*!
+		@param value current value, a list separated by ';'.
+		@param yourPath path to find.
+		@param matcher ExactMatch, or PathNormalizer. Entries are compared by matcher.Key, ignoring case.
+		@param count receives the number of entries matching your path.
+		@return index of the first matching entry, from 0, or PathNotFound.
+	 */
+	template <class Matcher>
+	size_t FindPath(const StrSpan &value, const StrSpan &yourPath, Matcher &matcher, size_t &count)
+	{
+		const StrSpan yourKey = matcher.Key(yourPath);
+
+		size_t first = PathNotFound;
+		size_t index = 0;
+		count = 0;
+
+		StrTokenizer tokens(value, _T(';'));
+		StrSpan onePath;
+		for (; tokens.Next(onePath); index++)
+		{
+			g_editCounters.entriesScanned++;
+			if (matcher.Key(onePath).EqualsIgnoreCase(yourKey))
+			{
+				if (count == 0)
+				{
+					first = index;
+				}
+				count++;
+			}
+		}
+		return first;
+	}
+}
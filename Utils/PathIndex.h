@@ -0,0 +1,178 @@
+//! @file PathIndex.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "StrSpan.h"
+#include "Arena.h"
+
+namespace Utils
+{
+	//! Hash set of path entries, compared by StrSpan::EqualsIgnoreCase (without CRT)
+	/*!
+		@remarks
+		Open addressing over a table from Arena::current, or GlobalAlloc.
+		Entries are views into the caller's string, so it must outlive the index.
+		The table grows when half full.
+	 */
+	class PathIndex
+	{
+	public:
+		//! ctor
+		PathIndex() : slots(nullptr), mask(0), count(0), arena(Arena::current)
+		{
+
+		}
+
+		//! ctor with arena to allocate table from, or nullptr for GlobalAlloc
+		explicit PathIndex(Arena *arena) : slots(nullptr), mask(0), count(0), arena(arena)
+		{
+
+		}
+
+		//! dtor
+		~PathIndex()
+		{
+			if (slots != nullptr && arena == nullptr)
+			{
+				GlobalFree(slots);
+			}
+		}
+
+		//! Allocate room for entryCount entries, dropping current entries.
+		bool Reserve(size_t entryCount)
+		{
+			if (slots != nullptr && arena == nullptr)
+			{
+				GlobalFree(slots);
+			}
+			slots = AllocateTable(entryCount);
+			count = 0;
+			return slots != nullptr;
+		}
+
+		//! Add entry.
+		/*!
+			@return true if added, false if an equal entry already exists or out of memory.
+		 */
+		bool Insert(const StrSpan &entry)
+		{
+			if ((slots == nullptr || mask < count * 2) && !Grow())
+			{
+				return false;
+			}
+			const DWORD hash = entry.FoldedHash();
+			Slot *slot = Probe(entry, hash);
+			if (slot->used)
+			{
+				return false;
+			}
+			slot->used = true;
+			slot->hash = hash;
+			slot->entry = entry;
+			count++;
+			return true;
+		}
+
+		//! Test entry.
+		bool Contains(const StrSpan &entry) const
+		{
+			return slots != nullptr && Probe(entry, entry.FoldedHash())->used;
+		}
+
+		//! Number of entries.
+		size_t Count() const
+		{
+			return count;
+		}
+
+		//! Count tokens of text, for Reserve.
+		static size_t CountTokens(const StrSpan &text, TCHAR delim)
+		{
+			size_t tokens = 1;
+			for (size_t index = FindChar(text.ptr, text.len, delim); index < text.len; index = index + 1 + FindChar(text.ptr + index + 1, text.len - index - 1, delim))
+			{
+				tokens++;
+			}
+			return tokens;
+		}
+
+	private:
+		//! one table slot
+		struct Slot
+		{
+			StrSpan entry;
+			DWORD hash;
+			bool used;
+		};
+
+		//! Allocate zeroed table for entryCount entries, and set mask.
+		Slot *AllocateTable(size_t entryCount)
+		{
+			size_t capacity = 16;
+			while (capacity < entryCount * 2)
+			{
+				capacity *= 2;
+			}
+			const size_t bytes = capacity * sizeof(Slot);
+			Slot *table = (Slot *)((arena != nullptr) ? arena->Allocate(bytes, true) : GlobalAlloc(GPTR, bytes));
+			mask = (table == nullptr) ? 0 : capacity - 1;
+			return table;
+		}
+
+		//! Double the table, keeping entries.
+		bool Grow()
+		{
+			Slot *oldSlots = slots;
+			const size_t oldCapacity = (oldSlots == nullptr) ? 0 : mask + 1;
+			const size_t oldMask = mask;
+			slots = AllocateTable(oldCapacity);
+			if (slots == nullptr)
+			{
+				slots = oldSlots;
+				mask = oldMask;
+				return false;
+			}
+			for (size_t index = 0; index < oldCapacity; index++)
+			{
+				if (oldSlots[index].used)
+				{
+					*Probe(oldSlots[index].entry, oldSlots[index].hash) = oldSlots[index];
+				}
+			}
+			if (oldSlots != nullptr && arena == nullptr)
+			{
+				GlobalFree(oldSlots);
+			}
+			return true;
+		}
+
+		//! Find the slot of entry, or the empty slot where it would be.
+		Slot *Probe(const StrSpan &entry, DWORD hash) const
+		{
+			size_t index = hash & mask;
+			while (true)
+			{
+				Slot *slot = slots + index;
+				if (!slot->used || (slot->hash == hash && slot->entry.EqualsIgnoreCase(entry)))
+				{
+					return slot;
+				}
+				index = (index + 1) & mask;
+			}
+		}
+
+		//! table
+		Slot *slots;
+
+		//! table size - 1
+		size_t mask;
+
+		//! used slots
+		size_t count;
+
+		//! arena owning slots, or nullptr if slots is from GlobalAlloc
+		Arena *arena;
+	};
+}
@@ -0,0 +1,317 @@
+//! @file PathNormalizer.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "StrSpan.h"
+#include "Arena.h"
+#include "PathIndex.h"
+
+namespace Utils
+{
+	//! How path entries are matched.
+	enum NormalizeMode
+	{
+		//! as is, ignoring case
+		NormalizeNone,
+		//! '/' is '\\', and trailing '\\' is ignored
+		NormalizePath,
+		//! NormalizePath, after %VAR% is expanded
+		NormalizeExpand,
+	};
+
+	//! Variable source prototype, same as GetEnvironmentVariable.
+	/*!
+		@return length without null if copied, required size with null if size is short, or 0 if not defined.
+	 */
+	typedef DWORD(*GetVariableProc)(void *context, LPCTSTR name, LPTSTR buffer, DWORD size);
+
+	//! Variable source of this process.
+	DWORD GetProcessVariable(void *context, LPCTSTR name, LPTSTR buffer, DWORD size)
+	{
+		return GetEnvironmentVariable(name, buffer, size);
+	}
+
+	//! Matcher of EditPath, comparing entries as is.
+	struct ExactMatch
+	{
+		//! Key to compare entry by.
+		StrSpan Key(const StrSpan &entry)
+		{
+			return entry;
+		}
+
+		//! Not tested: EditPathMatching uses PathNormalizer to drop missing directories.
+		bool Exists(const StrSpan &entry)
+		{
+			return true;
+		}
+	};
+
+	//! Matcher of EditPath, comparing entries by normalized key.
+	/*!
+		@remarks
+		Keys are used only to match: the entries are written as is.
+		Each %VAR% is resolved once, and remembered until this is destroyed.
+		An entry having nothing to normalize is its own key, and nothing is copied.
+		Existence of directories is remembered in the same way.
+	 */
+	class PathNormalizer
+	{
+	public:
+		//! normalization
+		NormalizeMode mode;
+
+		//! variable source
+		GetVariableProc getVariable;
+
+		//! context passed to getVariable
+		void *context;
+
+		//! variables resolved by getVariable
+		size_t resolves;
+
+		//! directories tested by GetFileAttributes
+		size_t probes;
+
+		//! ctor
+		PathNormalizer(NormalizeMode mode = NormalizeNone) : mode(mode), getVariable(GetProcessVariable), context(nullptr), resolves(0), probes(0), variables(nullptr), existing(&arena), missing(&arena)
+		{
+			ZeroFill(&arena, sizeof(arena));
+		}
+
+		//! dtor
+		~PathNormalizer()
+		{
+			arena.Release();
+		}
+
+		//! Key to compare entry by: entry itself with NormalizeNone.
+		StrSpan Key(const StrSpan &entry)
+		{
+			if (mode == NormalizeNone)
+			{
+				return entry;
+			}
+			return MakeKey(entry, mode == NormalizeExpand);
+		}
+
+		//! Test if entry is an existing directory, once per distinct entry.
+		/*!
+			@remarks %VAR% is expanded regardless of mode, only to test and remember the directory.
+			An entry having undefined %VAR% is assumed to exist.
+		 */
+		bool Exists(const StrSpan &entry)
+		{
+			const StrSpan key = MakeKey(entry, true);
+			if (existing.Contains(key))
+			{
+				return true;
+			}
+			if (missing.Contains(key))
+			{
+				return false;
+			}
+			bool exists = true;
+			if (key.len != 0 && FindChar(key.ptr, key.len, _T('%')) == key.len)
+			{
+				LPTSTR path = static_cast<LPTSTR>(arena.Allocate((key.len + 1) * sizeof(TCHAR)));
+				if (path != nullptr)
+				{
+					probes++;
+					for (size_t index = 0; index < key.len; index++)
+					{
+						path[index] = key.ptr[index];
+					}
+					path[key.len] = 0;
+					const DWORD attributes = GetFileAttributes(path);
+					exists = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+				}
+			}
+			(exists ? existing : missing).Insert(key);
+			return exists;
+		}
+
+	private:
+		//! Build key of entry, or entry itself if nothing to normalize.
+		StrSpan MakeKey(const StrSpan &entry, bool expand)
+		{
+			bool needed = EndsWithSeparator(entry);
+			for (size_t index = 0; !needed && index < entry.len; index++)
+			{
+				needed = (entry.ptr[index] == _T('/')) || (expand && entry.ptr[index] == _T('%'));
+			}
+			if (!needed)
+			{
+				return entry;
+			}
+
+			const size_t len = Build(entry, expand, nullptr);
+			LPTSTR text = static_cast<LPTSTR>(arena.Allocate((len + 1) * sizeof(TCHAR)));
+			if (text == nullptr)
+			{
+				return entry;
+			}
+			Build(entry, expand, text);
+
+			StrSpan key = { text, len };
+			while (EndsWithSeparator(key) && !IsRoot(key))
+			{
+				key.len--;
+			}
+			return key;
+		}
+
+		//! A remembered variable.
+		struct Variable
+		{
+			//! next variable
+			Variable *next;
+
+			//! name, without '%'
+			StrSpan name;
+
+			//! value, valid if defined
+			StrSpan value;
+
+			//! false if getVariable does not know it
+			bool defined;
+		};
+
+		//! Write key of entry to text, or only count it if text is nullptr.
+		/*!
+			@return key length in TCHAR count.
+		 */
+		size_t Build(const StrSpan &entry, bool expand, LPTSTR text)
+		{
+			size_t len = 0;
+			size_t index = 0;
+			while (index < entry.len)
+			{
+				if (expand && entry.ptr[index] == _T('%'))
+				{
+					const size_t nameLen = FindChar(entry.ptr + index + 1, entry.len - index - 1, _T('%'));
+					const StrSpan name = { entry.ptr + index + 1, nameLen };
+					const Variable *variable = (nameLen != 0 && index + 1 + nameLen < entry.len) ? Lookup(name) : nullptr;
+					if (variable != nullptr && variable->defined)
+					{
+						len += Copy(variable->value, (text == nullptr) ? nullptr : text + len);
+						index += nameLen + 2;
+						continue;
+					}
+				}
+				const StrSpan one = { entry.ptr + index, 1 };
+				len += Copy(one, (text == nullptr) ? nullptr : text + len);
+				index++;
+			}
+			if (text != nullptr)
+			{
+				text[len] = 0;
+			}
+			return len;
+		}
+
+		//! Copy chars, '/' as '\\'.
+		static size_t Copy(const StrSpan &from, LPTSTR text)
+		{
+			if (text != nullptr)
+			{
+				for (size_t index = 0; index < from.len; index++)
+				{
+					text[index] = (from.ptr[index] == _T('/')) ? _T('\\') : from.ptr[index];
+				}
+			}
+			return from.len;
+		}
+
+		//! Resolve variable once.
+		const Variable *Lookup(const StrSpan &name)
+		{
+			for (Variable *variable = variables; variable != nullptr; variable = variable->next)
+			{
+				if (variable->name.EqualsIgnoreCase(name))
+				{
+					return variable;
+				}
+			}
+
+			Variable *variable = static_cast<Variable *>(arena.Allocate(sizeof(Variable) + (name.len + 1) * sizeof(TCHAR), true));
+			if (variable == nullptr)
+			{
+				return nullptr;
+			}
+			LPTSTR nameText = reinterpret_cast<LPTSTR>(variable + 1);
+			Copy(name, nameText);
+			nameText[name.len] = 0;
+			variable->name.ptr = nameText;
+			variable->name.len = name.len;
+
+			resolves++;
+			TCHAR probe[1];
+			DWORD size = getVariable(context, nameText, probe, 1);
+			while (size != 0)
+			{
+				LPTSTR valueText = static_cast<LPTSTR>(arena.Allocate(size * sizeof(TCHAR)));
+				if (valueText == nullptr)
+				{
+					break;
+				}
+				const DWORD copied = getVariable(context, nameText, valueText, size);
+				if (copied < size)
+				{
+					variable->value.ptr = valueText;
+					variable->value.len = copied;
+					variable->defined = true;
+					break;
+				}
+				// grown in between
+				size = copied;
+			}
+
+			variable->next = variables;
+			variables = variable;
+			return variable;
+		}
+
+		//! Last char is '\\' or '/'. ANSI: a trail byte of double byte char is not.
+		static bool EndsWithSeparator(const StrSpan &entry)
+		{
+			if (entry.len == 0)
+			{
+				return false;
+			}
+#ifndef UNICODE
+			size_t last = 0;
+			for (size_t index = 0; index < entry.len; index += IsDBCSLeadByte(static_cast<BYTE>(entry.ptr[index])) ? 2 : 1)
+			{
+				last = index;
+			}
+			if (last != entry.len - 1)
+			{
+				return false;
+			}
+#endif
+			const TCHAR lastChar = entry.ptr[entry.len - 1];
+			return lastChar == _T('\\') || lastChar == _T('/');
+		}
+
+		//! "\\" or "C:\\", whose separator is meaningful.
+		static bool IsRoot(const StrSpan &key)
+		{
+			return key.len == 1 || (key.len == 3 && key.ptr[1] == _T(':'));
+		}
+
+		//! keys, variables and tables of existing and missing
+		Arena arena;
+
+		//! remembered variables
+		Variable *variables;
+
+		//! entries tested to exist, by expanded key
+		PathIndex existing;
+
+		//! entries tested not to exist, by expanded key
+		PathIndex missing;
+	};
+}
@@ -0,0 +1,15 @@
+//! @file PerThread.h
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#ifndef UTILS_PER_THREAD
+//! Storage of the globals updated by edits: Arena::current, g_stats and g_editCounters.
+/*!
+	@remarks
+	The plugin runs on the installer thread only, and keeps them as plain globals.
+	A host tool running edits on worker threads defines this as thread_local before including Utils.
+ */
+#define UTILS_PER_THREAD
+#endif
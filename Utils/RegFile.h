@@ -0,0 +1,466 @@
+//! @file RegFile.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "EnvStore.h"
+#include "RegText.h"
+#include "WideText.h"
+
+namespace Utils
+{
+	//! Environment key of a .reg file exported by regedit, edited as a store.
+	/*!
+		@remarks
+		"Windows Registry Editor Version 5.00" files are UTF-16LE, and REGEDIT4 files are ANSI.
+		REG_SZ is read from "name"="text", and REG_EXPAND_SZ from "name"=hex(2):.. in the encoding of the file.
+		The file is edited in memory: only the entry of a written value is rewritten, and the others are kept as they are.
+		The lines of the environment key are found once, and kept track of through writes.
+		A write moves only the text after the entry, in a buffer having room to grow.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	class RegFile
+	{
+	public:
+		//! Read .reg file.
+		/*!
+			@param filePath .reg file exported from HKCU or HKLM.
+			@param system true to edit "HKEY_LOCAL_MACHINE\...\Session Manager\Environment", false for "HKEY_CURRENT_USER\Environment".
+			@return false if already open, or the file is not read.
+		 */
+		bool Open(LPCTSTR filePath, bool system)
+		{
+			if (IsOpen())
+			{
+				return false;
+			}
+			WideText widePath(filePath);
+			if (widePath.text == nullptr || lstrlenW(widePath.text) >= MAX_PATH - 4)
+			{
+				return false;
+			}
+			lstrcpyW(path, widePath.text);
+			keyName = system ? HklmEnvironmentKey : HkcuEnvironmentKey;
+			keyScanned = false;
+
+			HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			const DWORD size = GetFileSize(file, NULL);
+			LPBYTE bytes = (size == INVALID_FILE_SIZE) ? nullptr : (LPBYTE)GlobalAlloc(GMEM_FIXED, size + 1);
+			DWORD bytesRead = 0;
+			const bool read = bytes != nullptr && ReadFile(file, bytes, size, &bytesRead, NULL) && bytesRead == size;
+			CloseHandle(file);
+			if (read)
+			{
+				Decode(bytes, size);
+			}
+			if (bytes != nullptr)
+			{
+				GlobalFree(bytes);
+			}
+			return IsOpen();
+		}
+
+		//! File is open.
+		bool IsOpen() const
+		{
+			return text != nullptr;
+		}
+
+		//! Read value. A missing or deleted value is read as empty string, with REG_NONE.
+		bool Get(LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+		{
+			WideText name(EnvVarName);
+			if (!IsOpen() || name.text == nullptr)
+			{
+				return false;
+			}
+			ResultVar.Clear();
+			RegEntry entry;
+			if (!FindEntry(name.text, entry) || entry.type == REG_NONE)
+			{
+				ValueType = REG_NONE;
+				return true;
+			}
+			if (entry.type != REG_SZ && entry.type != REG_EXPAND_SZ)
+			{
+				return false;
+			}
+			ValueType = entry.type;
+
+			// decoded value is not longer than its encoded text
+			LPWSTR value = (LPWSTR)GlobalAlloc(GMEM_FIXED, (entry.end - entry.data + 1) * sizeof(WCHAR));
+			if (value == nullptr)
+			{
+				return false;
+			}
+			const size_t valueLen = View().DecodeData(entry, value);
+			value[valueLen] = 0;
+			bool success;
+#ifdef UNICODE
+			success = ResultVar.AssignString(value, 0, valueLen);
+#else
+			const int count = WideCharToMultiByte(CP_ACP, 0, value, -1, NULL, 0, NULL, NULL);
+			success = count > 0
+				&& ResultVar.Reserve(count)
+				&& WideCharToMultiByte(CP_ACP, 0, value, -1, static_cast<LPSTR>(ResultVar), count, NULL, NULL) == count;
+#endif
+			GlobalFree(value);
+			return success;
+		}
+
+		//! Write value in memory. REG_NONE removes the entry.
+		bool Set(LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+		{
+			WideText name(EnvVarName);
+			WideText value(NewValue);
+			if (!IsOpen() || name.text == nullptr || value.text == nullptr)
+			{
+				return false;
+			}
+
+			// where to put the entry: replace data of the old one, keeping its name as written, or add at the end of the key
+			size_t begin;
+			size_t end;
+			bool addKey = false;
+			RegEntry entry;
+			const bool found = FindEntry(name.text, entry);
+			if (found)
+			{
+				begin = (ValueType == REG_NONE) ? entry.begin : entry.data;
+				end = entry.next;
+			}
+			else if (ValueType == REG_NONE)
+			{
+				return true;
+			}
+			else if (FindKey(begin, end))
+			{
+				// after the last entry, before blank lines
+				while (end > begin && RegText::IsLineEnd(text[end - 1]))
+				{
+					end--;
+				}
+				end = begin = (end == begin) ? begin : View().SkipLine(end);
+			}
+			else
+			{
+				begin = end = length;
+				addKey = true;
+			}
+			// the last line of file may have no line end
+			const bool breakLine = !found && begin != 0 && !RegText::IsLineEnd(text[begin - 1]);
+
+			const RegText view = View();
+			LPCWSTR const addedKey = addKey ? keyName : nullptr;
+			const size_t entryLen = (ValueType == REG_NONE) ? 0 : view.Encode(found ? nullptr : name.text, value.text, ValueType, addedKey, length == 0, breakLine, found ? entry.data - entry.begin : 0, nullptr);
+			LPWSTR entryText = (LPWSTR)GlobalAlloc(GMEM_FIXED, (entryLen + 1) * sizeof(WCHAR));
+			if (entryText == nullptr)
+			{
+				return false;
+			}
+			if (ValueType != REG_NONE)
+			{
+				view.Encode(found ? nullptr : name.text, value.text, ValueType, addedKey, length == 0, breakLine, found ? entry.data - entry.begin : 0, entryText);
+			}
+			const bool success = Replace(begin, end, entryText, entryLen);
+			if (success && addKey)
+			{
+				// found again by the next FindKey
+				keyScanned = false;
+			}
+			GlobalFree(entryText);
+			written |= success;
+			return success;
+		}
+
+		//! Close file.
+		/*!
+			@param save true to write the file back, if anything is written.
+			@return false if save failed. The file is not changed then.
+			@remarks The file is saved to "file.new" first, and replaces the file.
+		 */
+		bool Close(bool save)
+		{
+			bool success = true;
+			if (save && written && text != nullptr)
+			{
+				success = Save();
+			}
+			if (text != nullptr)
+			{
+				GlobalFree(text);
+				text = nullptr;
+			}
+			length = 0;
+			capacity = 0;
+			written = false;
+			keyScanned = false;
+			return success;
+		}
+
+	private:
+		//! Decode file bytes to text.
+		void Decode(const BYTE *bytes, DWORD size)
+		{
+			unicode = size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE;
+			if (unicode)
+			{
+				length = (size - 2) / 2;
+				capacity = length + 1;
+				text = (LPWSTR)GlobalAlloc(GMEM_FIXED, capacity * sizeof(WCHAR));
+				if (text != nullptr)
+				{
+					for (size_t index = 0; index < length; index++)
+					{
+						text[index] = static_cast<WCHAR>(bytes[2 + 2 * index] | (bytes[3 + 2 * index] << 8));
+					}
+					text[length] = 0;
+				}
+				return;
+			}
+			const int count = (size == 0) ? 0 : MultiByteToWideChar(CP_ACP, 0, reinterpret_cast<LPCSTR>(bytes), size, NULL, 0);
+			capacity = count + 1;
+			text = (LPWSTR)GlobalAlloc(GMEM_FIXED, capacity * sizeof(WCHAR));
+			if (text != nullptr)
+			{
+				length = (count == 0) ? 0 : MultiByteToWideChar(CP_ACP, 0, reinterpret_cast<LPCSTR>(bytes), size, text, count);
+				text[length] = 0;
+			}
+		}
+
+		//! Write text to file, in the encoding it was read in.
+		bool Save()
+		{
+			DWORD size;
+			LPBYTE bytes;
+			if (unicode)
+			{
+				size = static_cast<DWORD>(2 + 2 * length);
+				bytes = (LPBYTE)GlobalAlloc(GMEM_FIXED, size);
+				if (bytes == nullptr)
+				{
+					return false;
+				}
+				bytes[0] = 0xFF;
+				bytes[1] = 0xFE;
+				for (size_t index = 0; index < length; index++)
+				{
+					bytes[2 + 2 * index] = static_cast<BYTE>(text[index] & 0xFF);
+					bytes[3 + 2 * index] = static_cast<BYTE>((text[index] >> 8) & 0xFF);
+				}
+			}
+			else
+			{
+				const int count = (length == 0) ? 0 : WideCharToMultiByte(CP_ACP, 0, text, static_cast<int>(length), NULL, 0, NULL, NULL);
+				bytes = (LPBYTE)GlobalAlloc(GMEM_FIXED, count + 1);
+				if (bytes == nullptr)
+				{
+					return false;
+				}
+				size = (count == 0) ? 0 : WideCharToMultiByte(CP_ACP, 0, text, static_cast<int>(length), reinterpret_cast<LPSTR>(bytes), count, NULL, NULL);
+			}
+
+			WCHAR newPath[MAX_PATH];
+			lstrcpyW(newPath, path);
+			lstrcatW(newPath, L".new");
+			bool success = false;
+			HANDLE file = CreateFileW(newPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				DWORD bytesWritten = 0;
+				success = WriteFile(file, bytes, size, &bytesWritten, NULL) && bytesWritten == size;
+				CloseHandle(file);
+				success = success && MoveFileExW(newPath, path, MOVEFILE_REPLACE_EXISTING) != FALSE;
+				if (!success)
+				{
+					DeleteFileW(newPath);
+				}
+			}
+			GlobalFree(bytes);
+			return success;
+		}
+
+		//! Text as RegText.
+		RegText View() const
+		{
+			const RegText view = { text, length, unicode };
+			return view;
+		}
+
+		//! Find entries of the environment key, after its "[key]" line up to the next "[key]" line.
+		/*!
+			@remarks Scanned at the first call only. Replace moves the range along with its writes.
+		 */
+		bool FindKey(size_t &begin, size_t &end)
+		{
+			if (!keyScanned)
+			{
+				const RegText view = View();
+				keyFound = false;
+				for (size_t line = 0; line < length && !keyFound; line = view.SkipLine(line))
+				{
+					if (view.IsKeyLine(line, keyName))
+					{
+						keyBegin = view.SkipLine(line);
+						keyEnd = keyBegin;
+						while (keyEnd < length && text[keyEnd] != L'[')
+						{
+							keyEnd = view.SkipLine(keyEnd);
+						}
+						keyFound = true;
+					}
+				}
+				keyScanned = true;
+			}
+			begin = keyBegin;
+			end = keyEnd;
+			return keyFound;
+		}
+
+		//! Find entry of value name in the environment key.
+		bool FindEntry(LPCWSTR name, RegEntry &entry)
+		{
+			size_t begin;
+			size_t end;
+			if (!FindKey(begin, end))
+			{
+				return false;
+			}
+			const RegText view = View();
+			for (size_t line = begin; line < end; line = entry.next)
+			{
+				view.ParseEntry(line, entry);
+				if (view.NameEquals(entry, name))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//! Replace text[begin, end) with piece.
+		/*!
+			@remarks The text after end is moved in place. The buffer grows by half when full, so that a series of writes copies the file a few times at most.
+		 */
+		bool Replace(size_t begin, size_t end, LPCWSTR piece, size_t pieceLen)
+		{
+			const size_t newLength = length - (end - begin) + pieceLen;
+			if (newLength + 1 > capacity)
+			{
+				const size_t newCapacity = newLength + 1 + newLength / 2;
+				LPWSTR newText = (LPWSTR)GlobalAlloc(GMEM_FIXED, newCapacity * sizeof(WCHAR));
+				if (newText == nullptr)
+				{
+					return false;
+				}
+				for (size_t index = 0; index < begin; index++)
+				{
+					newText[index] = text[index];
+				}
+				for (size_t index = end; index < length; index++)
+				{
+					newText[begin + pieceLen + index - end] = text[index];
+				}
+				GlobalFree(text);
+				text = newText;
+				capacity = newCapacity;
+			}
+			else if (begin + pieceLen > end)
+			{
+				// longer: move the rest from its end
+				for (size_t index = length; index > end; index--)
+				{
+					text[begin + pieceLen + index - 1 - end] = text[index - 1];
+				}
+			}
+			else if (begin + pieceLen < end)
+			{
+				for (size_t index = end; index < length; index++)
+				{
+					text[begin + pieceLen + index - end] = text[index];
+				}
+			}
+			for (size_t index = 0; index < pieceLen; index++)
+			{
+				text[begin + index] = piece[index];
+			}
+			text[newLength] = 0;
+			length = newLength;
+
+			// keep the environment key range
+			if (keyScanned && keyFound)
+			{
+				if (end <= keyBegin && begin < keyBegin)
+				{
+					keyBegin = keyBegin - (end - begin) + pieceLen;
+					keyEnd = keyEnd - (end - begin) + pieceLen;
+				}
+				else if (begin >= keyBegin && end <= keyEnd)
+				{
+					keyEnd = keyEnd - (end - begin) + pieceLen;
+				}
+			}
+			return true;
+		}
+		//! file text, or nullptr if not open
+		LPWSTR text;
+
+		//! text length in WCHAR count
+		size_t length;
+
+		//! text buffer size in WCHAR count, with null
+		size_t capacity;
+
+		//! keyBegin, keyEnd and keyFound are known
+		bool keyScanned;
+
+		//! the environment key is in text
+		bool keyFound;
+
+		//! first line after the "[key]" line
+		size_t keyBegin;
+
+		//! start of the next "[key]" line, or end of text
+		size_t keyEnd;
+
+		//! UTF-16LE file, or ANSI
+		bool unicode;
+
+		//! a value is written since Open
+		bool written;
+
+		//! environment key name, such as "HKEY_CURRENT_USER\Environment"
+		LPCWSTR keyName;
+
+		//! .reg file
+		WCHAR path[MAX_PATH];
+	};
+
+	//! getter of .reg file
+	bool GetRegFileValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		return static_cast<RegFile *>(context)->Get(EnvVarName, ResultVar, ValueType);
+	}
+
+	//! setter of .reg file
+	bool SetRegFileValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		return static_cast<RegFile *>(context)->Set(EnvVarName, NewValue, ValueType);
+	}
+
+	//! Store of an open .reg file
+	EnvStore RegFileStore(RegFile *file)
+	{
+		return EnvStore(GetRegFileValue, SetRegFileValue, file);
+	}
+	//! Store writes to a .reg file, which running programs do not see.
+	bool IsRegFileStore(const EnvStore &store)
+	{
+		return store.getter == GetRegFileValue;
+	}
+}
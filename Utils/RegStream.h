@@ -0,0 +1,845 @@
+//! @file RegStream.h
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include "EditGroup.h"
+#include "RegText.h"
+#include "WideText.h"
+
+namespace Utils
+{
+	//! One edit of RegStream, as the arguments of EnvVarUpdate.
+	struct RegEdit
+	{
+		//! value name
+		LPCWSTR EnvVarName;
+
+		//! "A", "P", "R", "D" or "C"
+		LPCTSTR Action;
+
+		//! false for the environment key of HKCU, true for HKLM
+		bool system;
+
+		//! path, or a list of them separated by ';'
+		LPCTSTR PathString;
+	};
+
+	//! Result of RegStream::Edit
+	enum RegStreamResult
+	{
+		//! nothing to change: no file is written
+		RegStreamUnchanged,
+		//! written
+		RegStreamChanged,
+		//! not written, see RegStream::error
+		RegStreamFailed,
+	};
+
+	//! Edits the environment keys of .reg files, reading and writing them through fixed buffers.
+	/*!
+		@remarks
+		Lines are passed through as bytes. Only the entries of the environment keys are decoded, one at a time,
+		and only edited entries are written anew, so that memory does not grow with the file:
+		two chunks, and a few times maxEntryBytes for the entry being edited.
+		Edits of the same value and key are applied in order by ApplyAction, as EnvVarUpdateBatch does.
+		A missing value is added at the end of its key, and a missing key at the end of the file.
+		Has no ctor, so that a zero initialized instance needs no CRT startup.
+	 */
+	class RegStream
+	{
+	public:
+		//! edits applied to every file
+		const RegEdit *edits;
+
+		//! count of edits
+		size_t editCount;
+
+		//! longest line, or entry with its continued lines, in bytes. 0 for DefaultMaxEntryBytes.
+		size_t maxEntryBytes;
+
+		//! why the last Edit failed
+		LPCTSTR error;
+
+		//! longest entry if maxEntryBytes is 0
+		static const size_t DefaultMaxEntryBytes = 1024 * 1024;
+
+		//! Apply edits to a .reg file.
+		/*!
+			@param inPath .reg file exported by regedit, UTF-16LE or ANSI.
+			@param outPath file to write if anything changes, which may be inPath. nullptr to write nothing.
+			@param normalizer matcher of the edits, living as long as this call.
+			@remarks The result is written to "outPath.new" first, and replaces outPath.
+		 */
+		RegStreamResult Edit(LPCWSTR inPath, LPCWSTR outPath, PathNormalizer &normalizer)
+		{
+			this->normalizer = &normalizer;
+			error = nullptr;
+			changed = false;
+			unicode = false;
+			lastEnded = true;
+			wroteAny = false;
+			section = NoSection;
+			seen[0] = seen[1] = false;
+			inPos = inLength = 0;
+			outLength = 0;
+			failed = false;
+
+			if (!Prepare())
+			{
+				return Fail(_T("out of memory"));
+			}
+
+			in = CreateFileW(inPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (in == INVALID_HANDLE_VALUE)
+			{
+				return Fail(_T("not read"));
+			}
+			out = INVALID_HANDLE_VALUE;
+			WCHAR newPath[MAX_PATH];
+			if (outPath != nullptr)
+			{
+				if (lstrlenW(outPath) >= MAX_PATH - 4)
+				{
+					CloseHandle(in);
+					return Fail(_T("path too long"));
+				}
+				lstrcpyW(newPath, outPath);
+				lstrcatW(newPath, L".new");
+				out = CreateFileW(newPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+				if (out == INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(in);
+					return Fail(_T("not written"));
+				}
+			}
+
+			// BOM of UTF-16LE, kept as it is
+			if (Fill() && inLength >= 2 && inChunk[0] == 0xFF && inChunk[1] == 0xFE)
+			{
+				unicode = true;
+				inPos = 2;
+				Write(inChunk, 2);
+			}
+			Run();
+
+			CloseHandle(in);
+			bool success = !failed;
+			if (out != INVALID_HANDLE_VALUE)
+			{
+				success = Flush() && success;
+				CloseHandle(out);
+				if (success && changed)
+				{
+					success = MoveFileExW(newPath, outPath, MOVEFILE_REPLACE_EXISTING) != FALSE;
+					error = success ? error : _T("not written");
+				}
+				if (!success || !changed)
+				{
+					DeleteFileW(newPath);
+				}
+			}
+			if (!success)
+			{
+				return Fail((error != nullptr) ? error : _T("not written"));
+			}
+			return changed ? RegStreamChanged : RegStreamUnchanged;
+		}
+
+		//! Free the buffers kept between files.
+		void Release()
+		{
+			Free(inChunk);
+			Free(outChunk);
+			Free(done);
+			Free(line.bytes);
+			Free(entry.bytes);
+			Free(blank.bytes);
+			Free(encoded.bytes);
+			Free(wide);
+			Free(value);
+			doneCount = 0;
+			line.capacity = entry.capacity = blank.capacity = encoded.capacity = 0;
+			wideCapacity = valueCapacity = 0;
+		}
+
+	private:
+		//! bytes read and written at once
+		static const DWORD ChunkBytes = 64 * 1024;
+
+		//! section of the file being read
+		enum Section
+		{
+			//! header, or another key
+			NoSection = -1,
+			//! environment key of HKCU
+			UserSection = 0,
+			//! environment key of HKLM
+			SystemSection = 1,
+		};
+
+		//! Bytes in a GlobalAlloc block, growing as needed.
+		struct Buffer
+		{
+			LPBYTE bytes;
+			size_t length;
+			size_t capacity;
+		};
+
+		//! Free a GlobalAlloc block, and forget it.
+		template <class T>
+		static void Free(T *&block)
+		{
+			if (block != nullptr)
+			{
+				GlobalFree(block);
+				block = nullptr;
+			}
+		}
+
+		//! Longest entry in bytes, even for UTF-16.
+		size_t MaxEntry() const
+		{
+			return ((maxEntryBytes == 0) ? DefaultMaxEntryBytes : maxEntryBytes) & ~static_cast<size_t>(1);
+		}
+
+		//! Allocate chunks and done flags, kept for the next file.
+		bool Prepare()
+		{
+			if (inChunk == nullptr)
+			{
+				inChunk = (LPBYTE)GlobalAlloc(GMEM_FIXED, ChunkBytes);
+			}
+			if (outChunk == nullptr)
+			{
+				outChunk = (LPBYTE)GlobalAlloc(GMEM_FIXED, ChunkBytes);
+			}
+			if (doneCount < editCount)
+			{
+				Free(done);
+				done = (bool *)GlobalAlloc(GMEM_FIXED, editCount * sizeof(bool));
+				doneCount = (done == nullptr) ? 0 : editCount;
+			}
+			for (size_t index = 0; index < doneCount; index++)
+			{
+				done[index] = false;
+			}
+			return inChunk != nullptr && outChunk != nullptr && (editCount == 0 || done != nullptr);
+		}
+
+		//! Record a failure, and keep going as little as possible.
+		RegStreamResult Fail(LPCTSTR reason)
+		{
+			if (error == nullptr)
+			{
+				error = reason;
+			}
+			failed = true;
+			return RegStreamFailed;
+		}
+
+		//! Append bytes, growing by double up to what is needed.
+		static bool Append(Buffer &buffer, const BYTE *bytes, size_t count)
+		{
+			if (buffer.length + count > buffer.capacity)
+			{
+				size_t capacity = (buffer.capacity == 0) ? 256 : buffer.capacity;
+				while (capacity < buffer.length + count)
+				{
+					capacity *= 2;
+				}
+				LPBYTE grown = (LPBYTE)GlobalAlloc(GMEM_FIXED, capacity);
+				if (grown == nullptr)
+				{
+					return false;
+				}
+				for (size_t index = 0; index < buffer.length; index++)
+				{
+					grown[index] = buffer.bytes[index];
+				}
+				Free(buffer.bytes);
+				buffer.bytes = grown;
+				buffer.capacity = capacity;
+			}
+			for (size_t index = 0; index < count; index++)
+			{
+				buffer.bytes[buffer.length++] = bytes[index];
+			}
+			return true;
+		}
+
+		//! Make room for count WCHAR in buffer.
+		static bool Reserve(LPWSTR &buffer, size_t &capacity, size_t count)
+		{
+			if (count > capacity)
+			{
+				Free(buffer);
+				capacity = (count < 256) ? 256 : count;
+				buffer = (LPWSTR)GlobalAlloc(GMEM_FIXED, capacity * sizeof(WCHAR));
+				if (buffer == nullptr)
+				{
+					capacity = 0;
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//! Read the next chunk.
+		bool Fill()
+		{
+			DWORD bytesRead = 0;
+			if (!ReadFile(in, inChunk, ChunkBytes, &bytesRead, NULL))
+			{
+				Fail(_T("not read"));
+				bytesRead = 0;
+			}
+			inPos = 0;
+			inLength = bytesRead;
+			return bytesRead != 0;
+		}
+
+		//! Read a line, with its line end, to line.
+		/*!
+			@param complete false if the line is longer than MaxEntry: the rest is read by the next calls.
+			@return false at the end of file.
+		 */
+		bool ReadLine(bool &complete)
+		{
+			line.length = 0;
+			complete = false;
+			const size_t limit = MaxEntry();
+			while (line.length < limit)
+			{
+				if (inPos == inLength && !Fill())
+				{
+					complete = true;
+					break;
+				}
+
+				// up to the line feed in this chunk: 0x0A, or 0x0A 0x00 at an even offset in UTF-16
+				const size_t stop = (inLength - inPos > limit - line.length) ? inPos + limit - line.length : inLength;
+				size_t end = inPos;
+				bool lineFeed = false;
+				while (!lineFeed && end < stop)
+				{
+					end += FindChar(inChunk + end, stop - end, static_cast<BYTE>(0x0A));
+					if (end == stop)
+					{
+						break;
+					}
+					lineFeed = !unicode || (end % 2 == 0 && end + 1 < inLength && inChunk[end + 1] == 0);
+					end += (lineFeed && unicode) ? 2 : 1;
+				}
+				if (!Append(line, inChunk + inPos, end - inPos))
+				{
+					Fail(_T("out of memory"));
+					return false;
+				}
+				inPos = end;
+				if (lineFeed)
+				{
+					complete = true;
+					break;
+				}
+			}
+			return line.length != 0;
+		}
+
+		//! Decode bytes of the file to wide.
+		/*!
+			@return length in WCHAR count.
+		 */
+		size_t Decode(const Buffer &raw)
+		{
+			if (!Reserve(wide, wideCapacity, raw.length + 1))
+			{
+				Fail(_T("out of memory"));
+				return 0;
+			}
+			size_t length = 0;
+			if (unicode)
+			{
+				for (size_t index = 0; index + 1 < raw.length; index += 2)
+				{
+					wide[length++] = static_cast<WCHAR>(raw.bytes[index] | (raw.bytes[index + 1] << 8));
+				}
+			}
+			else if (raw.length != 0)
+			{
+				length = MultiByteToWideChar(CP_ACP, 0, reinterpret_cast<LPCSTR>(raw.bytes), static_cast<int>(raw.length), wide, static_cast<int>(wideCapacity));
+			}
+			wide[length] = 0;
+			return length;
+		}
+
+		//! Write bytes to the output.
+		void Write(const BYTE *bytes, size_t count)
+		{
+			wroteAny = wroteAny || count != 0;
+			if (out == INVALID_HANDLE_VALUE)
+			{
+				return;
+			}
+			for (size_t index = 0; index < count; index++)
+			{
+				if (outLength == ChunkBytes && !Flush())
+				{
+					return;
+				}
+				outChunk[outLength++] = bytes[index];
+			}
+		}
+
+		//! Write raw bytes, as read.
+		void Write(const Buffer &raw)
+		{
+			Write(raw.bytes, raw.length);
+			if (raw.length != 0)
+			{
+				lastEnded = raw.bytes[raw.length - (unicode ? 2 : 1)] == 0x0A;
+			}
+		}
+
+		//! Write text in the encoding of the file.
+		void WriteText(LPCWSTR text, size_t length)
+		{
+			encoded.length = 0;
+			if (unicode)
+			{
+				for (size_t index = 0; index < length; index++)
+				{
+					const BYTE pair[] = { static_cast<BYTE>(text[index] & 0xFF), static_cast<BYTE>((text[index] >> 8) & 0xFF) };
+					if (!Append(encoded, pair, 2))
+					{
+						Fail(_T("out of memory"));
+						return;
+					}
+				}
+			}
+			else if (length != 0)
+			{
+				const int count = WideCharToMultiByte(CP_ACP, 0, text, static_cast<int>(length), NULL, 0, NULL, NULL);
+				if (count <= 0 || (encoded.capacity < static_cast<size_t>(count) && !Grow(encoded, count)))
+				{
+					Fail(_T("out of memory"));
+					return;
+				}
+				encoded.length = WideCharToMultiByte(CP_ACP, 0, text, static_cast<int>(length), reinterpret_cast<LPSTR>(encoded.bytes), count, NULL, NULL);
+			}
+			Write(encoded);
+		}
+
+		//! Make room for count bytes in buffer, which is emptied.
+		static bool Grow(Buffer &buffer, size_t count)
+		{
+			Free(buffer.bytes);
+			buffer.length = 0;
+			buffer.bytes = (LPBYTE)GlobalAlloc(GMEM_FIXED, count);
+			buffer.capacity = (buffer.bytes == nullptr) ? 0 : count;
+			return buffer.bytes != nullptr;
+		}
+
+		//! Write the output chunk to the file.
+		bool Flush()
+		{
+			DWORD bytesWritten = 0;
+			const bool success = outLength == 0 || (WriteFile(out, outChunk, static_cast<DWORD>(outLength), &bytesWritten, NULL) && bytesWritten == outLength);
+			outLength = 0;
+			if (!success)
+			{
+				Fail(_T("not written"));
+			}
+			return success;
+		}
+
+		//! Write blank lines held at the end of an environment key.
+		void FlushBlank()
+		{
+			Write(blank);
+			blank.length = 0;
+		}
+
+		//! Read and edit the file, line by line.
+		void Run()
+		{
+			bool first = true;
+			bool complete;
+			while (!failed && ReadLine(complete))
+			{
+				if (!complete)
+				{
+					// longer than any environment entry may be: passed through
+					if (section != NoSection)
+					{
+						Fail(_T("entry too long"));
+						return;
+					}
+					Write(line);
+					while (!complete && ReadLine(complete))
+					{
+						Write(line);
+					}
+					first = false;
+					continue;
+				}
+
+				const size_t length = Decode(line);
+				if (first)
+				{
+					first = false;
+					LPCWSTR const header = unicode ? L"Windows Registry Editor Version 5.00" : L"REGEDIT4";
+					const size_t headerLen = lstrlenW(header);
+					if (length < headerLen || !RegText::EqualsIgnoreCase(wide, header, headerLen))
+					{
+						Fail(_T("not a .reg file"));
+						return;
+					}
+				}
+
+				if (length != 0 && wide[0] == L'[')
+				{
+					EndSection();
+					const RegText view = { wide, length, unicode };
+					section = view.IsKeyLine(0, HkcuEnvironmentKey) ? UserSection : view.IsKeyLine(0, HklmEnvironmentKey) ? SystemSection : NoSection;
+					if (section != NoSection && seen[section])
+					{
+						// edited once, in its first key
+						section = NoSection;
+					}
+					Write(line);
+					continue;
+				}
+				if (section != NoSection && (length == 0 || RegText::IsLineEnd(wide[0])))
+				{
+					// added values go before them
+					if (blank.length + line.length > MaxEntry())
+					{
+						FlushBlank();
+					}
+					if (!Append(blank, line.bytes, line.length))
+					{
+						Fail(_T("out of memory"));
+					}
+					continue;
+				}
+				if (section != NoSection && wide[0] == L'"')
+				{
+					EditEntry();
+					continue;
+				}
+				FlushBlank();
+				Write(line);
+			}
+			if (!failed)
+			{
+				EndSection();
+				AddKeys();
+			}
+		}
+
+		//! Read an entry of an environment key starting at line, and edit it if any edit is for it.
+		void EditEntry()
+		{
+			// the entry, with its continued lines: only the line just read is decoded to look for its '\\'
+			entry.length = 0;
+			bool complete = true;
+			for (bool firstLine = true; ; firstLine = false)
+			{
+				if (!Append(entry, line.bytes, line.length))
+				{
+					Fail(_T("out of memory"));
+					return;
+				}
+				const size_t length = Decode(line);
+				size_t lineEnd = length;
+				while (lineEnd > 0 && RegText::IsLineEnd(wide[lineEnd - 1]))
+				{
+					lineEnd--;
+				}
+				bool continued = lineEnd != length && lineEnd > 0 && wide[lineEnd - 1] == L'\\';
+				if (continued && firstLine)
+				{
+					// a quoted string, or a line without a name, does not go on
+					const RegText view = { wide, length, unicode };
+					RegEntry parsed;
+					view.ParseEntry(0, parsed);
+					continued = view.IsContinued(parsed, lineEnd);
+				}
+				if (!continued)
+				{
+					break;
+				}
+				if (!ReadLine(complete))
+				{
+					break;
+				}
+				if (!complete || entry.length + line.length > MaxEntry())
+				{
+					Fail(_T("entry too long"));
+					return;
+				}
+			}
+
+			const size_t length = Decode(entry);
+			const RegText view = { wide, length, unicode };
+			RegEntry parsed;
+			view.ParseEntry(0, parsed);
+			const size_t first = FindEdit(view, parsed);
+			FlushBlank();
+			if (first == editCount)
+			{
+				Write(entry);
+				return;
+			}
+			if (parsed.type != REG_SZ && parsed.type != REG_EXPAND_SZ && parsed.type != REG_NONE)
+			{
+				Fail(_T("not a string value"));
+				return;
+			}
+
+			// value as read, or empty if deleted by "-"
+			if (!Reserve(value, valueCapacity, parsed.end - parsed.data + 1))
+			{
+				Fail(_T("out of memory"));
+				return;
+			}
+			const size_t valueLen = (parsed.type == REG_NONE) ? 0 : view.DecodeData(parsed, value);
+			value[valueLen] = 0;
+
+			PendingValue pending;
+			DWORD type;
+			if (!ApplyEdits(first, value, valueLen, parsed.type, pending, type))
+			{
+				return;
+			}
+			if (!pending.IsChanged())
+			{
+				Write(entry);
+				return;
+			}
+
+			// "name"= as written, and the new data
+			WideText newValue(*pending.current);
+			if (newValue.text == nullptr)
+			{
+				Fail(_T("out of memory"));
+				return;
+			}
+			const size_t prefixLen = parsed.data - parsed.begin;
+			const size_t dataLen = view.Encode(nullptr, newValue.text, type, nullptr, false, false, prefixLen, nullptr);
+			LPWSTR text = (LPWSTR)GlobalAlloc(GMEM_FIXED, (prefixLen + dataLen + 1) * sizeof(WCHAR));
+			if (text == nullptr)
+			{
+				Fail(_T("out of memory"));
+				return;
+			}
+			for (size_t index = 0; index < prefixLen; index++)
+			{
+				text[index] = wide[parsed.begin + index];
+			}
+			view.Encode(nullptr, newValue.text, type, nullptr, false, false, prefixLen, text + prefixLen);
+			WriteText(text, prefixLen + dataLen);
+			GlobalFree(text);
+			changed = true;
+		}
+
+		//! First edit not done for the entry in this section, or editCount.
+		size_t FindEdit(const RegText &view, const RegEntry &parsed) const
+		{
+			for (size_t index = 0; index < editCount; index++)
+			{
+				if (!done[index] && edits[index].system == (section == SystemSection) && view.NameEquals(parsed, edits[index].EnvVarName))
+				{
+					return index;
+				}
+			}
+			return editCount;
+		}
+
+		//! Test if 2 value names are the same.
+		static bool SameName(LPCWSTR a, LPCWSTR b)
+		{
+			const size_t length = lstrlenW(a);
+			return static_cast<size_t>(lstrlenW(b)) == length && RegText::EqualsIgnoreCase(a, b, length);
+		}
+
+		//! Apply edits of the value of edits[first], in order, and mark them done.
+		/*!
+			@param readValue value as read, in UTF-16.
+			@param readType type of readValue, REG_NONE if missing.
+			@param type receives the type to write the result in.
+		 */
+		bool ApplyEdits(size_t first, LPCWSTR readValue, size_t readLen, DWORD readType, PendingValue &pending, DWORD &type)
+		{
+#ifdef UNICODE
+			bool success = pending.ReadValue.AssignString(readValue, 0, readLen);
+#else
+			const int count = WideCharToMultiByte(CP_ACP, 0, readValue, static_cast<int>(readLen) + 1, NULL, 0, NULL, NULL);
+			bool success = count > 0
+				&& pending.ReadValue.Reserve(count)
+				&& WideCharToMultiByte(CP_ACP, 0, readValue, static_cast<int>(readLen) + 1, static_cast<LPSTR>(pending.ReadValue), count, NULL, NULL) == count;
+#endif
+			pending.ValueType = readType;
+			for (size_t index = first; success && index < editCount; index++)
+			{
+				if (!done[index] && edits[index].system == edits[first].system && SameName(edits[index].EnvVarName, edits[first].EnvVarName))
+				{
+					done[index] = true;
+					success = ApplyAction(edits[index].Action, *pending.current, edits[index].PathString, pending.NewValue, *normalizer);
+					pending.Value.Swap(pending.NewValue);
+					pending.current = &pending.Value;
+				}
+			}
+			if (!success)
+			{
+				Fail(_T("edit failed"));
+				return false;
+			}
+			type = ChooseValueType(readType, *pending.current);
+			return true;
+		}
+
+		//! Write values missing from a section of edits not done, at the end of the key.
+		/*!
+			@param keyName "[keyName]" to write before the first added value, or nullptr.
+		 */
+		void AddValues(bool system, LPCWSTR keyName)
+		{
+			for (size_t index = 0; !failed && index < editCount; index++)
+			{
+				if (done[index] || edits[index].system != system)
+				{
+					continue;
+				}
+				PendingValue pending;
+				DWORD type;
+				if (!ApplyEdits(index, L"", 0, REG_NONE, pending, type) || !pending.IsChanged())
+				{
+					continue;
+				}
+				WideText newValue(*pending.current);
+				if (newValue.text == nullptr)
+				{
+					Fail(_T("out of memory"));
+					return;
+				}
+				const RegText view = { nullptr, 0, unicode };
+				const bool header = !wroteAny;
+				const size_t length = view.Encode(edits[index].EnvVarName, newValue.text, type, keyName, header, !lastEnded, 0, nullptr);
+				LPWSTR text = (LPWSTR)GlobalAlloc(GMEM_FIXED, (length + 1) * sizeof(WCHAR));
+				if (text == nullptr)
+				{
+					Fail(_T("out of memory"));
+					return;
+				}
+				view.Encode(edits[index].EnvVarName, newValue.text, type, keyName, header, !lastEnded, 0, text);
+				WriteText(text, length);
+				GlobalFree(text);
+				changed = true;
+				keyName = nullptr;
+			}
+		}
+
+		//! End an environment key: add its missing values, before its blank lines.
+		void EndSection()
+		{
+			if (section != NoSection)
+			{
+				AddValues(section == SystemSection, nullptr);
+				seen[section] = true;
+				section = NoSection;
+			}
+			FlushBlank();
+		}
+
+		//! Add environment keys not in the file, having values to add.
+		void AddKeys()
+		{
+			if (!seen[UserSection])
+			{
+				AddValues(false, HkcuEnvironmentKey);
+			}
+			if (!seen[SystemSection])
+			{
+				AddValues(true, HklmEnvironmentKey);
+			}
+		}
+
+		//! matcher of the current Edit
+		PathNormalizer *normalizer;
+
+		//! file being read
+		HANDLE in;
+
+		//! "outPath.new", or INVALID_HANDLE_VALUE
+		HANDLE out;
+
+		//! chunk of the file being read
+		LPBYTE inChunk;
+
+		//! next byte of inChunk
+		size_t inPos;
+
+		//! bytes in inChunk
+		size_t inLength;
+
+		//! chunk to write
+		LPBYTE outChunk;
+
+		//! bytes in outChunk
+		size_t outLength;
+
+		//! edits done in this file, by index
+		bool *done;
+
+		//! count of done
+		size_t doneCount;
+
+		//! line being read
+		Buffer line;
+
+		//! entry being read, with its continued lines
+		Buffer entry;
+
+		//! blank lines held at the end of an environment key
+		Buffer blank;
+
+		//! text encoded to write
+		Buffer encoded;
+
+		//! decoded line or entry
+		LPWSTR wide;
+
+		//! size of wide in WCHAR count
+		size_t wideCapacity;
+
+		//! decoded value
+		LPWSTR value;
+
+		//! size of value in WCHAR count
+		size_t valueCapacity;
+
+		//! section of the file being read
+		int section;
+
+		//! environment keys of HKCU and HKLM already read
+		bool seen[2];
+
+		//! UTF-16LE file, or ANSI
+		bool unicode;
+
+		//! the last written line has its line end
+		bool lastEnded;
+
+		//! anything is written, even to no file
+		bool wroteAny;
+
+		//! an entry is changed
+		bool changed;
+
+		//! the current Edit failed
+		bool failed;
+	};
+}
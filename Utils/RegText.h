@@ -0,0 +1,374 @@
+//! @file RegText.h
+//! @author kenjiuno
+//! @date Oct 18 2026
+
+#pragma once
+
+#include <Windows.h>
+
+namespace Utils
+{
+	//! environment key of HKCU in .reg files
+	LPCWSTR const HkcuEnvironmentKey = L"HKEY_CURRENT_USER\\Environment";
+
+	//! environment key of HKLM in .reg files
+	LPCWSTR const HklmEnvironmentKey = L"HKEY_LOCAL_MACHINE\\SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment";
+
+	//! An entry of a key: "name"=data, up to the end of its last continued line.
+	struct RegEntry
+	{
+		//! start of "name"
+		size_t begin;
+
+		//! start of data, after '='
+		size_t data;
+
+		//! end of data, before the line end
+		size_t end;
+
+		//! start of the next line
+		size_t next;
+
+		//! REG_SZ, REG_EXPAND_SZ, REG_NONE if deleted by "-", or REG_BINARY for other data
+		DWORD type;
+	};
+
+	//! Text of a .reg file, or of some lines of it, read and written as regedit does.
+	/*!
+		@remarks
+		Offsets are in WCHAR count from text.
+		REG_SZ is "name"="text", and REG_EXPAND_SZ is "name"=hex(2):.. bytes in the encoding of the file:
+		UTF-16LE for "Windows Registry Editor Version 5.00", and ANSI for REGEDIT4.
+	 */
+	struct RegText
+	{
+		//! text, not null terminated
+		LPCWSTR text;
+
+		//! text length in WCHAR count
+		size_t length;
+
+		//! UTF-16LE file, or ANSI
+		bool unicode;
+
+		//! Start of the next line.
+		size_t SkipLine(size_t index) const
+		{
+			while (index < length && !IsLineEnd(text[index]))
+			{
+				index++;
+			}
+			if (index < length && text[index] == L'\r')
+			{
+				index++;
+			}
+			if (index < length && text[index] == L'\n')
+			{
+				index++;
+			}
+			return index;
+		}
+
+		//! Test if line is "[keyName]".
+		bool IsKeyLine(size_t line, LPCWSTR keyName) const
+		{
+			const size_t keyLen = lstrlenW(keyName);
+			return text[line] == L'[' && line + 1 + keyLen < length && text[line + 1 + keyLen] == L']' && EqualsIgnoreCase(text + line + 1, keyName, keyLen);
+		}
+
+		//! Parse an entry starting at line, with its continued lines.
+		void ParseEntry(size_t line, RegEntry &entry) const
+		{
+			entry.begin = line;
+			entry.data = line;
+			entry.type = REG_BINARY;
+
+			// skip quoted name
+			size_t index = line;
+			if (text[index] == L'"')
+			{
+				for (index++; index < length && text[index] != L'"' && !IsLineEnd(text[index]); index++)
+				{
+					if (text[index] == L'\\' && index + 1 < length)
+					{
+						index++;
+					}
+				}
+				if (index + 1 < length && text[index] == L'"' && text[index + 1] == L'=')
+				{
+					entry.data = index + 2;
+				}
+			}
+
+			// the line, and lines continued by '\\' at the end
+			entry.end = entry.data;
+			while (true)
+			{
+				while (entry.end < length && !IsLineEnd(text[entry.end]))
+				{
+					entry.end++;
+				}
+				if (IsContinued(entry, entry.end))
+				{
+					entry.end = SkipLine(entry.end);
+					continue;
+				}
+				break;
+			}
+			entry.next = SkipLine(entry.end);
+
+			if (entry.data == line)
+			{
+				return;
+			}
+			if (text[entry.data] == L'"')
+			{
+				entry.type = REG_SZ;
+			}
+			else if (text[entry.data] == L'-')
+			{
+				entry.type = REG_NONE;
+			}
+			else if (entry.data + 7 <= entry.end && EqualsIgnoreCase(text + entry.data, L"hex(2):", 7))
+			{
+				entry.type = REG_EXPAND_SZ;
+			}
+		}
+
+		//! Test if data of entry goes on to the next line: hex bytes ending with '\\' at lineEnd.
+		bool IsContinued(const RegEntry &entry, size_t lineEnd) const
+		{
+			return entry.data != entry.begin && lineEnd > entry.data && text[lineEnd - 1] == L'\\' && text[entry.data] != L'"';
+		}
+
+		//! Compare unescaped name of entry with name, ignoring case of ASCII letters.
+		bool NameEquals(const RegEntry &entry, LPCWSTR name) const
+		{
+			if (text[entry.begin] != L'"' || entry.data == entry.begin)
+			{
+				return false;
+			}
+			const size_t nameLen = lstrlenW(name);
+			size_t index = entry.begin + 1;
+			size_t nameIndex = 0;
+			bool same = true;
+			while (index < entry.end && text[index] != L'"')
+			{
+				if (text[index] == L'\\' && index + 1 < entry.end)
+				{
+					index++;
+				}
+				same = same && nameIndex < nameLen && EqualsIgnoreCase(text + index, name + nameIndex, 1);
+				nameIndex++;
+				index++;
+			}
+			return same && nameIndex == nameLen;
+		}
+
+		//! Decode REG_SZ or REG_EXPAND_SZ data of entry.
+		/*!
+			@param value receives the value, of entry.end - entry.data + 1 WCHAR at most.
+			@return length in WCHAR count.
+		 */
+		size_t DecodeData(const RegEntry &entry, LPWSTR value) const
+		{
+			size_t valueLen = 0;
+			if (entry.type == REG_SZ)
+			{
+				for (size_t index = entry.data + 1; index < entry.end && text[index] != L'"'; index++)
+				{
+					if (text[index] == L'\\' && index + 1 < entry.end)
+					{
+						index++;
+					}
+					value[valueLen++] = text[index];
+				}
+				return valueLen;
+			}
+
+			// hex(2): comma separated bytes, continued by '\\'
+			LPBYTE bytes = (LPBYTE)GlobalAlloc(GMEM_FIXED, entry.end - entry.data + 1);
+			if (bytes == nullptr)
+			{
+				return 0;
+			}
+			size_t byteCount = 0;
+			int digits = 0;
+			BYTE one = 0;
+			for (size_t index = entry.data + 7; index < entry.end; index++)
+			{
+				const WCHAR c = text[index];
+				const int digit = (c >= L'0' && c <= L'9') ? c - L'0' : (c >= L'a' && c <= L'f') ? c - L'a' + 10 : (c >= L'A' && c <= L'F') ? c - L'A' + 10 : -1;
+				if (digit >= 0)
+				{
+					one = static_cast<BYTE>((one << 4) | digit);
+					if (++digits == 2)
+					{
+						bytes[byteCount++] = one;
+						digits = 0;
+						one = 0;
+					}
+				}
+			}
+			if (unicode)
+			{
+				for (size_t index = 0; index + 1 < byteCount; index += 2)
+				{
+					value[valueLen++] = static_cast<WCHAR>(bytes[index] | (bytes[index + 1] << 8));
+				}
+			}
+			else if (byteCount != 0)
+			{
+				valueLen = MultiByteToWideChar(CP_ACP, 0, reinterpret_cast<LPCSTR>(bytes), static_cast<int>(byteCount), value, static_cast<int>(entry.end - entry.data));
+			}
+			GlobalFree(bytes);
+			while (valueLen != 0 && value[valueLen - 1] == 0)
+			{
+				valueLen--;
+			}
+			return valueLen;
+		}
+
+		//! Write entry text, or only count it if out is nullptr.
+		/*!
+			@param name value name, or nullptr to write data only, after the name kept in text.
+			@param keyName "[keyName]" line to write before, or nullptr.
+			@param header true to write the file header before "[keyName]", for an empty file.
+			@param breakLine true to end the line before first.
+			@param lineLen chars kept in text before out, on the same line.
+			@return length in WCHAR count.
+		 */
+		size_t Encode(LPCWSTR name, LPCWSTR value, DWORD ValueType, LPCWSTR keyName, bool header, bool breakLine, size_t lineLen, LPWSTR out) const
+		{
+			size_t outLen = 0;
+			if (breakLine)
+			{
+				Put(out, outLen, L"\r\n");
+			}
+			if (keyName != nullptr)
+			{
+				if (header)
+				{
+					Put(out, outLen, unicode ? L"Windows Registry Editor Version 5.00\r\n" : L"REGEDIT4\r\n");
+				}
+				Put(out, outLen, L"\r\n[");
+				Put(out, outLen, keyName);
+				Put(out, outLen, L"]\r\n");
+			}
+			size_t lineStart = outLen;
+			if (name != nullptr)
+			{
+				Put(out, outLen, L"\"");
+				PutEscaped(out, outLen, name);
+				Put(out, outLen, L"\"=");
+			}
+			if (ValueType != REG_EXPAND_SZ)
+			{
+				Put(out, outLen, L"\"");
+				PutEscaped(out, outLen, value);
+				Put(out, outLen, L"\"");
+			}
+			else
+			{
+				Put(out, outLen, L"hex(2):");
+				const size_t valueLen = lstrlenW(value);
+				const BYTE *ansi = nullptr;
+				LPSTR converted = nullptr;
+				size_t byteCount;
+				if (unicode)
+				{
+					byteCount = (valueLen + 1) * 2;
+				}
+				else
+				{
+					const int count = WideCharToMultiByte(CP_ACP, 0, value, -1, NULL, 0, NULL, NULL);
+					converted = (count > 0) ? (LPSTR)GlobalAlloc(GMEM_FIXED, count) : nullptr;
+					byteCount = (converted != nullptr) ? WideCharToMultiByte(CP_ACP, 0, value, -1, converted, count, NULL, NULL) : 0;
+					ansi = reinterpret_cast<const BYTE *>(converted);
+				}
+				for (size_t index = 0; index < byteCount; index++)
+				{
+					const BYTE one = unicode
+						? static_cast<BYTE>((index / 2 < valueLen) ? (value[index / 2] >> ((index % 2) * 8)) & 0xFF : 0)
+						: ansi[index];
+					const WCHAR hex[] = { L"0123456789abcdef"[one >> 4], L"0123456789abcdef"[one & 15], 0 };
+					Put(out, outLen, hex);
+					if (index + 1 < byteCount)
+					{
+						Put(out, outLen, L",");
+						// wrap as regedit does
+						if (lineLen + outLen - lineStart >= 76)
+						{
+							Put(out, outLen, L"\\\r\n  ");
+							lineLen = 2;
+							lineStart = outLen;
+						}
+					}
+				}
+				if (converted != nullptr)
+				{
+					GlobalFree(converted);
+				}
+			}
+			Put(out, outLen, L"\r\n");
+			return outLen;
+		}
+
+		//! Put piece of text, or only count it.
+		static void Put(LPWSTR out, size_t &outLen, LPCWSTR piece)
+		{
+			for (; *piece != 0; piece++)
+			{
+				if (out != nullptr)
+				{
+					out[outLen] = *piece;
+				}
+				outLen++;
+			}
+		}
+
+		//! Put text with '\\' and '"' escaped.
+		static void PutEscaped(LPWSTR out, size_t &outLen, LPCWSTR piece)
+		{
+			for (; *piece != 0; piece++)
+			{
+				if (*piece == L'\\' || *piece == L'"')
+				{
+					if (out != nullptr)
+					{
+						out[outLen] = L'\\';
+					}
+					outLen++;
+				}
+				if (out != nullptr)
+				{
+					out[outLen] = *piece;
+				}
+				outLen++;
+			}
+		}
+
+		//! CR or LF
+		static bool IsLineEnd(WCHAR c)
+		{
+			return c == L'\r' || c == L'\n';
+		}
+
+		//! Compare count chars ignoring case of ASCII letters.
+		static bool EqualsIgnoreCase(LPCWSTR a, LPCWSTR b, size_t count)
+		{
+			for (size_t index = 0; index < count; index++)
+			{
+				WCHAR x = a[index];
+				WCHAR y = b[index];
+				x = (x >= L'a' && x <= L'z') ? x - L'a' + L'A' : x;
+				y = (y >= L'a' && y <= L'z') ? y - L'a' + L'A' : y;
+				if (x != y)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+}
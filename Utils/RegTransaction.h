@@ -0,0 +1,149 @@
+//! @file RegTransaction.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "RegistryStore.h"
+
+namespace Utils
+{
+	//! CreateTransaction prototype (ktmw32.dll)
+	typedef HANDLE(WINAPI *CreateTransactionProc)(LPSECURITY_ATTRIBUTES lpTransactionAttributes, LPGUID UOW, DWORD CreateOptions, DWORD IsolationLevel, DWORD IsolationFlags, DWORD Timeout, LPWSTR Description);
+
+	//! CommitTransaction and RollbackTransaction prototype (ktmw32.dll)
+	typedef BOOL(WINAPI *EndTransactionProc)(HANDLE TransactionHandle);
+
+	//! Registry writes committed at once by Kernel Transaction Manager (Vista or later)
+	/*!
+		@remarks
+		APIs are loaded at runtime, so that this DLL still loads on older Windows.
+		Stores obtained by Store write through key handles opened in the transaction.
+		Nothing is visible to others until Commit.
+	 */
+	class RegTransaction
+	{
+	public:
+		//! ctor
+		RegTransaction() : ktmw32(nullptr), transaction(nullptr), commitTransaction(nullptr), rollbackTransaction(nullptr)
+		{
+			ZeroFill(&hkcuKeys, sizeof(hkcuKeys));
+			ZeroFill(&hklmKeys, sizeof(hklmKeys));
+		}
+
+		//! dtor. Rolls back if not committed.
+		~RegTransaction()
+		{
+			Rollback();
+			if (ktmw32 != nullptr)
+			{
+				FreeLibrary(ktmw32);
+			}
+		}
+
+		//! Start transaction.
+		/*!
+			@return false if KTM is not available.
+		 */
+		bool Begin()
+		{
+			HMODULE advapi32 = GetModuleHandle(_T("advapi32.dll"));
+			ktmw32 = LoadLibrary(_T("ktmw32.dll"));
+			if (advapi32 == nullptr || ktmw32 == nullptr)
+			{
+				return false;
+			}
+			RegCreateKeyTransactedProc createKeyTransacted = reinterpret_cast<RegCreateKeyTransactedProc>(GetProcAddress(advapi32,
+#ifdef UNICODE
+				"RegCreateKeyTransactedW"
+#else
+				"RegCreateKeyTransactedA"
+#endif
+			));
+			CreateTransactionProc createTransaction = reinterpret_cast<CreateTransactionProc>(GetProcAddress(ktmw32, "CreateTransaction"));
+			commitTransaction = reinterpret_cast<EndTransactionProc>(GetProcAddress(ktmw32, "CommitTransaction"));
+			rollbackTransaction = reinterpret_cast<EndTransactionProc>(GetProcAddress(ktmw32, "RollbackTransaction"));
+			if (createKeyTransacted == nullptr || createTransaction == nullptr || commitTransaction == nullptr || rollbackTransaction == nullptr)
+			{
+				return false;
+			}
+			HANDLE created = createTransaction(NULL, NULL, 0, 0, 0, 0, NULL);
+			if (created == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			transaction = created;
+			hkcuKeys.transaction = transaction;
+			hkcuKeys.createKeyTransacted = createKeyTransacted;
+			hklmKeys.transaction = transaction;
+			hklmKeys.createKeyTransacted = createKeyTransacted;
+			return true;
+		}
+
+		//! Obtain transacted store for a registry store, or store itself if it is not.
+		EnvStore Store(const EnvStore &store)
+		{
+			if (store.IsSameAs(HKCURegistryStore()))
+			{
+				return EnvStore(store.getter, store.setter, &hkcuKeys);
+			}
+			if (store.IsSameAs(HKLMRegistryStore()))
+			{
+				return EnvStore(store.getter, store.setter, &hklmKeys);
+			}
+			return store;
+		}
+
+		//! Make all writes visible at once.
+		bool Commit()
+		{
+			if (transaction == nullptr)
+			{
+				return false;
+			}
+			// keys must be closed before commit
+			hkcuKeys.Release();
+			hklmKeys.Release();
+			const bool success = commitTransaction(transaction) != FALSE;
+			if (!success)
+			{
+				rollbackTransaction(transaction);
+			}
+			CloseHandle(transaction);
+			transaction = nullptr;
+			return success;
+		}
+
+		//! Discard all writes.
+		void Rollback()
+		{
+			hkcuKeys.Release();
+			hklmKeys.Release();
+			if (transaction != nullptr)
+			{
+				rollbackTransaction(transaction);
+				CloseHandle(transaction);
+				transaction = nullptr;
+			}
+		}
+
+	private:
+		//! ktmw32.dll, or nullptr
+		HMODULE ktmw32;
+
+		//! KTM transaction, or nullptr
+		HANDLE transaction;
+
+		//! CommitTransaction
+		EndTransactionProc commitTransaction;
+
+		//! RollbackTransaction
+		EndTransactionProc rollbackTransaction;
+
+		//! HKCU environment key handles in transaction
+		RegKeyCache hkcuKeys;
+
+		//! HKLM environment key handles in transaction
+		RegKeyCache hklmKeys;
+	};
+}
@@ -0,0 +1,461 @@
+//! @file RegistryStore.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "EnvStore.h"
+
+namespace Utils
+{
+	//! key of environment variables for current user
+	LPCTSTR const HKCUEnvironmentKey = _T("Environment");
+
+	//! key of environment variables for local machine
+	LPCTSTR const HKLMEnvironmentKey = _T("SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment");
+
+	//! RegCreateKeyTransacted prototype (Vista or later)
+	typedef LSTATUS(WINAPI *RegCreateKeyTransactedProc)(HKEY hKey, LPCTSTR lpSubKey, DWORD Reserved, LPTSTR lpClass, DWORD dwOptions, REGSAM samDesired, const LPSECURITY_ATTRIBUTES lpSecurityAttributes, PHKEY phkResult, LPDWORD lpdwDisposition, HANDLE hTransaction, PVOID pExtendedParemeter);
+
+	//! A value remembered by RegKeyCache, in a single GlobalAlloc block with its name and text.
+	struct CachedValue
+	{
+		//! next value
+		CachedValue *next;
+
+		//! value name
+		LPTSTR name;
+
+		//! value text
+		LPTSTR text;
+
+		//! text length in TCHAR count
+		size_t textLen;
+
+		//! REG_SZ or REG_EXPAND_SZ, or REG_NONE if missing
+		DWORD type;
+	};
+
+	//! Environment key handles of one hive, opened once and kept until Release.
+	/*!
+		@remarks
+		A handle opened for write is also used to read.
+		Values read and written are remembered with the last write time of the key.
+		They are forgotten at once when the key is written by others, which RegQueryInfoKey tells.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	struct RegKeyCache
+	{
+		//! opened with KEY_READ, or nullptr
+		HKEY readKey;
+
+		//! opened with KEY_READ | KEY_WRITE, or nullptr
+		HKEY writeKey;
+
+		//! KTM transaction to open keys in, or nullptr. See RegTransaction.
+		HANDLE transaction;
+
+		//! RegCreateKeyTransacted, set with transaction
+		RegCreateKeyTransactedProc createKeyTransacted;
+
+		//! remembered values, or nullptr
+		CachedValue *values;
+
+		//! last write time of the key, when values were remembered
+		FILETIME lastWriteTime;
+
+		//! Obtain a handle to read.
+		LSTATUS OpenRead(HKEY baseKey, LPCTSTR keyName, HKEY &keyHandle)
+		{
+			if (transaction != nullptr)
+			{
+				// read what this transaction sees
+				return OpenWrite(baseKey, keyName, keyHandle);
+			}
+			LSTATUS error = ERROR_SUCCESS;
+			if (writeKey == nullptr && readKey == nullptr)
+			{
+				g_storeCounters.keyOpens++;
+				error = RegOpenKeyEx(
+					baseKey,
+					keyName,
+					0,
+					KEY_READ,
+					&readKey
+				);
+				if (error != ERROR_SUCCESS)
+				{
+					readKey = nullptr;
+				}
+			}
+			keyHandle = (writeKey != nullptr) ? writeKey : readKey;
+			return error;
+		}
+
+		//! Obtain a handle to write. The key is created if missing.
+		LSTATUS OpenWrite(HKEY baseKey, LPCTSTR keyName, HKEY &keyHandle)
+		{
+			LSTATUS error = ERROR_SUCCESS;
+			if (writeKey == nullptr)
+			{
+				g_storeCounters.keyOpens++;
+				DWORD disposition;
+				if (transaction != nullptr)
+				{
+					error = createKeyTransacted(
+						baseKey,
+						keyName,
+						0,
+						NULL,
+						REG_OPTION_NON_VOLATILE,
+						KEY_READ | KEY_WRITE,
+						NULL,
+						&writeKey,
+						&disposition,
+						transaction,
+						NULL
+					);
+				}
+				else
+				{
+					error = RegCreateKeyEx(
+						baseKey,
+						keyName,
+						0,
+						NULL,
+						REG_OPTION_NON_VOLATILE,
+						KEY_READ | KEY_WRITE,
+						NULL,
+						&writeKey,
+						&disposition
+					);
+				}
+				if (error != ERROR_SUCCESS)
+				{
+					writeKey = nullptr;
+				}
+			}
+			keyHandle = writeKey;
+			return error;
+		}
+
+		//! Forget handles whose key was deleted by others, so that the next call opens again.
+		void Validate(LSTATUS error)
+		{
+			if (error == ERROR_KEY_DELETED)
+			{
+				Release();
+			}
+		}
+
+		//! Forget values if the key is written since they were remembered.
+		/*!
+			@remarks Values are not remembered in a transaction.
+		 */
+		void CheckValues(HKEY keyHandle)
+		{
+			FILETIME time;
+			if (transaction != nullptr || RegQueryInfoKey(keyHandle, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &time) != ERROR_SUCCESS)
+			{
+				ForgetValues();
+				return;
+			}
+			if (CompareFileTime(&time, &lastWriteTime) != 0)
+			{
+				ForgetValues();
+				lastWriteTime = time;
+			}
+		}
+
+		//! Find remembered value, or nullptr. Call CheckValues first.
+		const CachedValue *FindValue(LPCTSTR valueName) const
+		{
+			for (CachedValue *value = values; value != nullptr; value = value->next)
+			{
+				if (lstrcmpi(value->name, valueName) == 0)
+				{
+					return value;
+				}
+			}
+			return nullptr;
+		}
+
+		//! Remember value read, or written by this DLL.
+		/*!
+			@param written true if written: lastWriteTime is updated to include this write.
+		 */
+		void RememberValue(HKEY keyHandle, LPCTSTR valueName, const FixedLenStr &text, DWORD type, bool written)
+		{
+			if (transaction != nullptr)
+			{
+				return;
+			}
+			if (written && RegQueryInfoKey(keyHandle, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &lastWriteTime) != ERROR_SUCCESS)
+			{
+				ForgetValues();
+				return;
+			}
+			ForgetValue(valueName);
+
+			const size_t nameLen = lstrlen(valueName);
+			const size_t textLen = (type == REG_NONE) ? 0 : text.StringCharCount();
+			CachedValue *value = (CachedValue *)GlobalAlloc(GMEM_FIXED, sizeof(CachedValue) + (nameLen + textLen + 2) * sizeof(TCHAR));
+			if (value == nullptr)
+			{
+				return;
+			}
+			value->name = reinterpret_cast<LPTSTR>(value + 1);
+			value->text = value->name + nameLen + 1;
+			value->textLen = textLen;
+			value->type = type;
+			lstrcpyn(value->name, valueName, static_cast<int>(nameLen + 1));
+			lstrcpyn(value->text, (type == REG_NONE) ? _T("") : static_cast<LPCTSTR>(text), static_cast<int>(textLen + 1));
+			value->next = values;
+			values = value;
+		}
+
+		//! Forget one value.
+		void ForgetValue(LPCTSTR valueName)
+		{
+			for (CachedValue **link = &values; *link != nullptr; link = &(*link)->next)
+			{
+				if (lstrcmpi((*link)->name, valueName) == 0)
+				{
+					CachedValue *value = *link;
+					*link = value->next;
+					GlobalFree(value);
+					return;
+				}
+			}
+		}
+
+		//! Forget all values.
+		void ForgetValues()
+		{
+			while (values != nullptr)
+			{
+				CachedValue *next = values->next;
+				GlobalFree(values);
+				values = next;
+			}
+			lastWriteTime.dwLowDateTime = 0;
+			lastWriteTime.dwHighDateTime = 0;
+		}
+
+		//! Close handles, and forget values.
+		void Release()
+		{
+			ForgetValues();
+			if (readKey != nullptr)
+			{
+				RegCloseKey(readKey);
+				readKey = nullptr;
+			}
+			if (writeKey != nullptr)
+			{
+				RegCloseKey(writeKey);
+				writeKey = nullptr;
+			}
+		}
+	};
+
+	//! HKCU environment key handles of this DLL instance
+	RegKeyCache g_hkcuKeys;
+
+	//! HKLM environment key handles of this DLL instance
+	RegKeyCache g_hklmKeys;
+
+	//! Close cached key handles and forget values, at NSPIM_UNLOAD.
+	void ReleaseRegistryKeys()
+	{
+		g_hkcuKeys.Release();
+		g_hklmKeys.Release();
+	}
+
+	//! generic getter
+	/*!
+		@remarks
+		Two-phase read: the size and type are queried first, and the buffer is reserved once.
+		If the value grows in between, ERROR_MORE_DATA reports the new size and the read is retried.
+		A missing value is read as empty, with REG_NONE.
+		Other than REG_SZ and REG_EXPAND_SZ is an error.
+	 */
+	bool GetRegValueFrom(RegKeyCache &keys, HKEY baseKey, LPCTSTR keyName, LPCTSTR valueName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		HKEY keyHandle;
+		LSTATUS error = keys.OpenRead(baseKey, keyName, keyHandle);
+		if (error == ERROR_SUCCESS)
+		{
+			keys.CheckValues(keyHandle);
+			const CachedValue *cached = keys.FindValue(valueName);
+			if (cached != nullptr)
+			{
+				g_storeCounters.cacheHits++;
+				ValueType = cached->type;
+				return ResultVar.AssignString(cached->text, 0, cached->textLen);
+			}
+			g_storeCounters.cacheMisses++;
+
+			bool success = false;
+			DWORD bytesWritten = 0;
+			ResultVar.Clear();
+			error = RegQueryValueEx(
+				keyHandle,
+				valueName,
+				NULL,
+				&ValueType,
+				NULL,
+				&bytesWritten
+			);
+			for (int attempt = 0; attempt < 4 && (error == ERROR_SUCCESS || error == ERROR_MORE_DATA); attempt++)
+			{
+				if (false
+					|| (ValueType != REG_SZ && ValueType != REG_EXPAND_SZ)
+					|| !ResultVar.Reserve(bytesWritten / sizeof(TCHAR))
+					)
+				{
+					break;
+				}
+				bytesWritten = static_cast<DWORD>(ResultVar.BufferBytesLength());
+				error = RegQueryValueEx(
+					keyHandle,
+					valueName,
+					NULL,
+					&ValueType,
+					reinterpret_cast<LPBYTE>(static_cast<LPTSTR>(ResultVar)),
+					&bytesWritten
+				);
+				if (error == ERROR_SUCCESS)
+				{
+					// the buffer is not zero filled: terminate at the returned size
+					static_cast<LPTSTR>(ResultVar)[bytesWritten / sizeof(TCHAR)] = 0;
+					success = true;
+					break;
+				}
+			}
+			if (error == ERROR_FILE_NOT_FOUND)
+			{
+				ValueType = REG_NONE;
+				ResultVar.Clear();
+				success = true;
+			}
+
+			if (success)
+			{
+				keys.RememberValue(keyHandle, valueName, ResultVar, ValueType, false);
+			}
+			keys.Validate(error);
+			return success;
+		}
+		return false;
+	}
+
+	//! generic setter
+	/*!
+		@remarks REG_NONE deletes the value. Deleting a missing value succeeds.
+	 */
+	bool SetRegValueTo(RegKeyCache &keys, HKEY baseKey, LPCTSTR keyName, LPCTSTR valueName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		HKEY keyHandle;
+		LSTATUS error = keys.OpenWrite(baseKey, keyName, keyHandle);
+		if (error == ERROR_SUCCESS)
+		{
+			// values written by others before this write are forgotten
+			keys.CheckValues(keyHandle);
+
+			if (ValueType == REG_NONE)
+			{
+				error = RegDeleteValue(keyHandle, valueName);
+				if (error == ERROR_FILE_NOT_FOUND)
+				{
+					error = ERROR_SUCCESS;
+				}
+			}
+			else
+			{
+				error = RegSetValueEx(
+					keyHandle,
+					valueName,
+					0,
+					ValueType,
+					reinterpret_cast<const BYTE *>(static_cast<LPCTSTR>(NewValue)),
+					static_cast<DWORD>(NewValue.StringBytesLength() + sizeof(TCHAR))
+				);
+			}
+
+			if (error == ERROR_SUCCESS)
+			{
+				keys.RememberValue(keyHandle, valueName, NewValue, ValueType, true);
+				return true;
+			}
+
+			keys.ForgetValue(valueName);
+			keys.Validate(error);
+		}
+		return false;
+	}
+
+	//! getter for current user
+	bool GetHKCURegValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		return GetRegValueFrom(
+			*static_cast<RegKeyCache *>(context),
+			HKEY_CURRENT_USER,
+			HKCUEnvironmentKey,
+			EnvVarName,
+			ResultVar,
+			ValueType
+		);
+	}
+
+	//! getter for local machine
+	bool GetHKLMRegValue(void *context, LPCTSTR EnvVarName, FixedLenStr &ResultVar, DWORD &ValueType)
+	{
+		return GetRegValueFrom(
+			*static_cast<RegKeyCache *>(context),
+			HKEY_LOCAL_MACHINE,
+			HKLMEnvironmentKey,
+			EnvVarName,
+			ResultVar,
+			ValueType
+		);
+	}
+
+	//! setter for current user
+	bool SetHKCURegValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		return SetRegValueTo(
+			*static_cast<RegKeyCache *>(context),
+			HKEY_CURRENT_USER,
+			HKCUEnvironmentKey,
+			EnvVarName,
+			NewValue,
+			ValueType
+		);
+	}
+
+	//! setter for local machine
+	bool SetHKLMRegValue(void *context, LPCTSTR EnvVarName, const FixedLenStr &NewValue, DWORD ValueType)
+	{
+		return SetRegValueTo(
+			*static_cast<RegKeyCache *>(context),
+			HKEY_LOCAL_MACHINE,
+			HKLMEnvironmentKey,
+			EnvVarName,
+			NewValue,
+			ValueType
+		);
+	}
+
+	//! Win32 registry store for current user
+	EnvStore HKCURegistryStore()
+	{
+		return EnvStore(GetHKCURegValue, SetHKCURegValue, &g_hkcuKeys);
+	}
+
+	//! Win32 registry store for local machine
+	EnvStore HKLMRegistryStore()
+	{
+		return EnvStore(GetHKLMRegValue, SetHKLMRegValue, &g_hklmKeys);
+	}
+}
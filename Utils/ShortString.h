@@ -0,0 +1,51 @@
+//! @file ShortString.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "NsisStack.h"
+
+namespace Utils
+{
+	//! Short NSIS parameter such as Action and RegLoc, in an inline buffer (without allocation)
+	/*!
+		@remarks
+		A longer parameter is truncated to Length - 1 chars.
+		Length is longer than any valid value, so that a truncated value matches none of them.
+	 */
+	class ShortString
+	{
+	public:
+		//! buffer length in TCHAR count, including null
+		static const int Length = 32;
+
+		//! ctor
+		ShortString()
+		{
+			text[0] = 0;
+		}
+
+		//! NSIS popstringn
+		bool Pop()
+		{
+			return PopStringN(text, Length);
+		}
+
+		//! LPCTSTR cast for NSIS support functions.
+		operator LPCTSTR() const
+		{
+			return text;
+		}
+
+		//! Compare ignoring case, by lstrcmpi.
+		int CompareToIgnoreCase(LPCTSTR psz) const
+		{
+			return lstrcmpi(text, psz);
+		}
+
+	private:
+		//! null terminated text
+		TCHAR text[Length];
+	};
+}
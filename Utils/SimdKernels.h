@@ -0,0 +1,203 @@
+//! @file SimdKernels.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#ifdef UTILS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Utils
+{
+	//! Index of lowest set bit. mask must not be 0.
+	inline unsigned LowestSetBit(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+	}
+
+	//! Plain loops, for any CPU.
+	namespace Scalar
+	{
+		//! ZeroMemory without CRT
+		inline void ZeroFill(void *ptr, size_t cnt)
+		{
+			LPBYTE fill = reinterpret_cast<LPBYTE>(ptr);
+			LPBYTE fillEnd = fill + cnt;
+			for (; fill < fillEnd; fill++)
+			{
+				*fill = 0;
+			}
+		}
+
+		//! Index of first delim in text, or len.
+		template <typename TChar>
+		size_t FindChar(const TChar *text, size_t len, TChar delim)
+		{
+			for (size_t index = 0; index < len; index++)
+			{
+				if (text[index] == delim)
+				{
+					return index;
+				}
+			}
+			return len;
+		}
+
+		//! Nothing is proven by scalar kernel: the caller compares all.
+		template <typename TChar>
+		size_t AsciiFoldEqualPrefix(const TChar *left, const TChar *right, size_t len)
+		{
+			return 0;
+		}
+	}
+
+#ifdef UTILS_X86_SIMD
+	//! 16 bytes kernels.
+	namespace Sse2
+	{
+		typedef __m128i Vec;
+
+		const unsigned FullMask = 0xFFFFu;
+
+		inline Vec Load(const void *ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)); }
+		inline void StoreAligned(void *ptr, Vec value) { _mm_store_si128(reinterpret_cast<__m128i *>(ptr), value); }
+		inline Vec Zero() { return _mm_setzero_si128(); }
+		inline Vec And(Vec left, Vec right) { return _mm_and_si128(left, right); }
+		inline Vec Or(Vec left, Vec right) { return _mm_or_si128(left, right); }
+		inline unsigned MoveMask(Vec value) { return static_cast<unsigned>(_mm_movemask_epi8(value)); }
+		inline void Finish() { }
+
+		//! per char width operations
+		template <size_t Width> struct Lanes;
+
+		template <> struct Lanes<1>
+		{
+			static const int NonAsciiBits = 0x80;
+			static Vec Set1(int value) { return _mm_set1_epi8(static_cast<char>(value)); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm_cmpeq_epi8(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm_cmpgt_epi8(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm_sub_epi8(left, right); }
+		};
+
+		template <> struct Lanes<2>
+		{
+			static const int NonAsciiBits = 0xFF80;
+			static Vec Set1(int value) { return _mm_set1_epi16(static_cast<short>(value)); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm_cmpeq_epi16(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm_cmpgt_epi16(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm_sub_epi16(left, right); }
+		};
+
+		template <> struct Lanes<4>
+		{
+			static const int NonAsciiBits = ~0x7F;
+			static Vec Set1(int value) { return _mm_set1_epi32(value); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm_cmpeq_epi32(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm_cmpgt_epi32(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm_sub_epi32(left, right); }
+		};
+
+#include "SimdKernels.inl"
+	}
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+	//! 32 bytes kernels.
+	namespace Avx2
+	{
+		typedef __m256i Vec;
+
+		const unsigned FullMask = 0xFFFFFFFFu;
+
+		inline Vec Load(const void *ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr)); }
+		inline void StoreAligned(void *ptr, Vec value) { _mm256_store_si256(reinterpret_cast<__m256i *>(ptr), value); }
+		inline Vec Zero() { return _mm256_setzero_si256(); }
+		inline Vec And(Vec left, Vec right) { return _mm256_and_si256(left, right); }
+		inline Vec Or(Vec left, Vec right) { return _mm256_or_si256(left, right); }
+		inline unsigned MoveMask(Vec value) { return static_cast<unsigned>(_mm256_movemask_epi8(value)); }
+		inline void Finish() { _mm256_zeroupper(); }
+
+		//! per char width operations
+		template <size_t Width> struct Lanes;
+
+		template <> struct Lanes<1>
+		{
+			static const int NonAsciiBits = 0x80;
+			static Vec Set1(int value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm256_cmpeq_epi8(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm256_cmpgt_epi8(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm256_sub_epi8(left, right); }
+		};
+
+		template <> struct Lanes<2>
+		{
+			static const int NonAsciiBits = 0xFF80;
+			static Vec Set1(int value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm256_cmpeq_epi16(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm256_cmpgt_epi16(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm256_sub_epi16(left, right); }
+		};
+
+		template <> struct Lanes<4>
+		{
+			static const int NonAsciiBits = ~0x7F;
+			static Vec Set1(int value) { return _mm256_set1_epi32(value); }
+			static Vec CmpEq(Vec left, Vec right) { return _mm256_cmpeq_epi32(left, right); }
+			static Vec CmpGt(Vec left, Vec right) { return _mm256_cmpgt_epi32(left, right); }
+			static Vec Sub(Vec left, Vec right) { return _mm256_sub_epi32(left, right); }
+		};
+
+#include "SimdKernels.inl"
+	}
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+#endif
+
+	//! Index of first delim in text, or len. Dispatched by GetSimdLevel.
+	template <typename TChar>
+	size_t FindChar(const TChar *text, size_t len, TChar delim)
+	{
+		switch (GetSimdLevel())
+		{
+#ifdef UTILS_X86_SIMD
+		case SimdAvx2:
+			return Avx2::FindChar(text, len, delim);
+		case SimdSse2:
+			return Sse2::FindChar(text, len, delim);
+#endif
+		default:
+			return Scalar::FindChar(text, len, delim);
+		}
+	}
+
+	//! Length of leading ASCII chars proven equal ignoring case. Dispatched by GetSimdLevel.
+	template <typename TChar>
+	size_t AsciiFoldEqualPrefix(const TChar *left, const TChar *right, size_t len)
+	{
+		switch (GetSimdLevel())
+		{
+#ifdef UTILS_X86_SIMD
+		case SimdAvx2:
+			return Avx2::AsciiFoldEqualPrefix(left, right, len);
+		case SimdSse2:
+			return Sse2::AsciiFoldEqualPrefix(left, right, len);
+#endif
+		default:
+			return Scalar::AsciiFoldEqualPrefix(left, right, len);
+		}
+	}
+}
@@ -0,0 +1,91 @@
+//! @file SimdKernels.inl
+//! @author kenjiuno
+//! @date Oct 17 2026
+//! @brief Kernel bodies, included by SimdKernels.h once per instruction set.
+//!
+//! The including namespace provides Vec, Load, StoreAligned, Zero, And, Or,
+//! MoveMask, FullMask, Finish and Lanes<sizeof(TChar)>.
+
+//! Zero fill with aligned vector stores.
+inline void ZeroFill(void *ptr, size_t cnt)
+{
+	LPBYTE fill = reinterpret_cast<LPBYTE>(ptr);
+	while (cnt != 0 && (reinterpret_cast<ULONG_PTR>(fill) & (sizeof(Vec) - 1)) != 0)
+	{
+		*fill++ = 0;
+		cnt--;
+	}
+	const Vec zero = Zero();
+	for (; sizeof(Vec) <= cnt; cnt -= sizeof(Vec), fill += sizeof(Vec))
+	{
+		StoreAligned(fill, zero);
+	}
+	for (; cnt != 0; cnt--)
+	{
+		*fill++ = 0;
+	}
+	Finish();
+}
+
+//! Index of first delim in text, or len.
+template <typename TChar>
+size_t FindChar(const TChar *text, size_t len, TChar delim)
+{
+	typedef Lanes<sizeof(TChar)> L;
+	const size_t lanes = sizeof(Vec) / sizeof(TChar);
+	const Vec needle = L::Set1(delim);
+	size_t index = 0;
+	for (; index + lanes <= len; index += lanes)
+	{
+		const unsigned mask = MoveMask(L::CmpEq(Load(text + index), needle));
+		if (mask != 0)
+		{
+			Finish();
+			return index + LowestSetBit(mask) / sizeof(TChar);
+		}
+	}
+	Finish();
+	for (; index < len; index++)
+	{
+		if (text[index] == delim)
+		{
+			return index;
+		}
+	}
+	return len;
+}
+
+//! Length of the leading whole vectors of ASCII chars that are equal ignoring case.
+/*!
+	@remarks The caller compares the rest, including any non-ASCII char.
+ */
+template <typename TChar>
+size_t AsciiFoldEqualPrefix(const TChar *left, const TChar *right, size_t len)
+{
+	typedef Lanes<sizeof(TChar)> L;
+	const size_t lanes = sizeof(Vec) / sizeof(TChar);
+	const Vec nonAsciiBits = L::Set1(L::NonAsciiBits);
+	const Vec beforeLower = L::Set1('a' - 1);
+	const Vec afterLower = L::Set1('z' + 1);
+	const Vec caseBit = L::Set1(0x20);
+	size_t index = 0;
+	for (; index + lanes <= len; index += lanes)
+	{
+		const Vec leftChars = Load(left + index);
+		const Vec rightChars = Load(right + index);
+		if (MoveMask(L::CmpEq(And(Or(leftChars, rightChars), nonAsciiBits), Zero())) != FullMask)
+		{
+			break;
+		}
+		const Vec leftLower = And(L::CmpGt(leftChars, beforeLower), L::CmpGt(afterLower, leftChars));
+		const Vec rightLower = And(L::CmpGt(rightChars, beforeLower), L::CmpGt(afterLower, rightChars));
+		const Vec leftFolded = L::Sub(leftChars, And(leftLower, caseBit));
+		const Vec rightFolded = L::Sub(rightChars, And(rightLower, caseBit));
+		if (MoveMask(L::CmpEq(leftFolded, rightFolded)) != FullMask)
+		{
+			break;
+		}
+	}
+	Finish();
+	return index;
+}
@@ -0,0 +1,102 @@
+//! @file Stats.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <Windows.h>
+
+#include "PerThread.h"
+
+namespace Utils
+{
+	//! Time spent in each phase, measured by QueryPerformanceCounter while enabled.
+	/*!
+		@remarks
+		Times are in 100ns units.
+		Has no ctor, so that a zero initialized global instance needs no CRT startup.
+	 */
+	struct PhaseStats
+	{
+		//! true to measure
+		bool enabled;
+
+		//! QueryPerformanceFrequency, or 0 until the first measure
+		LARGE_INTEGER frequency;
+
+		//! time in store getters
+		size_t getTime;
+
+		//! time in edit and query kernels
+		size_t transformTime;
+
+		//! time in store setters
+		size_t setTime;
+
+		//! edits and queries applied
+		size_t transforms;
+	};
+
+	//! stats of this DLL instance
+	UTILS_PER_THREAD PhaseStats g_stats;
+
+	//! Add time of this scope to a phase, if g_stats.enabled.
+	class PhaseTimer
+	{
+	public:
+		//! ctor
+		/*!
+			@param time one of the times of g_stats.
+		 */
+		PhaseTimer(size_t &time) : time(time)
+		{
+			start.QuadPart = 0;
+			if (g_stats.enabled)
+			{
+				if (g_stats.frequency.QuadPart == 0)
+				{
+					QueryPerformanceFrequency(&g_stats.frequency);
+				}
+				QueryPerformanceCounter(&start);
+			}
+		}
+
+		//! dtor
+		~PhaseTimer()
+		{
+			if (start.QuadPart != 0)
+			{
+				LARGE_INTEGER end;
+				QueryPerformanceCounter(&end);
+				time += ToUnits(end.QuadPart - start.QuadPart);
+			}
+		}
+
+	private:
+		//! Convert ticks to 100ns units.
+		/*!
+			@remarks MulDiv scales through 64 bits, so that no CRT helper of 64 bit division is needed.
+		 */
+		static size_t ToUnits(LONGLONG ticks)
+		{
+			LONGLONG frequency = g_stats.frequency.QuadPart;
+			while (frequency > MAXLONG)
+			{
+				frequency >>= 1;
+				ticks >>= 1;
+			}
+			if (ticks <= 0 || frequency <= 0)
+			{
+				return 0;
+			}
+			const int units = MulDiv(static_cast<int>((ticks < MAXLONG) ? ticks : MAXLONG), 10000000, static_cast<int>(frequency));
+			return (units < 0) ? MAXLONG : units;
+		}
+
+		//! phase time to add to
+		size_t &time;
+
+		//! counter at scope start, or 0 if not measured
+		LARGE_INTEGER start;
+	};
+}
@@ -0,0 +1,77 @@
+//! @file StrBuilder.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include "FixedLenStr.h"
+#include "StrSpan.h"
+
+namespace Utils
+{
+	//! Appends spans to a FixedLenStr, tracking the written length.
+	/*!
+		@remarks Each char is copied once. The target is kept null terminated.
+		A growable target grows as needed.
+	 */
+	class StrBuilder
+	{
+	public:
+		//! ctor. Empties target.
+		StrBuilder(FixedLenStr &target) : target(target), length(0)
+		{
+			if (target.msgbuf != nullptr)
+			{
+				target.msgbuf[0] = 0;
+			}
+		}
+
+		//! Append span.
+		/*!
+			@return false if it does not fit. Nothing is appended then.
+		 */
+		bool Append(const StrSpan &text)
+		{
+			if (!target.Reserve(length + text.len + 1))
+			{
+				return false;
+			}
+			// length is known: copy without scanning for null
+			LPTSTR dest = target.msgbuf + length;
+			for (size_t index = 0; index < text.len; index++)
+			{
+				dest[index] = text.ptr[index];
+			}
+			length += text.len;
+			target.msgbuf[length] = 0;
+			return true;
+		}
+
+		//! Append delimiter if not empty, and then append span.
+		bool AppendSeparated(TCHAR delim, const StrSpan &text)
+		{
+			if (length != 0)
+			{
+				const StrSpan delimSpan = { &delim, 1 };
+				if (!Append(delimSpan))
+				{
+					return false;
+				}
+			}
+			return Append(text);
+		}
+
+		//! Written length in TCHAR count.
+		size_t Length() const
+		{
+			return length;
+		}
+
+	private:
+		//! target string
+		FixedLenStr &target;
+
+		//! written length in TCHAR count
+		size_t length;
+	};
+}
@@ -0,0 +1,168 @@
+//! @file StrSpan.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <Windows.h>
+
+#include "SimdKernels.h"
+
+namespace Utils
+{
+	//! Case folding for ordinal ignore-case comparison of paths.
+	/*!
+		@remarks
+		@li ASCII a-z are folded to A-Z without any API call.
+		@li Other chars are folded by CharUpper, char by char.
+		@li ANSI: double byte chars are kept as is, so that trail bytes are never folded.
+	 */
+	class CaseFold
+	{
+	public:
+		//! ctor
+		CaseFold() : trail(false)
+		{
+
+		}
+
+		//! Fold next char of a sequence.
+		TCHAR Fold(TCHAR oneChar)
+		{
+#ifndef UNICODE
+			if (trail)
+			{
+				trail = false;
+				return oneChar;
+			}
+#endif
+			if (static_cast<unsigned>(oneChar) < 0x80)
+			{
+				return (_T('a') <= oneChar && oneChar <= _T('z')) ? static_cast<TCHAR>(oneChar - (_T('a') - _T('A'))) : oneChar;
+			}
+#ifndef UNICODE
+			if (IsDBCSLeadByte(static_cast<BYTE>(oneChar)))
+			{
+				trail = true;
+				return oneChar;
+			}
+#endif
+			// CharUpper converts a single char when the high-order word is zero.
+			const ULONG_PTR charCode = static_cast<ULONG_PTR>(static_cast<TBYTE>(oneChar));
+			return static_cast<TCHAR>(reinterpret_cast<ULONG_PTR>(CharUpper(reinterpret_cast<LPTSTR>(charCode))));
+		}
+
+	private:
+		//! next char is a trail byte (ANSI only)
+		bool trail;
+	};
+
+	//! A view of TCHARs, not null terminated.
+	struct StrSpan
+	{
+		//! first char
+		LPCTSTR ptr;
+
+		//! length in TCHAR count
+		size_t len;
+
+		//! View of null terminated string.
+		static StrSpan Of(LPCTSTR psz)
+		{
+			StrSpan span = { psz, (psz == nullptr) ? 0 : static_cast<size_t>(lstrlen(psz)) };
+			return span;
+		}
+
+		//! Ordinal equality. Lengths are compared first.
+		bool Equals(const StrSpan &other) const
+		{
+			if (len != other.len)
+			{
+				return false;
+			}
+			for (size_t index = 0; index < len; index++)
+			{
+				if (ptr[index] != other.ptr[index])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//! Ordinal ignore-case equality, without copying to null terminated buffers.
+		/*!
+			@remarks ASCII chars are folded inline. See CaseFold for others.
+		 */
+		bool EqualsIgnoreCase(const StrSpan &other) const
+		{
+			if (len != other.len)
+			{
+				return false;
+			}
+			// ASCII prefix is compared by vector kernel, and no DBCS lead byte is pending after it.
+			CaseFold foldThis;
+			CaseFold foldOther;
+			for (size_t index = AsciiFoldEqualPrefix(ptr, other.ptr, len); index < len; index++)
+			{
+				if (foldThis.Fold(ptr[index]) != foldOther.Fold(other.ptr[index]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//! FNV-1a hash of case folded chars. Equal under EqualsIgnoreCase means equal hash.
+		DWORD FoldedHash() const
+		{
+			CaseFold fold;
+			DWORD hash = 2166136261u;
+			for (size_t index = 0; index < len; index++)
+			{
+				hash ^= static_cast<DWORD>(fold.Fold(ptr[index]));
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	};
+
+	//! Single pass tokenizer over a string of known length.
+	/*!
+		@remarks
+		Empty tokens are returned, but a trailing delimiter does not yield a last empty token.
+	 */
+	class StrTokenizer
+	{
+	public:
+		//! ctor
+		StrTokenizer(StrSpan text, TCHAR delim) : cur(text.ptr), end(text.ptr + text.len), delim(delim)
+		{
+
+		}
+
+		//! Take next token.
+		bool Next(StrSpan &token)
+		{
+			if (end <= cur)
+			{
+				return false;
+			}
+			LPCTSTR scan = cur + FindChar(cur, end - cur, delim);
+			token.ptr = cur;
+			token.len = scan - cur;
+			cur = scan + 1;
+			return true;
+		}
+
+	private:
+		//! next token start
+		LPCTSTR cur;
+
+		//! end of text
+		LPCTSTR end;
+
+		//! delimiter
+		TCHAR delim;
+	};
+}
@@ -0,0 +1,49 @@
+//! @file WideText.h
+//! @author kenjiuno
+//! @date Oct 17 2026
+
+#pragma once
+
+#include <Windows.h>
+
+namespace Utils
+{
+	//! Text as UTF-16, converted from ANSI if needed.
+	class WideText
+	{
+	public:
+		//! ctor
+		WideText(LPCTSTR text) : text(nullptr), allocated(nullptr)
+		{
+#ifdef UNICODE
+			this->text = text;
+#else
+			const int count = MultiByteToWideChar(CP_ACP, 0, text, -1, NULL, 0);
+			if (count > 0)
+			{
+				allocated = (LPWSTR)GlobalAlloc(GMEM_FIXED, count * sizeof(WCHAR));
+				if (allocated != nullptr && MultiByteToWideChar(CP_ACP, 0, text, -1, allocated, count) == count)
+				{
+					this->text = allocated;
+				}
+			}
+#endif
+		}
+
+		//! dtor
+		~WideText()
+		{
+			if (allocated != nullptr)
+			{
+				GlobalFree(allocated);
+			}
+		}
+
+		//! converted text, or nullptr on failure
+		LPCWSTR text;
+
+	private:
+		//! buffer of converted text
+		LPWSTR allocated;
+	};
+}
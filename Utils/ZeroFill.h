@@ -6,16 +6,29 @@
 
 #include <Windows.h>
 
+#include "SimdKernels.h"
+
 namespace Utils
 {
 	//! ZeroMemory without CRT
+	/*!
+		@remarks Dispatched by GetSimdLevel. Scalar::ZeroFill is the byte loop.
+	 */
 	void ZeroFill(void *ptr, size_t cnt)
 	{
-		LPBYTE fill = reinterpret_cast<LPBYTE>(ptr);
-		LPBYTE fillEnd = fill + cnt;
-		for (; fill < fillEnd; fill++)
+		switch (GetSimdLevel())
 		{
-			*fill = 0;
+#ifdef UTILS_X86_SIMD
+		case SimdAvx2:
+			Avx2::ZeroFill(ptr, cnt);
+			break;
+		case SimdSse2:
+			Sse2::ZeroFill(ptr, cnt);
+			break;
+#endif
+		default:
+			Scalar::ZeroFill(ptr, cnt);
+			break;
 		}
 	}
 }